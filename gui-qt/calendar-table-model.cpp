@@ -0,0 +1,163 @@
+#include "calendar-table-model.h"
+
+#include <algorithm>
+#include <QBrush>
+#include <QColor>
+#include <QFont>
+#include <QRegularExpression>
+
+namespace {
+// Cell texts are small HTML snippets: links to locations and &nbsp; in dates.
+QString plain_text(const std::string & html) {
+    QString text = QString::fromStdString(html);
+    text.remove(QRegularExpression{"<[^>]*>"});
+    text.replace("&nbsp;", QChar{0x00A0});
+    text.replace("&lt;", "<");
+    text.replace("&gt;", ">");
+    text.replace("&quot;", "\"");
+    text.replace("&amp;", "&");
+    return text;
+}
+
+// "Udupi" for R"(<a href="#Udupi">Udupi</a>)", empty string if there is no such link
+QString location_from_link(const std::string & html) {
+    const auto match = QRegularExpression{R"(<a href="#([^"]*)">)"}.match(QString::fromStdString(html));
+    if (!match.hasMatch()) return {};
+    return plain_text(match.captured(1).toStdString());
+}
+
+bool has_class(const QString & classes, const char * css_class) {
+    return classes.split(' ').contains(css_class);
+}
+
+// Same colors as table_css in mainwindow.cpp
+QVariant background(const QString & classes, bool header) {
+    if (has_class(classes, "vrata")) return QBrush{QColor{"#f8a102"}};
+    if (has_class(classes, "custom")) return QBrush{Qt::yellow};
+    if (header) return QBrush{QColor{has_class(classes, "mainpart") ? "#c0c0c0" : "#34CDF9"}};
+    if (has_class(classes, "odd")) return QBrush{QColor{"#EBF5FF"}};
+    if (has_class(classes, "even")) return QBrush{QColor{"#D2E4FC"}};
+    return {};
+}
+
+QVariant foreground(const QString & classes, bool header) {
+    if (!header) return {};
+    return QBrush{QColor{has_class(classes, "mainpart") ? "#3531ff" : "#FFFC9E"}};
+}
+} // anonymous namespace
+
+bool CalendarTableModel::Cell::operator==(const Cell & other) const
+{
+    return text == other.text && title == other.title && location == other.location && classes == other.classes && header == other.header
+            && rowspan == other.rowspan && colspan == other.colspan;
+}
+
+CalendarTableModel::CalendarTableModel(QObject * parent) : QAbstractTableModel(parent)
+{}
+
+void CalendarTableModel::setTable(const vp::Table & table)
+{
+    const int rows = static_cast<int>(table.height());
+    const int cols = static_cast<int>(table.width());
+    std::vector<Cell> cells(static_cast<std::size_t>(rows * cols));
+    std::vector<Span> spans;
+    for (int row = 0; row < rows; ++row) {
+        for (const auto & table_cell : table.row(static_cast<std::size_t>(row)).data) {
+            auto & c = cells[static_cast<std::size_t>(row * cols) + table_cell.col];
+            c.rowspan = static_cast<int>(table_cell.rowspan);
+            c.colspan = static_cast<int>(table_cell.colspan);
+            // merged cells are covered by the span of another cell
+            if (c.rowspan == 0 || c.colspan == 0) continue;
+            c.text = plain_text(table_cell.text);
+            c.title = QString::fromStdString(table_cell.title);
+            c.location = location_from_link(table_cell.text);
+            c.classes = QString::fromStdString(table_cell.classes);
+            c.header = table_cell.type == vp::Table::CellType::Header;
+            if (c.rowspan != 1 || c.colspan != 1) {
+                spans.push_back(Span{row, static_cast<int>(table_cell.col), c.rowspan, c.colspan});
+            }
+        }
+    }
+
+    if (rows != rows_ || cols != cols_) {
+        beginResetModel();
+        rows_ = rows;
+        cols_ = cols;
+        cells_ = std::move(cells);
+        spans_ = std::move(spans);
+        endResetModel();
+        return;
+    }
+
+    // same size: only report the rectangle of changed cells
+    int top = rows, left = cols, bottom = -1, right = -1;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            const auto i = static_cast<std::size_t>(row * cols + col);
+            if (cells[i] != cells_[i]) {
+                top = std::min(top, row);
+                bottom = std::max(bottom, row);
+                left = std::min(left, col);
+                right = std::max(right, col);
+            }
+        }
+    }
+    cells_ = std::move(cells);
+    spans_ = std::move(spans);
+    if (bottom >= 0) {
+        emit dataChanged(index(top, left), index(bottom, right));
+    }
+}
+
+int CalendarTableModel::rowCount(const QModelIndex & parent) const
+{
+    return parent.isValid() ? 0 : rows_;
+}
+
+int CalendarTableModel::columnCount(const QModelIndex & parent) const
+{
+    return parent.isValid() ? 0 : cols_;
+}
+
+const CalendarTableModel::Cell * CalendarTableModel::cell(const QModelIndex & index) const
+{
+    if (!index.isValid() || index.row() >= rows_ || index.column() >= cols_) return nullptr;
+    return &cells_[static_cast<std::size_t>(index.row() * cols_ + index.column())];
+}
+
+QVariant CalendarTableModel::data(const QModelIndex & index, int role) const
+{
+    const Cell * c = cell(index);
+    if (!c) return {};
+    switch (role) {
+    case Qt::DisplayRole:
+        return c->text;
+    case Qt::ToolTipRole:
+        return c->title.isEmpty() ? QVariant{} : QVariant{c->title};
+    case Qt::BackgroundRole:
+        return background(c->classes, c->header);
+    case Qt::ForegroundRole:
+        return foreground(c->classes, c->header);
+    case Qt::FontRole:
+        if (c->header || has_class(c->classes, "vrata") || has_class(c->classes, "custom")) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        return {};
+    case Qt::TextAlignmentRole:
+        if (c->header || has_class(c->classes, "mainpart")) return static_cast<int>(Qt::AlignCenter);
+        return static_cast<int>(Qt::AlignLeft | Qt::AlignVCenter);
+    case LocationRole:
+        return c->location.isEmpty() ? QVariant{} : QVariant{c->location};
+    default:
+        return {};
+    }
+}
+
+QSize CalendarTableModel::span(const QModelIndex & index) const
+{
+    const Cell * c = cell(index);
+    if (!c || c->rowspan == 0 || c->colspan == 0) return QSize{1, 1};
+    return QSize{c->colspan, c->rowspan};
+}
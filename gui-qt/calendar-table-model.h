@@ -0,0 +1,64 @@
+#ifndef CALENDARTABLEMODEL_H
+#define CALENDARTABLEMODEL_H
+
+#include "table.h"
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <vector>
+
+/* Calendar table (as made by Table_Calendar_Generator::generate()) for QTableView.
+ *
+ * Unlike HTML in QTextBrowser, the view only lays out visible rows and keeps its
+ * scroll position by itself. setTable() with a table of the same size (e.g. after
+ * changing settings or custom dates) only reports the cells which have actually
+ * changed.
+ */
+class CalendarTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // location name for the cells of the location column
+    static constexpr int LocationRole = Qt::UserRole;
+
+    struct Span {
+        int row;
+        int col;
+        int rowspan;
+        int colspan;
+    };
+
+    explicit CalendarTableModel(QObject * parent = nullptr);
+
+    void setTable(const vp::Table & table);
+    // Spans of all merged cells, for QTableView::setSpan().
+    const std::vector<Span> & spans() const { return spans_; }
+
+    int rowCount(const QModelIndex & parent = QModelIndex{}) const override;
+    int columnCount(const QModelIndex & parent = QModelIndex{}) const override;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+    QSize span(const QModelIndex & index) const override;
+
+private:
+    struct Cell {
+        QString text;
+        QString title;
+        QString location;
+        QString classes;
+        bool header = false;
+        int rowspan = 1;
+        int colspan = 1;
+        bool operator==(const Cell & other) const;
+        bool operator!=(const Cell & other) const { return !(*this == other); }
+    };
+
+    int rows_ = 0;
+    int cols_ = 0;
+    std::vector<Cell> cells_;
+    std::vector<Span> spans_;
+
+    const Cell * cell(const QModelIndex & index) const;
+};
+
+#endif // CALENDARTABLEMODEL_H
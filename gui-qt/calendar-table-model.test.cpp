@@ -0,0 +1,61 @@
+#include <catch-formatters.h>
+
+#include "calendar-table-model.h"
+
+namespace {
+vp::Table sample_table(const char * vrata_text) {
+    vp::Table table;
+    table.start_new_row();
+    table.add_header_cell("Location");
+    table.add_header_cell("Location");
+    table.add_header_cell("March&nbsp;24", "mainpart");
+    table.start_new_row("odd");
+    table.add_cell("India");
+    table.add_cell(R"(<a href="#Udupi">Udupi</a>)").set_title("Timezone: Asia/Kolkata");
+    table.add_cell(vrata_text, "mainpart vrata");
+    table.merge_cells_into_rowspans();
+    table.merge_cells_into_colspans();
+    return table;
+}
+}
+
+TEST_CASE("CalendarTableModel shows vp::Table cells as plain text with spans") {
+    CalendarTableModel model;
+    model.setTable(sample_table("Ekādaśī"));
+    REQUIRE(model.rowCount() == 2);
+    REQUIRE(model.columnCount() == 3);
+    REQUIRE(model.data(model.index(0, 2)).toString() == QString{"March"} + QChar{0x00A0} + "24");
+    REQUIRE(model.data(model.index(1, 1)).toString() == "Udupi");
+    REQUIRE(model.data(model.index(1, 1), CalendarTableModel::LocationRole).toString() == "Udupi");
+    REQUIRE(model.data(model.index(1, 1), Qt::ToolTipRole).toString() == "Timezone: Asia/Kolkata");
+    REQUIRE_FALSE(model.data(model.index(1, 0), CalendarTableModel::LocationRole).isValid());
+
+    // two "Location" header cells are merged
+    REQUIRE(model.spans().size() == 1);
+    REQUIRE(model.spans()[0].row == 0);
+    REQUIRE(model.spans()[0].col == 0);
+    REQUIRE(model.spans()[0].colspan == 2);
+    REQUIRE(model.span(model.index(0, 0)) == QSize{2, 1});
+}
+
+TEST_CASE("CalendarTableModel::setTable() with the same size table reports changed cells only") {
+    CalendarTableModel model;
+    model.setTable(sample_table("Ekādaśī"));
+
+    int resets = 0;
+    std::vector<std::pair<QModelIndex, QModelIndex>> changes;
+    QObject::connect(&model, &QAbstractItemModel::modelReset, [&]{ ++resets; });
+    QObject::connect(&model, &QAbstractItemModel::dataChanged, [&](const QModelIndex & top_left, const QModelIndex & bottom_right) {
+        changes.emplace_back(top_left, bottom_right);
+    });
+
+    model.setTable(sample_table("Ekādaśī"));
+    REQUIRE(changes.empty());
+
+    model.setTable(sample_table("Custom date"));
+    REQUIRE(resets == 0);
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes[0].first == model.index(1, 2));
+    REQUIRE(changes[0].second == model.index(1, 2));
+    REQUIRE(model.data(model.index(1, 2)).toString() == "Custom date");
+}
@@ -22,7 +22,7 @@ void HtmlBrowser::contextMenuEvent(QContextMenuEvent * event)
 {
     QMenu menu(this);
     menu.addAction(viewSourceAct);
-    if (custom_context_menu_action) { menu.addAction(custom_context_menu_action); }
+    menu.addActions(custom_context_menu_actions);
     menu.exec(event->globalPos());
 }
 
@@ -41,7 +41,7 @@ void HtmlBrowser::setHtmlForNormalAndSourceView(QString html_for_normal_and_sour
     setHtml(m_html_for_normal_and_source_view);
 }
 
-void HtmlBrowser::setContextMenuAction(QAction * action)
+void HtmlBrowser::addContextMenuAction(QAction * action)
 {
-    custom_context_menu_action = action;
+    custom_context_menu_actions.append(action);
 }
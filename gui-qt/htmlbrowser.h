@@ -11,7 +11,7 @@ class HtmlBrowser : public QTextBrowser
     void viewSourceToggle();
     bool viewing_source = false;
     QString m_html_for_normal_and_source_view;
-    QAction * custom_context_menu_action = nullptr;
+    QList<QAction *> custom_context_menu_actions;
 
 protected:
     void contextMenuEvent(QContextMenuEvent * event) override;
@@ -22,7 +22,8 @@ public:
     // Set HTML which will not be modified in any way (used for source/rendered views).
     // The reason we need this is that toHtml() returns modified HTML code, not the same as was passed to setHtml() previously.
     void setHtmlForNormalAndSourceView(QString html_for_normal_and_source_view);
-    void setContextMenuAction(QAction * action);
+    // added to the context menu after "View/hide HTML source"
+    void addContextMenuAction(QAction * action);
 };
 
 #endif // HTMLBROWSER_H
@@ -1,5 +1,7 @@
 #include "latlongedit.h"
 
+#include "text-interface.h"
+
 LatLongEdit::LatLongEdit(vp::Coord c, QWidget * parent)
     :QLineEdit(parent),coord{c}
 {
@@ -9,3 +11,8 @@ void LatLongEdit::setCoord(vp::Coord c)
 {
     coord = c;
 }
+
+vp::Location LatLongEdit::location() const
+{
+    return vp::text_ui::custom_location(coord);
+}
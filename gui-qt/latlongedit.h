@@ -10,6 +10,8 @@ class LatLongEdit : public QLineEdit
 public:
     explicit LatLongEdit(vp::Coord c, QWidget * parent);
     void setCoord(vp::Coord c);
+    // location at coord, with time zone found by the coordinates
+    vp::Location location() const;
     vp::Coord coord;
 };
 
@@ -2,6 +2,7 @@
 #include <catch-formatters.h>
 
 #include "latlongedit.h"
+#include "text-interface.h"
 
 #include <QApplication>
 
@@ -28,4 +29,12 @@ TEST_CASE("LatLongEdit works") {
         REQUIRE(e.coord == c2);
         REQUIRE(e.coord != arbitrary_coord);
     }
+
+    SECTION("LatLongEdit location() has time zone for its coord") {
+        LatLongEdit e{arbitrary_coord, nullptr};
+        const auto location = e.location();
+        REQUIRE(location.latitude == arbitraty_latitude);
+        REQUIRE(location.longitude == arbitraty_longitude);
+        REQUIRE(location.time_zone_name == vp::text_ui::time_zone_for(arbitrary_coord));
+    }
 }
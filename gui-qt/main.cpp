@@ -2,7 +2,10 @@
 #include <QDir>
 #include <QMessageBox>
 
+#include "place-db.h"
 #include "text-interface.h"
+#include "time-zone-db.h"
+#include "vrata-db.h"
 #include "tz-fixed.h"
 #include "mainwindow.h"
 
@@ -31,6 +34,9 @@ int main(int argc, char *argv[])
     MyApplication a(argc, argv);
     a.make_all_qmessagebox_texts_selectable();
     date::set_install("tzdata");
+    vp::text_ui::use_vrata_db(vp::VrataDb::DefaultFileName);
+    vp::text_ui::use_place_db(vp::PlaceDb::DefaultFileName);
+    vp::text_ui::use_time_zone_db(vp::TimeZoneDb::DefaultFileName);
     MainWindow w;
     w.show();
     return a.exec();
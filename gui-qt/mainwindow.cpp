@@ -1,50 +1,96 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 
+#include "calendar-table-model.h"
 #include "edit-custom-dates.h"
 #include "html-table-writer.h"
 #include "latlongedit.h"
 #include "location.h"
 #include "table-calendar-generator.h"
 #include "text-interface.h"
+#include "time-format.h"
 #include "vrata_detail_printer.h"
 #include "vrata-summary.h"
 #include "tz-fixed.h"
 
+#include <algorithm>
 #include <chrono>
 #include "fmt-format-fixed.h"
+#include <memory_resource>
+#include <QCompleter>
 #include <QDate>
+#include <QHeaderView>
+#include <QLineEdit>
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QShortcut>
+#include <QStringListModel>
+#include <QTableView>
 
 void MainWindow::connectSignals()
 {
     connect(ui->vrataSummary, &QTextBrowser::anchorClicked, [this]{
         expand_details_in_summary_tab = !expand_details_in_summary_tab;
-        refreshAllTabs();
+        refreshSummary();
     });
     ui->tableTextBrowser->setOpenLinks(false);
     connect(ui->tableTextBrowser, &QTextBrowser::anchorClicked, [this](const QUrl & link){
-        auto location_name = link.fragment();
-        gui_ready = false;
-        ui->locationComboBox->setCurrentText(location_name);
-        ui->tabWidget->setCurrentIndex(0); // 0 means summary tab
-        gui_ready = true;
-        refreshAllTabs();
+        switchToLocationSummary(link.fragment());
+    });
+}
+
+void MainWindow::switchToLocationSummary(const QString & location_name)
+{
+    gui_ready = false;
+    ui->locationComboBox->setCurrentText(location_name);
+    ui->tabWidget->setCurrentIndex(0); // 0 means summary tab
+    gui_ready = true;
+    refreshAllTabs();
+}
+
+void MainWindow::setupTableView()
+{
+#ifdef VP_NATIVE_TABLE_VIEW
+    table_model = new CalendarTableModel(this);
+    table_view = new QTableView(this);
+    table_view->setModel(table_model);
+    table_view->horizontalHeader()->hide();
+    table_view->verticalHeader()->hide();
+    table_view->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table_view->setWordWrap(true);
+    table_view->setContextMenuPolicy(Qt::ActionsContextMenu);
+    table_view->addAction(addCustomDatesForTableAction);
+    table_as_html = new QAction(tr("Show as &HTML (to view source or copy)"), this);
+    table_as_html->setCheckable(true);
+    connect(table_as_html, &QAction::toggled, [this](bool as_html){
+        table_view->setVisible(!as_html);
+        ui->tableTextBrowser->setVisible(as_html);
+        refreshTable();
+    });
+    table_view->addAction(table_as_html);
+    ui->tableTextBrowser->addContextMenuAction(table_as_html);
+    connect(table_view, &QTableView::activated, [this](const QModelIndex & index){
+        const auto location_name = index.data(CalendarTableModel::LocationRole);
+        if (location_name.isValid()) {
+            switchToLocationSummary(location_name.toString());
+        }
     });
+    ui->verticalLayoutTabTable->addWidget(table_view);
+    ui->tableTextBrowser->hide();
+#endif
 }
 
 void MainWindow::addTableContextMenu()
 {
     addCustomDatesForTableAction = new QAction(tr("Add custom dates..."), this);
     connect(addCustomDatesForTableAction, &QAction::triggered, this, &MainWindow::addCustomDatesForTable);
-    ui->tableTextBrowser->setContextMenuAction(addCustomDatesForTableAction);
+    ui->tableTextBrowser->addContextMenuAction(addCustomDatesForTableAction);
 }
 
 void MainWindow::addCustomDatesForTable()
 {
     custom_dates = vp::edit_custom_dates(custom_dates, this);
+    // custom dates don't affect vratas themselves, only the table built from them
     refreshTable();
 }
 
@@ -125,6 +171,7 @@ MainWindow::MainWindow(QWidget *parent)
     connectSignals();
     addTableContextMenu();
     setupLocationInput();
+    setupTableView();
     gui_ready = true;
     refreshAllTabs();
 }
@@ -203,6 +250,32 @@ void MainWindow::setupLocationsComboBox()
         ui->locationComboBox->addItem(QString::fromUtf8(l.name.data(), l.name.size()));
     }
     ui->locationComboBox->setCurrentIndex(1); // select Udupi, first location after "all"
+
+    // Any place from the place db can be typed in: completions are looked up as you type,
+    // chosen ones are added to the list.
+    ui->locationComboBox->setEditable(true);
+    ui->locationComboBox->setInsertPolicy(QComboBox::NoInsert);
+    auto * completions = new QStringListModel(this);
+    auto * completer = new QCompleter(completions, this);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    ui->locationComboBox->setCompleter(completer);
+    connect(ui->locationComboBox->lineEdit(), &QLineEdit::textEdited, [completions](const QString & text) {
+        constexpr std::size_t max_completions = 50;
+        const auto prefix = text.toStdString();
+        QStringList names;
+        for (const auto & l : vp::text_ui::LocationDb::find_by_prefix(prefix, max_completions)) {
+            names << QString::fromUtf8(l.name.data(), static_cast<int>(l.name.size()));
+        }
+        completions->setStringList(names);
+    });
+    connect(completer, qOverload<const QString &>(&QCompleter::activated), [this](const QString & name) {
+        int index = ui->locationComboBox->findText(name);
+        if (index == -1) {
+            ui->locationComboBox->addItem(name);
+            index = ui->locationComboBox->count() - 1;
+        }
+        ui->locationComboBox->setCurrentIndex(index);
+    });
 }
 
 void MainWindow::setDateToToday()
@@ -210,26 +283,113 @@ void MainWindow::setDateToToday()
     ui->dateEdit->setDate(QDate::currentDate());
 }
 
+bool MainWindow::tableTabIsVisible() const
+{
+    return ui->tab_table->isVisible();
+}
+
 std::string MainWindow::selected_location() {
-    if (ui->tableTextBrowser->isVisible()) {
+    if (tableTabIsVisible()) {
         return "all";
     }
-    return ui->locationComboBox->currentText().toStdString();
+    // not currentText(): that's whatever is being typed in
+    return ui->locationComboBox->itemText(ui->locationComboBox->currentIndex()).toStdString();
 }
 
-void MainWindow::recalcVratasForSelectedDateAndLocation() {
-    auto date = to_ymd(ui->dateEdit->date());
-    auto location_string = selected_location();
-    const auto flags = flagsForCurrentSettings();
+bool MainWindow::CalcInputs::operator==(const CalcInputs & other) const
+{
+    return date == other.date && location == other.location && flags == other.flags;
+}
+
+std::shared_ptr<vp::BoundaryCache> MainWindow::boundaryCacheFor(vp::CalcFlags flags)
+{
+    const auto ephemeris = flags & vp::CalcFlags::EphemerisMask;
+    if (!boundary_cache || boundary_cache->ephemeris() != ephemeris) {
+        boundary_cache = std::make_shared<vp::BoundaryCache>(ephemeris);
+    }
+    return boundary_cache;
+}
+
+MainWindow::CalcInputs MainWindow::currentCalcInputs()
+{
+    return CalcInputs{to_ymd(ui->dateEdit->date()), selected_location(), flagsForCurrentSettings()};
+}
+
+bool MainWindow::recalcVratasForSelectedDateAndLocation() {
+    CalcInputs inputs = currentCalcInputs();
+    if (vratas_calculated_for == inputs) { return true; }
+    if (vratas_requested_for == inputs) { return false; }
+
+    // inputs changed again before the previous request was done (e.g. when quickly
+    // stepping through dates): nobody needs that one anymore
+    pending_cancellation.cancel();
+    pending_cancellation = vp::CancellationToken::make();
+    // When only sunrise/sunset flags change, text_ui::calc() reuses tithi and nakṣatra
+    // starts found before, so only sunrises/sunsets are calculated again.
+    vp::text_ui::NextVratasRequest request{inputs.date, inputs.location, inputs.flags, boundaryCacheFor(inputs.flags)};
+    pending_vratas = async_calc.submit(std::move(request), pending_cancellation, [this] {
+        // on the worker thread: get back to GUI thread
+        QMetaObject::invokeMethod(this, "vratasCalculated", Qt::QueuedConnection);
+    });
+    showPreviews(inputs);
+    vratas_requested_for = std::move(inputs);
+    return false;
+}
 
-    vratas = vp::text_ui::calc(date, location_string, flags);
+void MainWindow::showPreviews(const CalcInputs & inputs)
+{
+    const auto previews = vp::text_ui::preview(inputs.date, inputs.location, inputs.flags);
+    QString summary = "<p><i>Preliminary dates, calculating exact times...</i></p>";
+    std::optional<date::local_days> min_date;
+    std::optional<date::local_days> max_date;
+    for (const auto & preview : previews) {
+        const auto & vrata = preview.vrata;
+        // no date at all when even the approximate calculation failed
+        if (vrata.paksha == vp::Paksha::Unknown) { continue; }
+        summary += QString::fromStdString(fmt::format(FMT_STRING("<p>{}: {} {}{}</p>"),
+            vrata.location_name(), date::year_month_day{vrata.date}, vrata.type, preview.uncertain ? " (might change)" : ""));
+        min_date = min_date ? std::min(*min_date, vrata.date) : vrata.date;
+        max_date = max_date ? std::max(*max_date, vrata.date) : vrata.date;
+    }
+    // the table tab shows its previous table meanwhile, so the status line tells the dates, too
+    if (!min_date) {
+        statusBar()->showMessage("Calculating...");
+    } else if (*min_date == *max_date) {
+        statusBar()->showMessage(QString::fromStdString(fmt::format(FMT_STRING("Calculating... (preliminary date {})"),
+                                                                    date::year_month_day{*min_date})));
+    } else {
+        statusBar()->showMessage(QString::fromStdString(fmt::format(FMT_STRING("Calculating... (preliminary dates {}..{})"),
+                                                                    date::year_month_day{*min_date}, date::year_month_day{*max_date})));
+    }
+    if (!tableTabIsVisible()) {
+        ui->vrataSummary->setText(summary);
+    }
+}
+
+void MainWindow::vratasCalculated()
+{
+    // abandoned requests call it, too
+    if (!pending_vratas.valid() || pending_vratas.wait_for(std::chrono::seconds{0}) != std::future_status::ready) { return; }
+    try {
+        vratas = pending_vratas.get();
+        vratas_calculated_for = std::move(vratas_requested_for);
+        vratas_requested_for.reset();
+    } catch (std::exception &e) {
+        vratas_requested_for.reset();
+        pending_ekadashi_steps = 0;
+        QMessageBox::warning(this, "error", e.what());
+        return;
+    }
+    showVersionInStatusLine();
+    refreshAllTabs();
+    applyPendingEkadashiSteps();
 }
 
 void MainWindow::refreshAllTabs()
 {
     if (!gui_ready) { return; }
     try {
-        recalcVratasForSelectedDateAndLocation();
+        if (!recalcVratasForSelectedDateAndLocation()) { return; }
         refreshSummary();
         refreshTable();
         refreshDaybyday();
@@ -384,13 +544,26 @@ void MainWindow::setupLocationInput()
 
 void MainWindow::refreshTable()
 {
-    if (!ui->tableTextBrowser->isVisible()) { return; }
-    std::stringstream s;
+    if (!tableTabIsVisible()) { return; }
     date::year current_year = date::year_month_day{date::floor<date::days>(std::chrono::system_clock::now())}.year();
-    s << vp::Html_Table_Writer{vp::Table_Calendar_Generator::generate(vratas, current_year, custom_dates)};
+    if (table_model && !table_as_html->isChecked()) {
+        // the view keeps its scroll position, and only changed cells are repainted
+        table_model->setTable(vp::Table_Calendar_Generator::generate(vratas, current_year, custom_dates));
+        table_view->clearSpans();
+        for (const auto & span : table_model->spans()) {
+            table_view->setSpan(span.row, span.col, span.rowspan, span.colspan);
+        }
+        return;
+    }
+    fmt::memory_buffer buf;
+    {
+        // the table is thrown away right after writing it out, so allocate it all in one go
+        std::pmr::monotonic_buffer_resource arena;
+        vp::write_html_table(buf, vp::Table_Calendar_Generator::generate_compact(vratas, current_year, custom_dates, &arena));
+    }
 
     int old_scroll_y = getTableVerticalScrollValue();
-    ui->tableTextBrowser->setHtmlForNormalAndSourceView(table_css + QString::fromStdString(s.str()));
+    ui->tableTextBrowser->setHtmlForNormalAndSourceView(table_css + QString::fromUtf8(buf.data(), static_cast<int>(buf.size())));
     if (QScrollBar * bar = ui->tableTextBrowser->verticalScrollBar(); bar) {
         bar->setValue(old_scroll_y);
     }
@@ -424,7 +597,7 @@ QString html_for_daybyday(const vp::text_ui::DayByDayInfo & info) {
             fmt::format_to(out,
                            FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
                            info.tithi,
-                           date::format("%H:%M", tithi_until),
+                           vp::hh_mm(tithi_until.get_local_time()),
                            tithi_until_date == sunrise_date ? "" : " next day");
         }
         if (info.tithi2_until) {
@@ -433,7 +606,7 @@ QString html_for_daybyday(const vp::text_ui::DayByDayInfo & info) {
             fmt::format_to(out,
                            FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
                            info.tithi2,
-                           date::format("%H:%M", tithi2_until),
+                           vp::hh_mm(tithi2_until.get_local_time()),
                            tithi2_until_date == sunrise_date ? "" : " next day");
         }
         if (info.nakshatra_until) {
@@ -442,7 +615,7 @@ QString html_for_daybyday(const vp::text_ui::DayByDayInfo & info) {
             fmt::format_to(out,
                            FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
                            info.nakshatra,
-                           date::format("%H:%M", until),
+                           vp::hh_mm(until.get_local_time()),
                            date == sunrise_date ? "" : " next day");
         }
         if (info.nakshatra2_until) {
@@ -451,7 +624,7 @@ QString html_for_daybyday(const vp::text_ui::DayByDayInfo & info) {
             fmt::format_to(out,
                            FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
                            info.nakshatra2,
-                           date::format("%H:%M", until),
+                           vp::hh_mm(until.get_local_time()),
                            date == sunrise_date ? "" : " next day");
         }
     }
@@ -641,14 +814,37 @@ static QDate to_qdate(date::local_days date) {
     return QDate::fromJulianDay(to_juldays(date).count());
 }
 
+void MainWindow::stepEkadashi(int direction)
+{
+    // Stale vratas (previous date still being calculated) would give the same guess
+    // again, and the click would be lost. Step once they are ready instead.
+    if (vratas_calculated_for != currentCalcInputs()) {
+        pending_ekadashi_steps += direction;
+        return;
+    }
+    const auto date = to_local_days(ui->dateEdit->date());
+    const auto new_date = direction > 0 ?
+        vratas.guess_start_date_for_next_ekadashi(date)
+    :
+        vratas.guess_start_date_for_prev_ekadashi(date);
+    ui->dateEdit->setDate(to_qdate(new_date));
+}
+
+void MainWindow::applyPendingEkadashiSteps()
+{
+    if (pending_ekadashi_steps == 0 || vratas_calculated_for != currentCalcInputs()) { return; }
+    // one step at a time: the next one needs vratas for the date this one gets to
+    const int direction = pending_ekadashi_steps > 0 ? +1 : -1;
+    pending_ekadashi_steps -= direction;
+    stepEkadashi(direction);
+}
+
 void MainWindow::on_dateNextEkadashi_clicked()
 {
-    auto next_date = vratas.guess_start_date_for_next_ekadashi(to_local_days(ui->dateEdit->date()));
-    ui->dateEdit->setDate(to_qdate(next_date));
+    stepEkadashi(+1);
 }
 
 void MainWindow::on_datePrevEkadashi_clicked()
 {
-    auto prev_date = vratas.guess_start_date_for_prev_ekadashi(to_local_days(ui->dateEdit->date()));
-    ui->dateEdit->setDate(to_qdate(prev_date));
+    stepEkadashi(-1);
 }
@@ -1,6 +1,9 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "async-calc.h"
+#include "boundary-cache.h"
+#include "cancellation.h"
 #include "latlongedit.h"
 #include "table-calendar-generator.h"
 #include "vrata.h"
@@ -8,13 +11,20 @@
 #include "calc-flags.h"
 #include "date-fixed.h"
 #include <fmt/core.h>
+#include <future>
+#include <memory>
+#include <optional>
 #include <QAction>
 #include <QMainWindow>
+#include <string>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
+class QTableView;
 QT_END_NAMESPACE
 
+class CalendarTableModel;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -40,9 +50,34 @@ private slots:
 
     void on_datePrevEkadashi_clicked();
 
+    // called (queued) by async_calc whenever a request is done
+    void vratasCalculated();
+
 private:
+    // Everything vratas depend on. Custom dates, details toggle etc only change
+    // how vratas are shown, so they never need recalculation.
+    struct CalcInputs {
+        date::year_month_day date;
+        std::string location;
+        vp::CalcFlags flags;
+        bool operator==(const CalcInputs & other) const;
+        bool operator!=(const CalcInputs & other) const { return !(*this == other); }
+    };
+
     Ui::MainWindow *ui;
     vp::VratasForDate vratas;
+    std::optional<CalcInputs> vratas_calculated_for;
+    // Tithi and nakṣatra starts found during this session (for the current ephemeris), so that
+    // changing sunrise/sunset flags only calculates sunrises and sunsets again. It only grows
+    // with the dates browsed (few dozen starts per date) and is dropped when ephemeris changes.
+    std::shared_ptr<vp::BoundaryCache> boundary_cache;
+    // request being calculated by async_calc, if any; vratas stay as they are meanwhile
+    std::optional<CalcInputs> vratas_requested_for;
+    std::future<vp::VratasForDate> pending_vratas;
+    vp::CancellationToken pending_cancellation;
+    // next (+1) and previous (-1) Ekādaśī clicks waiting for vratas of the current inputs,
+    // since the step is guessed from them
+    int pending_ekadashi_steps = 0;
     bool gui_ready = false; // set to true at the and of the MainWindow constructor
     bool expand_details_in_summary_tab = false;
     QAction * addCustomDatesForTableAction = nullptr;
@@ -52,13 +87,30 @@ private:
     QAction * ephemeris_swiss = nullptr;
     QAction * shravana_dvadashi_14gh = nullptr;
     LatLongEdit * latlong_edit = nullptr;
+    // only with VP_NATIVE_TABLE_VIEW, replace tableTextBrowser
+    QTableView * table_view = nullptr;
+    CalendarTableModel * table_model = nullptr;
+    // only with VP_NATIVE_TABLE_VIEW: show tableTextBrowser again (for HTML source and copying)
+    QAction * table_as_html = nullptr;
+    // last: destroyed (and its worker stopped) before everything it might use
+    vp::text_ui::AsyncCalc async_calc;
 
     void setupLocationsComboBox();
     void setDateToToday();
-    void recalcVratasForSelectedDateAndLocation();
+    // true if vratas are ready for current inputs; otherwise they are requested
+    // from async_calc and vratasCalculated() refreshes all tabs once they are ready
+    bool recalcVratasForSelectedDateAndLocation();
+    CalcInputs currentCalcInputs();
+    // +1 for next Ekādaśī, -1 for previous one
+    void stepEkadashi(int direction);
+    void applyPendingEkadashiSteps();
+    std::shared_ptr<vp::BoundaryCache> boundaryCacheFor(vp::CalcFlags flags);
     void refreshAllTabs();
     void refreshSummary();
+    // approximate dates and types (see text_ui::preview()) until async_calc has exact vratas
+    void showPreviews(const CalcInputs & inputs);
     void refreshTable();
+    bool tableTabIsVisible() const;
     void refreshDaybyday();
     void showVersionInStatusLine();
     void clearLocationData();
@@ -77,6 +129,8 @@ private:
     vp::CalcFlags flagsForCurrentSettings();
     int getTableVerticalScrollValue() const;
     void setupLocationInput();
+    void setupTableView();
+    void switchToLocationSummary(const QString & location_name);
 };
 
 QString htmlify_line(const std::string_view & line);
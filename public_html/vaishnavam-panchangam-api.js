@@ -0,0 +1,128 @@
+// Batch API for web pages over the C API (src/c-api.h) of vaishnavam-panchangam-web.{js,wasm,data}
+// (built with emcmake, see VP_WASM_THREADS in CMakeLists.txt). Load vaishnavam-panchangam-web.js first, then:
+//
+//   const vp = await loadVaishnavamPanchangam();
+//   const vratas = vp.nextVratas('2021-02-09', 'all');   // one object per location
+//   const text = vp.report('2021-02-09', 'Udupi');
+//
+// Calculations are synchronous: call them from a Web Worker to keep the page responsive.
+
+async function loadVaishnavamPanchangam(flags = 0) {
+    const module = await createVaishnavamPanchangam();
+
+    // layout of struct vp_vrata
+    const VRATA_SIZE = 208;
+    const NAME_SIZE = 64;
+    const int32At = (ptr, index) => module.getValue(ptr + 4 * index, 'i32');
+    const doubleAt = (ptr, index) => module.getValue(ptr + 32 + 8 * index, 'double');
+
+    const withString = (s, f) => {
+        const size = module.lengthBytesUTF8(s) + 1;
+        const ptr = module._malloc(size);
+        try {
+            module.stringToUTF8(s, ptr, size);
+            return f(ptr);
+        } finally {
+            module._free(ptr);
+        }
+    };
+    const check = (status) => {
+        if (status !== 0) throw new Error(module.UTF8ToString(module._vp_status_message(status)));
+    };
+    const parseDate = (ymd) => {
+        const [year, month, day] = ymd.split('-').map(Number);
+        return [year, month, day];
+    };
+    const vrataAt = (ptr) => {
+        const status = int32At(ptr, 0);
+        if (status !== 0) return { error: module.UTF8ToString(module._vp_status_message(status)) };
+        const pad = (n) => String(n).padStart(2, '0');
+        return {
+            date: `${int32At(ptr, 1)}-${pad(int32At(ptr, 2))}-${pad(int32At(ptr, 3))}`,
+            type: int32At(ptr, 4),
+            masa: int32At(ptr, 5),
+            paksha: int32At(ptr, 6),
+            latitudeAdjusted: int32At(ptr, 7) !== 0,
+            // Julian days (UT), NaN when there is no limit
+            sunrise1: doubleAt(ptr, 0),
+            sunrise2: doubleAt(ptr, 1),
+            paranStart: doubleAt(ptr, 2),
+            paranEnd: doubleAt(ptr, 3),
+            latitude: doubleAt(ptr, 4),
+            longitude: doubleAt(ptr, 5),
+            location: module.UTF8ToString(ptr + 80, NAME_SIZE),
+            timeZone: module.UTF8ToString(ptr + 80 + NAME_SIZE, NAME_SIZE),
+        };
+    };
+
+    // preloaded bundle is in the root of the virtual file system
+    withString('/', (dir) => check(module._vp_init(dir)));
+    if (typeof SharedArrayBuffer !== 'undefined' && crossOriginIsolated) {
+        check(module._vp_set_threads(0));
+    }
+    const context = module._vp_context_create(flags);
+    if (!context) throw new Error('out of memory');
+
+    return {
+        version: () => module.UTF8ToString(module._vp_version()),
+
+        // Next vratas on or after the date (YYYY-MM-DD) for the location name, or for all locations.
+        nextVratas(ymd, location = 'all') {
+            const [year, month, day] = parseDate(ymd);
+            const countPtr = module._malloc(4);
+            let capacity = 128;
+            try {
+                for (;;) {
+                    const results = module._malloc(capacity * VRATA_SIZE);
+                    try {
+                        const status = withString(location, (name) =>
+                            module._vp_next_vratas(context, year, month, day, name, results, capacity, countPtr));
+                        const count = module.getValue(countPtr, 'i32');
+                        if (status === 4 /* VP_ERROR_BUFFER_TOO_SMALL */) {
+                            capacity = count;
+                            continue;
+                        }
+                        check(status);
+                        return Array.from({ length: count }, (_, i) => vrataAt(results + i * VRATA_SIZE));
+                    } finally {
+                        module._free(results);
+                    }
+                }
+            } finally {
+                module._free(countPtr);
+            }
+        },
+
+        // Next vrata for arbitrary coordinates (decimal degrees).
+        nextVrataAt(ymd, latitude, longitude) {
+            const [year, month, day] = parseDate(ymd);
+            const result = module._malloc(VRATA_SIZE);
+            try {
+                module._vp_next_vrata_at(context, year, month, day, latitude, longitude, result);
+                return vrataAt(result);
+            } finally {
+                module._free(result);
+            }
+        },
+
+        // Same text as the command line program prints.
+        report(ymd, location) {
+            const [year, month, day] = parseDate(ymd);
+            let size = 16 * 1024;
+            for (;;) {
+                const buffer = module._malloc(size);
+                try {
+                    const status = withString(location, (name) =>
+                        module._vp_report(context, year, month, day, name, buffer, size, 0));
+                    if (status === 4 /* VP_ERROR_BUFFER_TOO_SMALL */) {
+                        size *= 4;
+                        continue;
+                    }
+                    return module.UTF8ToString(buffer);
+                } finally {
+                    module._free(buffer);
+                }
+            }
+        },
+    };
+}
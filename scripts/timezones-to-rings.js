@@ -0,0 +1,19 @@
+// Converts timezone-boundary-builder GeoJSON (e.g. combined.json from
+// https://github.com/evansiroky/timezone-boundary-builder/releases) into
+// input for "vaishnavam-panchangam-db -t": one polygon ring per line,
+// "time-zone<TAB>lng,lat lng,lat ...".
+//
+// node --max-old-space-size=4096 timezones-to-rings.js combined.json > timezones.txt
+var fs = require('fs');
+
+var geojson = JSON.parse(fs.readFileSync(process.argv[2], 'utf8'));
+for (var feature of geojson.features) {
+    var tzid = feature.properties.tzid;
+    var geometry = feature.geometry;
+    var polygons = geometry.type === 'Polygon' ? [geometry.coordinates] : geometry.coordinates;
+    for (var polygon of polygons) {
+        for (var ring of polygon) {
+            process.stdout.write(tzid + '\t' + ring.map(function(p) { return p[0] + ',' + p[1]; }).join(' ') + '\n');
+        }
+    }
+}
@@ -0,0 +1,251 @@
+#include "approx-sky.h"
+
+#include <array>
+#include <cmath>
+
+namespace vp {
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double j2000 = 2451545.0;
+
+double radians(double degrees) { return degrees * (pi / 180.0); }
+double degrees(double radians) { return radians * (180.0 / pi); }
+
+double normalize_degrees(double angle) {
+    angle = std::fmod(angle, 360.0);
+    if (angle < 0) angle += 360.0;
+    // adding 360 to tiny negative values gives exactly 360.0
+    if (angle >= 360.0) angle -= 360.0;
+    return angle;
+}
+
+// (-180..180]
+double signed_degrees(double angle) {
+    angle = normalize_degrees(angle);
+    return angle > 180.0 ? angle - 360.0 : angle;
+}
+
+// Terrestrial time minus universal time, days. Espenak & Meeus polynomials for 1986..2050,
+// long-term parabola otherwise (it's only used outside of the range we care about).
+double delta_t_days(double jd_ut) {
+    const double year = 2000.0 + (jd_ut - j2000) / 365.25;
+    double seconds;
+    if (year >= 2005.0 && year < 2050.0) {
+        const double t = year - 2000.0;
+        seconds = 62.92 + 0.32217 * t + 0.005589 * t * t;
+    } else if (year >= 1986.0 && year < 2005.0) {
+        const double t = year - 2000.0;
+        seconds = 63.86 + 0.3345 * t - 0.060374 * t * t + 0.0017275 * t * t * t + 0.000651814 * t * t * t * t + 0.00002373599 * t * t * t * t * t;
+    } else {
+        const double u = (year - 1820.0) / 100.0;
+        seconds = -20.0 + 32.0 * u * u;
+    }
+    return seconds / 86400.0;
+}
+
+// Julian centuries from J2000.0 (terrestrial time)
+double centuries_tt(JulDays_UT time) {
+    const double jd = time.raw_julian_days_ut().count();
+    return (jd + delta_t_days(jd) - j2000) / 36525.0;
+}
+
+// nutation in longitude, degrees (two largest terms, good to ~0.5")
+double nutation_in_longitude(double t) {
+    const double omega = radians(125.04452 - 1934.136261 * t);
+    const double sun_mean_longitude = radians(280.4665 + 36000.7698 * t);
+    return (-17.20 * std::sin(omega) - 1.32 * std::sin(2 * sun_mean_longitude)) / 3600.0;
+}
+
+// geometric longitude referred to the mean equinox of date, degrees
+double sun_mean_equinox_longitude(double t) {
+    const double l0 = 280.46646 + 36000.76983 * t + 0.0003032 * t * t;
+    const double m = radians(357.52911 + 35999.05029 * t - 0.0001537 * t * t);
+    const double c = (1.914602 - 0.004817 * t - 0.000014 * t * t) * std::sin(m)
+            + (0.019993 - 0.000101 * t) * std::sin(2 * m)
+            + 0.000289 * std::sin(3 * m);
+    // minus annual aberration, to get the apparent position
+    return l0 + c - 0.00569;
+}
+
+struct MoonTerm {
+    signed char d;
+    signed char m;
+    signed char m1;
+    signed char f;
+    int sin_coeff; // 1e-6 degrees
+};
+
+// Periodic terms for the Moon's longitude (Meeus, table 47.A)
+constexpr std::array<MoonTerm, 59> moon_terms{{
+    {0, 0, 1, 0, 6288774}, {2, 0, -1, 0, 1274027}, {2, 0, 0, 0, 658314}, {0, 0, 2, 0, 213618},
+    {0, 1, 0, 0, -185116}, {0, 0, 0, 2, -114332}, {2, 0, -2, 0, 58793}, {2, -1, -1, 0, 57066},
+    {2, 0, 1, 0, 53322}, {2, -1, 0, 0, 45758}, {0, 1, -1, 0, -40923}, {1, 0, 0, 0, -34720},
+    {0, 1, 1, 0, -30383}, {2, 0, 0, -2, 15327}, {0, 0, 1, 2, -12528}, {0, 0, 1, -2, 10980},
+    {4, 0, -1, 0, 10675}, {0, 0, 3, 0, 10034}, {4, 0, -2, 0, 8548}, {2, 1, -1, 0, -7888},
+    {2, 1, 0, 0, -6766}, {1, 0, -1, 0, -5163}, {1, 1, 0, 0, 4987}, {2, -1, 1, 0, 4036},
+    {2, 0, 2, 0, 3994}, {4, 0, 0, 0, 3861}, {2, 0, -3, 0, 3665}, {0, 1, -2, 0, -2689},
+    {2, 0, -1, 2, -2602}, {2, -1, -2, 0, 2390}, {1, 0, 1, 0, -2348}, {2, -2, 0, 0, 2236},
+    {0, 1, 2, 0, -2120}, {0, 2, 0, 0, -2069}, {2, -2, -1, 0, 2048}, {2, 0, 1, -2, -1773},
+    {2, 0, 0, 2, -1595}, {4, -1, -1, 0, 1215}, {0, 0, 2, 2, -1110}, {3, 0, -1, 0, -892},
+    {2, 1, 1, 0, -810}, {4, -1, -2, 0, 759}, {0, 2, -1, 0, -713}, {2, 2, -1, 0, -700},
+    {2, 1, -2, 0, 691}, {2, -1, 0, -2, 596}, {4, 0, 1, 0, 549}, {0, 0, 4, 0, 537},
+    {4, -1, 0, 0, 520}, {1, 0, -2, 0, -487}, {2, 1, 0, -2, -399}, {0, 0, 2, -2, -381},
+    {1, 1, 1, 0, 351}, {3, 0, -2, 0, -340}, {4, 0, -3, 0, 330}, {2, -1, 2, 0, 327},
+    {0, 2, 1, 0, -323}, {1, 1, -1, 0, 299}, {2, 0, 3, 0, 294},
+}};
+
+// geometric longitude referred to the mean equinox of date, degrees
+double moon_mean_equinox_longitude(double t) {
+    const double l1 = 218.3164477 + 481267.88123421 * t - 0.0015786 * t * t + t * t * t / 538841.0;
+    const double d = radians(297.8501921 + 445267.1114034 * t - 0.0018819 * t * t + t * t * t / 545868.0);
+    const double m = radians(357.5291092 + 35999.0502909 * t - 0.0001536 * t * t);
+    const double m1 = radians(134.9633964 + 477198.8675055 * t + 0.0087414 * t * t + t * t * t / 69699.0);
+    const double f = radians(93.2720950 + 483202.0175233 * t - 0.0036539 * t * t);
+    const double a1 = radians(119.75 + 131.849 * t);
+    const double a2 = radians(53.09 + 479264.290 * t);
+    const double e = 1.0 - 0.002516 * t - 0.0000074 * t * t;
+
+    double sum = 3958.0 * std::sin(a1) + 1962.0 * std::sin(radians(l1) - f) + 318.0 * std::sin(a2);
+    for (const auto & term : moon_terms) {
+        const double argument = term.d * d + term.m * m + term.m1 * m1 + term.f * f;
+        const double e_factor = term.m == 0 ? 1.0 : (term.m == 1 || term.m == -1) ? e : e * e;
+        sum += term.sin_coeff * e_factor * std::sin(argument);
+    }
+    return l1 + sum / 1'000'000.0;
+}
+
+// Lahiri ayanāṃśa (mean, i.e. from mean equinox of date), degrees
+double ayanamsha(double t) {
+    return 23.857092 + (5029.0966 * t + 1.11113 * t * t) / 3600.0;
+}
+
+double mean_obliquity(double t) {
+    return 23.4392911 - (46.8150 * t + 0.00059 * t * t) / 3600.0;
+}
+
+struct SunPosition {
+    double right_ascension; // degrees
+    double declination;     // degrees
+};
+
+SunPosition sun_position(double t) {
+    const double longitude = radians(sun_mean_equinox_longitude(t));
+    const double obliquity = radians(mean_obliquity(t));
+    return SunPosition{
+        normalize_degrees(degrees(std::atan2(std::cos(obliquity) * std::sin(longitude), std::cos(longitude)))),
+        degrees(std::asin(std::sin(obliquity) * std::sin(longitude))),
+    };
+}
+
+// Greenwich mean sidereal time, degrees
+double sidereal_time(JulDays_UT time) {
+    const double d = time.raw_julian_days_ut().count() - j2000;
+    return normalize_degrees(280.46061837 + 360.98564736629 * d);
+}
+
+constexpr double sidereal_degrees_per_day = 360.98564736629;
+
+// Sweph calculates refraction for given pressure and temperature; this is the usual value for the horizon.
+constexpr double horizon_refraction = 34.5 / 60;
+constexpr double sun_semidiameter = 16.0 / 60;
+
+} // anonymous namespace
+
+ApproxSky::ApproxSky(const Location & location_, CalcFlags flags_)
+    : location(location_), flags(flags_)
+{
+    rise_altitude = 0.0;
+    if ((flags & CalcFlags::RefractionMask) == CalcFlags::RefractionOn) {
+        rise_altitude -= horizon_refraction;
+    }
+    if ((flags & CalcFlags::SunriseByDiscMask) == CalcFlags::SunriseByDiscEdge) {
+        rise_altitude -= sun_semidiameter;
+    }
+}
+
+double ApproxSky::sun_longitude(JulDays_UT time) const
+{
+    const double t = centuries_tt(time);
+    return normalize_degrees(sun_mean_equinox_longitude(t) + nutation_in_longitude(t));
+}
+
+double ApproxSky::moon_longitude(JulDays_UT time) const
+{
+    const double t = centuries_tt(time);
+    return normalize_degrees(moon_mean_equinox_longitude(t) + nutation_in_longitude(t));
+}
+
+Tithi ApproxSky::tithi(JulDays_UT time) const
+{
+    // nutation is the same for both and cancels out
+    const double t = centuries_tt(time);
+    const double elongation = normalize_degrees(moon_mean_equinox_longitude(t) - sun_mean_equinox_longitude(t));
+    return Tithi{elongation / (360.0/30)};
+}
+
+Nakshatra ApproxSky::nakshatra(JulDays_UT time) const
+{
+    const double t = centuries_tt(time);
+    return Nakshatra{normalize_degrees(moon_mean_equinox_longitude(t) - ayanamsha(t)) * (27.0/360.0)};
+}
+
+tl::expected<JulDays_UT, CalcError> ApproxSky::find_rise_or_set(JulDays_UT after, bool rise) const
+{
+    const double latitude = radians(location.latitude.latitude);
+    // Iterate towards the nearest rise (set) from the current estimate: the Sun's
+    // position changes little in between, so three iterations give a fraction of a second.
+    const auto nearest = [&](JulDays_UT estimate) -> tl::expected<JulDays_UT, CalcError> {
+        for (int i = 0; i < 3; ++i) {
+            const auto sun = sun_position(centuries_tt(estimate));
+            const double declination = radians(sun.declination);
+            const double cos_hour_angle = (std::sin(radians(rise_altitude)) - std::sin(latitude) * std::sin(declination))
+                    / (std::cos(latitude) * std::cos(declination));
+            if (cos_hour_angle < -1.0 || cos_hour_angle > 1.0) {
+                if (rise) return tl::make_unexpected(CantFindSunriseAfter{after});
+                return tl::make_unexpected(CantFindSunsetAfter{after});
+            }
+            const double event_hour_angle = degrees(std::acos(cos_hour_angle)) * (rise ? -1.0 : 1.0);
+            const double hour_angle = sidereal_time(estimate) + location.longitude.longitude - sun.right_ascension;
+            estimate += double_days{signed_degrees(event_hour_angle - hour_angle) / sidereal_degrees_per_day};
+        }
+        return estimate;
+    };
+    auto event = nearest(after);
+    if (!event) return event;
+    if (*event < after) {
+        event = nearest(*event + double_days{1.0});
+    }
+    return event;
+}
+
+tl::expected<JulDays_UT, CalcError> ApproxSky::find_sunrise(JulDays_UT after) const
+{
+    return find_rise_or_set(after, true);
+}
+
+tl::expected<JulDays_UT, CalcError> ApproxSky::find_sunset(JulDays_UT after) const
+{
+    return find_rise_or_set(after, false);
+}
+
+JulDays_UT ApproxSky::find_either_tithi_start(JulDays_UT from, Tithi target) const
+{
+    double delta = tithi(from).positive_delta_until_tithi(target);
+    if (delta >= 15.0) {
+        target += 15.0;
+        delta -= 15.0;
+    }
+    JulDays_UT time{from + delta * Tithi::AverageLength()};
+    // Newton-like iterations with the average tithi length instead of the derivative:
+    // converges to ~1e-7 tithi (under a tenth of second) in a few steps.
+    for (int i = 0; i < 20; ++i) {
+        const double step = tithi(time).delta_to_nearest_tithi(target);
+        time += step * Tithi::AverageLength();
+        if (std::fabs(step) < 1e-7) break;
+    }
+    return time;
+}
+
+} // namespace vp
@@ -0,0 +1,54 @@
+#ifndef VP_APPROX_SKY_H
+#define VP_APPROX_SKY_H
+
+#include "calc-error.h"
+#include "calc-flags.h"
+#include "juldays_ut.h"
+#include "location.h"
+#include "nakshatra.h"
+#include "tithi.h"
+
+#include <chrono>
+#include <tl/expected.hpp>
+
+namespace vp {
+
+/* Cheap analytic replacement for Swe: Sun by low-precision theory (Meeus, ch. 25),
+ * Moon by main terms of ELP-2000/82 (Meeus, ch. 47) and sunrise/sunset by hour angle
+ * of the Sun at the given altitude. Much cheaper than sweph,
+ * with no files and no global state.
+ *
+ * Tithi and nakṣatra starts are within a couple of minutes from sweph ones, and
+ * sunrise/sunset are within a minute up to ±60° latitude (not counting unusual
+ * refraction). ErrorBound() is a safe margin for all of those.
+ */
+class ApproxSky
+{
+public:
+    explicit ApproxSky(const Location & location, CalcFlags flags = CalcFlags::Default);
+
+    static constexpr std::chrono::minutes ErrorBound() { return std::chrono::minutes{10}; }
+
+    // apparent tropical longitudes, degrees [0..360)
+    double sun_longitude(JulDays_UT time) const;
+    double moon_longitude(JulDays_UT time) const;
+    Tithi tithi(JulDays_UT time) const;
+    Nakshatra nakshatra(JulDays_UT time) const;
+
+    tl::expected<JulDays_UT, CalcError> find_sunrise(JulDays_UT after) const;
+    tl::expected<JulDays_UT, CalcError> find_sunset(JulDays_UT after) const;
+    // start of the given tithi or the same tithi of the other pakṣa, whichever comes first after `from`
+    JulDays_UT find_either_tithi_start(JulDays_UT from, Tithi tithi) const;
+
+    Location location;
+    CalcFlags flags;
+
+private:
+    // Sun's altitude at rise/set, degrees
+    double rise_altitude;
+    tl::expected<JulDays_UT, CalcError> find_rise_or_set(JulDays_UT after, bool rise) const;
+};
+
+} // namespace vp
+
+#endif // VP_APPROX_SKY_H
@@ -0,0 +1,71 @@
+#include "catch-formatters.h"
+
+#include "approx-sky.h"
+#include "swe.h"
+
+#include <chrono>
+
+using namespace date;
+using namespace std::literals::chrono_literals;
+
+namespace {
+// ApproxSky::ErrorBound() expressed in tithis and nakṣatras (with average Moon speed)
+constexpr double bound_days = vp::double_days{vp::ApproxSky::ErrorBound()}.count();
+constexpr double tithi_margin = bound_days / (29.53 / 30);
+constexpr double nakshatra_margin = bound_days / (27.32 / 27);
+
+// shortest signed difference, for values wrapping around at `period`
+double wrapped_difference(double one, double other, double period) {
+    double diff = std::fmod(one - other, period);
+    if (diff > period / 2) diff -= period;
+    if (diff < -period / 2) diff += period;
+    return diff;
+}
+}
+
+TEST_CASE("ApproxSky tithi and nakshatra are within error bound from sweph") {
+    const auto time = GENERATE(
+        vp::JulDays_UT{2000_y/January/1},
+        vp::JulDays_UT{2019_y/March/10},
+        vp::JulDays_UT{2019_y/March/21, vp::double_hours{1.716666}},
+        vp::JulDays_UT{2020_y/November/6, vp::double_hours{7.3}},
+        vp::JulDays_UT{2025_y/July/4, vp::double_hours{18.0}},
+        vp::JulDays_UT{2035_y/December/31});
+    CAPTURE(time);
+    const vp::Swe swe{vp::udupi_coord};
+    const vp::ApproxSky sky{vp::udupi_coord};
+    REQUIRE(std::fabs(wrapped_difference(sky.tithi(time).tithi, swe.get_tithi(time).tithi, 30.0)) < tithi_margin / 4);
+    REQUIRE(std::fabs(wrapped_difference(sky.nakshatra(time).nakshatra, swe.get_nakshatra(time).nakshatra, 27.0)) < nakshatra_margin / 4);
+    // ~36 arcseconds: a bit more than both low-precision theories promise
+    REQUIRE(std::fabs(wrapped_difference(sky.sun_longitude(time), swe.get_sun_longitude(time), 360.0)) < 0.01);
+    REQUIRE(std::fabs(wrapped_difference(sky.moon_longitude(time), swe.get_moon_longitude(time), 360.0)) < 0.01);
+}
+
+TEST_CASE("ApproxSky sunrise and sunset are within error bound from sweph") {
+    const auto flags = GENERATE(vp::CalcFlags::Default, vp::CalcFlags::SunriseByDiscEdge | vp::CalcFlags::RefractionOn);
+    const auto location = GENERATE(vp::udupi_coord, vp::kiev_coord, vp::toronto_coord);
+    const auto after = GENERATE(vp::JulDays_UT{2019_y/March/10}, vp::JulDays_UT{2021_y/June/21}, vp::JulDays_UT{2021_y/December/22});
+    CAPTURE(location.name, after);
+    const vp::Swe swe{location, flags};
+    const vp::ApproxSky sky{location, flags};
+    const auto sunrise = sky.find_sunrise(after);
+    REQUIRE(sunrise.has_value());
+    REQUIRE(std::chrono::abs(*sunrise - swe.find_sunrise_v(after)) < vp::ApproxSky::ErrorBound() / 5);
+    const auto sunset = sky.find_sunset(after);
+    REQUIRE(sunset.has_value());
+    REQUIRE(std::chrono::abs(*sunset - swe.find_sunset_v(after)) < vp::ApproxSky::ErrorBound() / 5);
+}
+
+TEST_CASE("ApproxSky finds no sunrise in polar night") {
+    const vp::ApproxSky sky{vp::murmansk_coord};
+    REQUIRE_FALSE(sky.find_sunrise(vp::JulDays_UT{2019_y/December/20}).has_value());
+}
+
+TEST_CASE("ApproxSky::find_either_tithi_start() gives the next tithi start of either paksha") {
+    const vp::ApproxSky sky{vp::kiev_coord};
+    const vp::JulDays_UT from{2019_y/May/12};
+    const auto time = sky.find_either_tithi_start(from, vp::Tithi::Ekadashi());
+    REQUIRE(time > from);
+    REQUIRE(time - from <= vp::double_days{14});
+    REQUIRE(std::fmod(sky.tithi(time).tithi, 15.0) == Approx(vp::Tithi::Ekadashi().tithi).margin(1e-6));
+}
@@ -0,0 +1,134 @@
+#include "async-calc.h"
+
+#include "boundary-cache.h"
+#include "text-interface.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace vp::text_ui {
+
+std::vector<LocationVratas> calc_vratas(const CalcRequest & request, const CancellationToken & cancellation,
+                                        const CalcProgress & progress)
+{
+    std::vector<LocationVratas> result;
+    result.reserve(request.locations.size());
+    // shared by all locations and dates of the request
+    const auto boundary_cache = std::make_shared<BoundaryCache>(request.flags & CalcFlags::EphemerisMask);
+    for (const auto & location : request.locations) {
+        cancellation.throw_if_cancelled();
+        auto & vratas = result.emplace_back(LocationVratas{location, {}}).vratas;
+        for (auto base_date = request.from; base_date <= request.to;) {
+            auto vrata = find_next(base_date, location, request.flags, boundary_cache, VrataParts::All, cancellation);
+            if (!vrata) {
+                vratas.push_back(std::move(vrata));
+                break;
+            }
+            if (vrata->date > request.to) break;
+            // max() just in case, to make sure we never loop forever
+            base_date = std::max(base_date, vrata->date) + date::days{1};
+            vratas.push_back(std::move(vrata));
+        }
+        if (progress) progress(result.size(), request.locations.size());
+    }
+    return result;
+}
+
+AsyncCalc::AsyncCalc() : worker{[this] { run(); }}
+{
+}
+
+AsyncCalc::~AsyncCalc()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+        running.cancel();
+        for (auto & task : tasks) {
+            task.cancel();
+        }
+        tasks.clear();
+    }
+    wake_up.notify_one();
+    worker.join();
+}
+
+namespace {
+// see AsyncCalc::submit()
+CancellationToken cancellable(CancellationToken cancellation) {
+    return cancellation.can_be_cancelled() ? cancellation : CancellationToken::make();
+}
+}
+
+template<typename Result, typename Calculate>
+std::future<Result> AsyncCalc::enqueue(CancellationToken cancellation, Calculate calculate, CalcDone done)
+{
+    // shared: std::function needs copyable callables
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future();
+    Task task{
+        std::move(cancellation),
+        [promise, calculate = std::move(calculate)] {
+            try {
+                promise->set_value(calculate());
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        },
+        [promise] {
+            promise->set_exception(std::make_exception_ptr(Cancelled{}));
+        },
+        std::move(done)};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        tasks.push_back(std::move(task));
+    }
+    wake_up.notify_one();
+    return future;
+}
+
+std::future<std::vector<LocationVratas>> AsyncCalc::submit(CalcRequest request, CancellationToken cancellation, CalcProgress progress)
+{
+    cancellation = cancellable(std::move(cancellation));
+    return enqueue<std::vector<LocationVratas>>(cancellation, [request = std::move(request), cancellation, progress = std::move(progress)] {
+        return calc_vratas(request, cancellation, progress);
+    }, {});
+}
+
+std::future<VratasForDate> AsyncCalc::submit(NextVratasRequest request, CancellationToken cancellation, CalcDone done)
+{
+    cancellation = cancellable(std::move(cancellation));
+    return enqueue<VratasForDate>(cancellation, [request = std::move(request), cancellation] {
+        return calc(request.base_date, request.location_name, request.flags, std::pmr::get_default_resource(),
+                    request.boundary_cache, cancellation);
+    }, std::move(done));
+}
+
+void AsyncCalc::run()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            wake_up.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            running = task.cancellation;
+        }
+        // abandoned while waiting: no need to start calculating just to notice that
+        if (task.cancellation.cancelled()) {
+            task.cancel();
+        } else {
+            task.run();
+        }
+        if (task.done) task.done();
+        std::lock_guard<std::mutex> lock{mutex};
+        running = {};
+    }
+}
+
+} // namespace vp::text_ui
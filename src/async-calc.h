@@ -0,0 +1,104 @@
+#ifndef VP_ASYNC_CALC_H
+#define VP_ASYNC_CALC_H
+
+#include "boundary-cache.h"
+#include "calc-flags.h"
+#include "cancellation.h"
+#include "location.h"
+#include "vrata.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vp::text_ui {
+
+// All vratas for each of the locations with dates in [from, to].
+struct CalcRequest {
+    std::vector<Location> locations;
+    date::local_days from;
+    date::local_days to;
+    CalcFlags flags = CalcFlags::Default;
+};
+
+// Next vratas on or after base_date for the named location (or "all"), same as text_ui::calc() gives.
+struct NextVratasRequest {
+    date::year_month_day base_date;
+    std::string location_name;
+    CalcFlags flags = CalcFlags::Default;
+    // see calc(): e.g. GUI session's one; AsyncCalc only uses it from the worker thread
+    std::shared_ptr<BoundaryCache> boundary_cache;
+};
+
+struct LocationVratas {
+    Location location;
+    // in date order; ends with the error if some vrata couldn't be calculated
+    std::vector<MaybeVrata> vratas;
+};
+
+// Called after every location with the number of locations done and overall.
+using CalcProgress = std::function<void(std::size_t done, std::size_t total)>;
+// Called once the request's future is ready, whatever the outcome.
+using CalcDone = std::function<void()>;
+
+// Calculate the request right here, one result per location in the same order.
+// Vratas come from the vrata db when it's there, like find_next() does.
+// Throws Cancelled once cancellation is cancelled.
+std::vector<LocationVratas> calc_vratas(const CalcRequest & request, const CancellationToken & cancellation = {},
+                                        const CalcProgress & progress = {});
+
+/* Runs submitted requests on its own worker thread, one at a time in order of
+ * submission: calc_vratas() for CalcRequest, calc() for NextVratasRequest.
+ *
+ * To abandon a request, cancel its token: if it's still waiting, it's skipped
+ * without calculating anything when its turn comes; if it's being calculated, that
+ * stops within a few ephemeris calls. Either way its future throws Cancelled.
+ * Destroying AsyncCalc cancels everything not done yet.
+ * Progress and done callbacks are called on the worker thread (but not from the destructor).
+ */
+class AsyncCalc {
+public:
+    AsyncCalc();
+    ~AsyncCalc();
+    AsyncCalc(const AsyncCalc &) = delete;
+    AsyncCalc & operator=(const AsyncCalc &) = delete;
+
+    // Token which can't be cancelled is replaced with one that can (for the destructor's sake).
+    std::future<std::vector<LocationVratas>> submit(CalcRequest request, CancellationToken cancellation = {},
+                                                    CalcProgress progress = {});
+    std::future<VratasForDate> submit(NextVratasRequest request, CancellationToken cancellation = {},
+                                      CalcDone done = {});
+
+private:
+    struct Task {
+        CancellationToken cancellation;
+        // calculates and makes the future ready; never throws
+        std::function<void()> run;
+        // makes the future throw Cancelled
+        std::function<void()> cancel;
+        CalcDone done;
+    };
+
+    template<typename Result, typename Calculate>
+    std::future<Result> enqueue(CancellationToken cancellation, Calculate calculate, CalcDone done);
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable wake_up;
+    std::deque<Task> tasks;
+    CancellationToken running;
+    bool stopping = false;
+    // last: started when everything else is ready
+    std::thread worker;
+};
+
+} // namespace vp::text_ui
+
+#endif // VP_ASYNC_CALC_H
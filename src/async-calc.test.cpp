@@ -0,0 +1,130 @@
+#include "catch-formatters.h"
+
+#include "async-calc.h"
+#include "calc.h"
+#include "text-interface.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+using namespace date;
+
+namespace {
+vp::text_ui::CalcRequest udupi_and_kiev_request() {
+    return {{vp::udupi_coord, vp::kiev_coord}, local_days{2021_y/January/1}, local_days{2021_y/March/31}, vp::CalcFlags::Default};
+}
+}
+
+TEST_CASE("calc_vratas() gives every vrata in the date range for every location") {
+    const auto request = udupi_and_kiev_request();
+    std::vector<std::size_t> progress;
+    const auto result = vp::text_ui::calc_vratas(request, {}, [&](std::size_t done, std::size_t total) {
+        REQUIRE(total == 2);
+        progress.push_back(done);
+    });
+    REQUIRE(progress == std::vector<std::size_t>{1, 2});
+    REQUIRE(result.size() == 2);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        REQUIRE(result[i].location.name == request.locations[i].name);
+        // two ekādaśīs a month
+        REQUIRE(result[i].vratas.size() == 6);
+        auto base_date = request.from;
+        for (const auto & vrata : result[i].vratas) {
+            const auto expected = vp::text_ui::find_next(base_date, request.locations[i]);
+            REQUIRE(vrata.has_value());
+            REQUIRE(expected.has_value());
+            REQUIRE(*vrata == *expected);
+            base_date = vrata->date + days{1};
+        }
+    }
+}
+
+TEST_CASE("AsyncCalc gives the same vratas as calc_vratas()") {
+    vp::text_ui::AsyncCalc async_calc;
+    auto future = async_calc.submit(udupi_and_kiev_request());
+    const auto expected = vp::text_ui::calc_vratas(udupi_and_kiev_request());
+    const auto result = future.get();
+    REQUIRE(result.size() == expected.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        REQUIRE(result[i].vratas.size() == expected[i].vratas.size());
+        for (std::size_t j = 0; j < result[i].vratas.size(); ++j) {
+            REQUIRE(*result[i].vratas[j] == *expected[i].vratas[j]);
+        }
+    }
+}
+
+TEST_CASE("AsyncCalc gives the same next vratas as calc()") {
+    std::atomic<int> done_calls{0};
+    std::future<vp::VratasForDate> future;
+    {
+        vp::text_ui::AsyncCalc async_calc;
+        future = async_calc.submit(vp::text_ui::NextVratasRequest{2021_y/March/20, "all", vp::CalcFlags::Default, nullptr}, {}, [&] { ++done_calls; });
+        future.wait();
+        // destructor waits for the worker, so done has been called by then
+    }
+    REQUIRE(done_calls == 1);
+    const auto result = future.get();
+    const auto expected = vp::text_ui::calc(2021_y/March/20, "all");
+    REQUIRE(result.size() == expected.size());
+    auto expected_vrata = expected.begin();
+    for (const auto & vrata : result) {
+        REQUIRE(vrata.has_value() == expected_vrata->has_value());
+        if (vrata) REQUIRE(*vrata == **expected_vrata);
+        ++expected_vrata;
+    }
+}
+
+TEST_CASE("AsyncCalc abandons cancelled requests") {
+    vp::text_ui::AsyncCalc async_calc;
+    vp::text_ui::CalcRequest request{{}, local_days{2021_y/January/1}, local_days{2021_y/December/31}, vp::CalcFlags::Default};
+    for (const auto & location : vp::text_ui::LocationDb()) request.locations.push_back(location);
+
+    SECTION("before it's started") {
+        auto cancellation = vp::CancellationToken::make();
+        cancellation.cancel();
+        std::size_t progress_calls = 0;
+        auto future = async_calc.submit(request, cancellation, [&](std::size_t, std::size_t) { ++progress_calls; });
+        REQUIRE_THROWS_AS(future.get(), vp::Cancelled);
+        // skipped, not started
+        REQUIRE(progress_calls == 0);
+    }
+    SECTION("while it's calculated") {
+        auto cancellation = vp::CancellationToken::make();
+        std::size_t progress_calls = 0;
+        auto future = async_calc.submit(request, cancellation, [&](std::size_t, std::size_t) {
+            ++progress_calls;
+            cancellation.cancel();
+        });
+        REQUIRE_THROWS_AS(future.get(), vp::Cancelled);
+        REQUIRE(progress_calls == 1);
+    }
+    SECTION("and the next ones still get calculated") {
+        auto cancellation = vp::CancellationToken::make();
+        auto cancelled = async_calc.submit(request, cancellation);
+        auto next = async_calc.submit(udupi_and_kiev_request());
+        cancellation.cancel();
+        REQUIRE_THROWS_AS(cancelled.get(), vp::Cancelled);
+        REQUIRE(next.get().size() == 2);
+    }
+    SECTION("when AsyncCalc is destroyed") {
+        std::future<std::vector<vp::text_ui::LocationVratas>> first, second;
+        {
+            vp::text_ui::AsyncCalc short_lived;
+            first = short_lived.submit(request);
+            second = short_lived.submit(request);
+        }
+        REQUIRE_THROWS_AS(first.get(), vp::Cancelled);
+        REQUIRE_THROWS_AS(second.get(), vp::Cancelled);
+    }
+}
+
+TEST_CASE("Calc with cancelled token throws Cancelled instead of searching") {
+    auto cancellation = vp::CancellationToken::make();
+    vp::Calc calc{vp::Swe{vp::udupi_coord}, nullptr, cancellation};
+    REQUIRE(calc.find_next_vrata(local_days{2021_y/January/1}).has_value());
+    cancellation.cancel();
+    REQUIRE_THROWS_AS(calc.find_next_vrata(local_days{2021_y/January/1}), vp::Cancelled);
+    REQUIRE_FALSE(vp::CancellationToken{}.cancelled());
+}
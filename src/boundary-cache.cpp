@@ -0,0 +1,31 @@
+#include "boundary-cache.h"
+
+namespace vp {
+
+namespace {
+// Same tithi repeats after ~29.5 days, same nakṣatra after ~27.3 days.
+constexpr double max_distance_days = 5.0;
+}
+
+BoundaryCache::BoundaryCache(CalcFlags ephemeris) : ephemeris_(ephemeris & CalcFlags::EphemerisMask)
+{}
+
+std::optional<JulDays_UT> BoundaryCache::find(Kind kind, double value, JulDays_UT near) const
+{
+    const double near_days = near.raw_julian_days_ut().count();
+    const auto end = starts_.upper_bound(near_days + max_distance_days);
+    for (auto it = starts_.lower_bound(near_days - max_distance_days); it != end; ++it) {
+        if (it->second.first == kind && it->second.second == value) {
+            ++hits_;
+            return JulDays_UT{double_days{it->first}};
+        }
+    }
+    return std::nullopt;
+}
+
+void BoundaryCache::add(Kind kind, double value, JulDays_UT start)
+{
+    starts_.emplace(start.raw_julian_days_ut().count(), std::make_pair(kind, value));
+}
+
+} // namespace vp
@@ -0,0 +1,47 @@
+#ifndef VP_BOUNDARY_CACHE_H
+#define VP_BOUNDARY_CACHE_H
+
+#include "calc-flags.h"
+#include "juldays_ut.h"
+
+#include <map>
+#include <optional>
+
+namespace vp {
+
+/* Exact tithi and nakṣatra start times found so far, to be reused by other Calc
+ * instances.
+ *
+ * Those boundaries are geocentric: they depend only on the ephemeris (Swiss or
+ * Moshier), not on location or any of the sunrise/sunset flags. So the same
+ * cache can be shared by all calculations with the same ephemeris flag, e.g.
+ * when comparing results for different CalcFlags.
+ */
+class BoundaryCache {
+public:
+    enum class Kind { Tithi, Nakshatra };
+
+    explicit BoundaryCache(CalcFlags ephemeris);
+
+    // Only Calc with the same ephemeris flag can use this cache.
+    CalcFlags ephemeris() const { return ephemeris_; }
+
+    // Cached start of the given tithi/nakṣatra if it's close enough to `near` to
+    // be the one the search would converge to (the same value only repeats in
+    // ~27-30 days, while initial estimate is never more than few days off).
+    std::optional<JulDays_UT> find(Kind kind, double value, JulDays_UT near) const;
+    void add(Kind kind, double value, JulDays_UT start);
+
+    std::size_t size() const { return starts_.size(); }
+    std::size_t hits() const { return hits_; }
+
+private:
+    CalcFlags ephemeris_;
+    // by start time
+    std::multimap<double, std::pair<Kind, double>> starts_;
+    mutable std::size_t hits_ = 0;
+};
+
+} // namespace vp
+
+#endif // VP_BOUNDARY_CACHE_H
@@ -0,0 +1,268 @@
+#include "c-api.h"
+
+#include "boundary-cache.h"
+#include "place-db.h"
+#include "swe.h"
+#include "text-interface.h"
+#include "time-zone-db.h"
+#include "vrata-db.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+// C API values are converted with static_cast, so they must stay the same as the C++ ones
+static_assert(VP_VRATA_EKADASHI == static_cast<int>(vp::Vrata_Type::Ekadashi));
+static_assert(VP_VRATA_WITH_ATIRIKTA_EKADASHI == static_cast<int>(vp::Vrata_Type::With_Atirikta_Ekadashi));
+static_assert(VP_VRATA_WITH_ATIRIKTA_DVADASHI == static_cast<int>(vp::Vrata_Type::With_Atirikta_Dvadashi));
+static_assert(VP_VRATA_WITH_SHRAVANA_DVADASHI_NEXT_DAY == static_cast<int>(vp::Vrata_Type::With_Shravana_Dvadashi_Next_Day));
+static_assert(VP_VRATA_WITH_SHRAVANA_DVADASHI_SAME_DAY == static_cast<int>(vp::Vrata_Type::With_Shravana_Dvadashi_Same_Day));
+static_assert(VP_FLAGS_DEFAULT == static_cast<int>(vp::CalcFlags::Default));
+static_assert(VP_FLAGS_SUNRISE_BY_DISC_EDGE == static_cast<int>(vp::CalcFlags::SunriseByDiscEdge));
+static_assert(VP_FLAGS_REFRACTION_ON == static_cast<int>(vp::CalcFlags::RefractionOn));
+static_assert(VP_FLAGS_EPHEMERIS_MOSHIER == static_cast<int>(vp::CalcFlags::EphemerisMoshier));
+static_assert(VP_FLAGS_RISE_SET_GEOCENTRIC_ON == static_cast<int>(vp::CalcFlags::RiseSetGeocentricOn));
+static_assert(VP_FLAGS_SHRAVANA_DVADASHI_14GH_PLUS == static_cast<int>(vp::CalcFlags::ShravanaDvadashi14ghPlus));
+// vp_vrata::masa and vp_vrata::paksha values as documented in c-api.h
+static_assert(static_cast<int>(vp::Chandra_Masa::Unknown) == 0);
+static_assert(static_cast<int>(vp::Chandra_Masa::Chaitra) == 1);
+static_assert(static_cast<int>(vp::Chandra_Masa::Phalguna) == 12);
+static_assert(static_cast<int>(vp::Chandra_Masa::Adhika) == 13);
+static_assert(static_cast<int>(vp::Chandra_Masa::Kshaya) == 14);
+static_assert(static_cast<int>(vp::Paksha::Unknown) == 0);
+static_assert(static_cast<int>(vp::Paksha::Shukla) == 1);
+static_assert(static_cast<int>(vp::Paksha::Krishna) == 2);
+
+struct vp_context {
+    vp_context(vp::CalcFlags f, vp::VrataParts p)
+        : flags(f), parts(p), boundary_cache(std::make_shared<vp::BoundaryCache>(f & vp::CalcFlags::EphemerisMask)) {}
+
+    vp::CalcFlags flags;
+    // vp_vrata has no nameworthy dates, so they are never calculated
+    vp::VrataParts parts;
+    // Tithi and nakṣatra starts found by this context's queries, reused by the next ones.
+    // Contexts are used by one thread at a time, which is all BoundaryCache needs.
+    std::shared_ptr<vp::BoundaryCache> boundary_cache;
+    // VratasForDate of one call (the vector and dates of each vrata) is allocated here and
+    // released before the next call. Calculations themselves allocate as usual.
+    std::array<std::byte, 256 * 1024> buffer;
+    std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size()};
+    fmt::memory_buffer report;
+};
+
+namespace {
+// vp_init() and vp_set_threads() change text_ui settings, which aren't synchronized with calculations:
+// they lock it exclusively, queries (which are thread-safe otherwise) lock it shared.
+std::shared_mutex api_mutex;
+
+// Run f under the lock: no exceptions may cross the C interface.
+template<typename Lock, typename F>
+vp_status locked(F && f) noexcept {
+    try {
+        Lock lock{api_mutex};
+        return f();
+    } catch (...) {
+        return VP_ERROR_INTERNAL;
+    }
+}
+
+// for queries, which run in parallel with each other
+template<typename F>
+vp_status guarded(F && f) noexcept {
+    return locked<std::shared_lock<std::shared_mutex>>(std::forward<F>(f));
+}
+
+// for settings: waits for running queries
+template<typename F>
+vp_status guarded_exclusive(F && f) noexcept {
+    return locked<std::unique_lock<std::shared_mutex>>(std::forward<F>(f));
+}
+
+void copy_name(std::string_view from, char (&to)[VP_NAME_SIZE]) {
+    const auto length = std::min(from.size(), sizeof(to) - 1);
+    std::memcpy(to, from.data(), length);
+    to[length] = '\0';
+}
+
+double julian_days(std::optional<vp::JulDays_UT> time) {
+    return time ? time->raw_julian_days_ut().count() : std::numeric_limits<double>::quiet_NaN();
+}
+
+vp_status status_for(const vp::CalcError & error) {
+    if (std::holds_alternative<vp::CantFindLocation>(error)) return VP_ERROR_UNKNOWN_LOCATION;
+    return VP_ERROR_NO_SUNRISE_OR_SUNSET;
+}
+
+void fill(const vp::MaybeVrata & vrata, vp::VrataParts parts, vp_vrata & out) {
+    out = vp_vrata{};
+    if (!vrata) {
+        out.status = status_for(vrata.error());
+        return;
+    }
+    const date::year_month_day ymd{vrata->date};
+    out.status = VP_OK;
+    out.year = static_cast<int>(ymd.year());
+    out.month = static_cast<int32_t>(static_cast<unsigned>(ymd.month()));
+    out.day = static_cast<int32_t>(static_cast<unsigned>(ymd.day()));
+    // might be there anyway (e.g. from the vrata db), but only give what was asked for
+    const bool date_only = !vp::wants(parts, vp::VrataParts::Type);
+    out.type = date_only ? VP_VRATA_UNKNOWN : static_cast<int32_t>(vrata->type);
+    out.masa = date_only ? 0 : static_cast<int32_t>(vrata->masa);
+    out.paksha = static_cast<int32_t>(vrata->paksha);
+    out.latitude_adjusted = vrata->location.latitude_adjusted ? 1 : 0;
+    out.sunrise1 = julian_days(vrata->sunrise1);
+    out.sunrise2 = julian_days(vrata->sunrise2);
+    out.paran_start = date_only ? julian_days(std::nullopt) : julian_days(vrata->paran.paran_start);
+    out.paran_end = date_only ? julian_days(std::nullopt) : julian_days(vrata->paran.paran_end);
+    out.latitude = vrata->location.latitude.latitude;
+    out.longitude = vrata->location.longitude.longitude;
+    copy_name(vrata->location.name, out.location_name);
+    copy_name(vrata->location.time_zone_name, out.time_zone);
+}
+
+std::optional<date::year_month_day> to_date(int32_t year, int32_t month, int32_t day) {
+    if (month < 1 || month > 12 || day < 1 || day > 31) return std::nullopt;
+    const date::year_month_day ymd{date::year{year}, date::month{static_cast<unsigned>(month)}, date::day{static_cast<unsigned>(day)}};
+    if (!ymd.ok()) return std::nullopt;
+    return ymd;
+}
+} // anonymous namespace
+
+extern "C" {
+
+vp_status vp_init(const char * data_dir)
+{
+    if (!data_dir) return VP_ERROR_INVALID_ARGUMENT;
+    return guarded_exclusive([data_dir] {
+        const auto dir = fs::u8path(data_dir);
+        date::set_install((dir / "tzdata").string());
+        // load time zones now rather than on the first query
+        date::locate_zone("UTC");
+        vp::Swe::set_ephemeris_path((dir / "eph").string());
+        vp::text_ui::use_vrata_db(dir / vp::VrataDb::DefaultFileName);
+        vp::text_ui::use_place_db(dir / vp::PlaceDb::DefaultFileName);
+        vp::text_ui::use_time_zone_db(dir / vp::TimeZoneDb::DefaultFileName);
+        return VP_OK;
+    });
+}
+
+vp_status vp_set_threads(uint32_t count)
+{
+    return guarded_exclusive([count] {
+        vp::text_ui::set_calc_threads(count);
+        return VP_OK;
+    });
+}
+
+vp_context * vp_context_create(uint32_t flags)
+{
+    constexpr uint32_t known_flags = VP_FLAGS_SUNRISE_BY_DISC_EDGE | VP_FLAGS_REFRACTION_ON | VP_FLAGS_EPHEMERIS_MOSHIER
+            | VP_FLAGS_RISE_SET_GEOCENTRIC_ON | VP_FLAGS_SHRAVANA_DVADASHI_14GH_PLUS;
+    if ((flags & ~(known_flags | VP_FLAGS_DATE_ONLY)) != 0) return nullptr;
+    const auto parts = (flags & VP_FLAGS_DATE_ONLY) != 0 ? vp::VrataParts::DateOnly : vp::VrataParts::Paran | vp::VrataParts::Masa;
+    try {
+        return new vp_context{static_cast<vp::CalcFlags>(flags & known_flags), parts};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void vp_context_destroy(vp_context * context)
+{
+    delete context;
+}
+
+vp_status vp_next_vrata(vp_context * context, int32_t year, int32_t month, int32_t day,
+                        const char * location_name, vp_vrata * result)
+{
+    const auto date = to_date(year, month, day);
+    if (!context || !location_name || !result || !date) return VP_ERROR_INVALID_ARGUMENT;
+    return guarded([&] {
+        context->resource.release();
+        const auto vratas = vp::text_ui::calc(*date, location_name, context->flags, &context->resource, context->boundary_cache, {}, context->parts);
+        fill(*vratas.begin(), context->parts, *result);
+        return static_cast<vp_status>(result->status);
+    });
+}
+
+vp_status vp_next_vrata_at(vp_context * context, int32_t year, int32_t month, int32_t day,
+                           double latitude, double longitude, vp_vrata * result)
+{
+    const auto date = to_date(year, month, day);
+    if (!context || !result || !date || !(latitude >= -90.0 && latitude <= 90.0) || !(longitude >= -180.0 && longitude <= 180.0)) {
+        return VP_ERROR_INVALID_ARGUMENT;
+    }
+    return guarded([&] {
+        const auto location = vp::text_ui::custom_location(vp::Coord{vp::Latitude{latitude}, vp::Longitude{longitude}});
+        fill(vp::text_ui::find_next(date::local_days{*date}, location, context->flags, context->boundary_cache, context->parts), context->parts, *result);
+        return static_cast<vp_status>(result->status);
+    });
+}
+
+vp_status vp_next_vratas(vp_context * context, int32_t year, int32_t month, int32_t day,
+                         const char * location_name, vp_vrata * results, size_t capacity, size_t * count)
+{
+    const auto date = to_date(year, month, day);
+    if (!context || !location_name || (!results && capacity > 0) || !count || !date) return VP_ERROR_INVALID_ARGUMENT;
+    return guarded([&] {
+        context->resource.release();
+        const auto vratas = vp::text_ui::calc(*date, location_name, context->flags, &context->resource, context->boundary_cache, {}, context->parts);
+        *count = vratas.size();
+        std::size_t i = 0;
+        for (const auto & vrata : vratas) {
+            if (i == capacity) return VP_ERROR_BUFFER_TOO_SMALL;
+            fill(vrata, context->parts, results[i++]);
+        }
+        return VP_OK;
+    });
+}
+
+vp_status vp_report(vp_context * context, int32_t year, int32_t month, int32_t day,
+                    const char * location_name, char * buffer, size_t size, size_t * length)
+{
+    const auto date = to_date(year, month, day);
+    if (!context || !location_name || (!buffer && size > 0) || !date) return VP_ERROR_INVALID_ARGUMENT;
+    return guarded([&] {
+        context->report.clear();
+        const auto vrata = vp::text_ui::find_calc_and_report_one(*date, location_name, fmt::appender{context->report}, context->flags);
+        const std::size_t full_length = context->report.size();
+        if (length) *length = full_length;
+        if (size > 0) {
+            const auto copied = std::min(full_length, size - 1);
+            std::memcpy(buffer, context->report.data(), copied);
+            buffer[copied] = '\0';
+        }
+        if (full_length >= size) return VP_ERROR_BUFFER_TOO_SMALL;
+        return vrata ? VP_OK : status_for(vrata.error());
+    });
+}
+
+const char * vp_status_message(vp_status status)
+{
+    switch (status) {
+    case VP_OK: return "OK";
+    case VP_ERROR_INVALID_ARGUMENT: return "invalid argument";
+    case VP_ERROR_UNKNOWN_LOCATION: return "unknown location name";
+    case VP_ERROR_NO_SUNRISE_OR_SUNSET: return "can't find sunrise or sunset";
+    case VP_ERROR_BUFFER_TOO_SMALL: return "buffer too small";
+    case VP_ERROR_INTERNAL: return "internal error";
+    }
+    return "unknown status";
+}
+
+const char * vp_version(void)
+{
+    try {
+        static const std::string version = vp::text_ui::program_name_and_version();
+        return version.c_str();
+    } catch (...) {
+        return "unknown";
+    }
+}
+
+} // extern "C"
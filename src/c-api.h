@@ -0,0 +1,127 @@
+#ifndef VP_C_API_H
+#define VP_C_API_H
+
+/* C interface of vaishnavam-panchangam-c shared library, for calculating vratas
+ * in-process from other languages and services.
+ *
+ * Call vp_init() once, then create a context per worker and keep it for as long as
+ * you need it: it keeps a buffer which the results container of each query is
+ * allocated from. The calculation itself still allocates memory as usual.
+ * It also keeps tithi and nakṣatra starts found by its queries for the next ones.
+ * Nothing here throws or keeps pointers to the caller's memory.
+ * Queries on different contexts run in parallel, but each context must only be used
+ * by one thread at a time. vp_init() and vp_set_threads() wait for running queries.
+ * Calculations for all locations at once can use several threads, see vp_set_threads().
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && !defined(VP_C_API_STATIC)
+#  ifdef VP_C_API_EXPORTS
+#    define VP_API __declspec(dllexport)
+#  else
+#    define VP_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define VP_API __attribute__((visibility("default")))
+#else
+#  define VP_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum vp_status {
+    VP_OK = 0,
+    VP_ERROR_INVALID_ARGUMENT = 1,
+    VP_ERROR_UNKNOWN_LOCATION = 2,
+    VP_ERROR_NO_SUNRISE_OR_SUNSET = 3, /* polar day or night even after moving closer to the equator */
+    VP_ERROR_BUFFER_TOO_SMALL = 4,
+    VP_ERROR_INTERNAL = 5
+} vp_status;
+
+/* same values as vp::Vrata_Type (except for VP_VRATA_UNKNOWN) */
+typedef enum vp_vrata_type {
+    VP_VRATA_UNKNOWN = -1, /* not calculated, see VP_FLAGS_DATE_ONLY */
+    VP_VRATA_EKADASHI = 0,
+    VP_VRATA_WITH_ATIRIKTA_EKADASHI = 1,
+    VP_VRATA_WITH_ATIRIKTA_DVADASHI = 2,
+    VP_VRATA_WITH_SHRAVANA_DVADASHI_NEXT_DAY = 3,
+    VP_VRATA_WITH_SHRAVANA_DVADASHI_SAME_DAY = 4
+} vp_vrata_type;
+
+/* flags for vp_context_create(), same values as vp::CalcFlags */
+#define VP_FLAGS_DEFAULT 0
+#define VP_FLAGS_SUNRISE_BY_DISC_EDGE 1
+#define VP_FLAGS_REFRACTION_ON 2
+#define VP_FLAGS_EPHEMERIS_MOSHIER 4
+#define VP_FLAGS_RISE_SET_GEOCENTRIC_ON 8
+#define VP_FLAGS_SHRAVANA_DVADASHI_14GH_PLUS 16
+/* Only date, pakṣa, sunrises and location for vp_next_vrata*() results, which is much faster:
+ * type is VP_VRATA_UNKNOWN, masa 0 and paran limits NaN. Not a vp::CalcFlags value. */
+#define VP_FLAGS_DATE_ONLY 0x10000
+
+#define VP_NAME_SIZE 64
+
+typedef struct vp_vrata {
+    int32_t status;            /* vp_status; nothing else is set unless it's VP_OK */
+    int32_t year;              /* local date of the (first day of) vrata */
+    int32_t month;             /* 1..12 */
+    int32_t day;               /* 1..31 */
+    int32_t type;              /* vp_vrata_type */
+    int32_t masa;              /* 1 (Caitra) .. 12 (Phālguna), 13 adhika, 14 kṣaya, 0 unknown */
+    int32_t paksha;            /* 1 śukla, 2 kṛṣṇa, 0 unknown */
+    int32_t latitude_adjusted; /* nonzero if calculated closer to the equator for lack of sunrises */
+    /* Julian days (UT); paran limits are NaN when there is no limit on that side */
+    double sunrise1;
+    double sunrise2;
+    double paran_start;
+    double paran_end;
+    double latitude;
+    double longitude;
+    char location_name[VP_NAME_SIZE]; /* zero-terminated, truncated if too long */
+    char time_zone[VP_NAME_SIZE];     /* e.g. "Asia/Kolkata" */
+} vp_vrata;
+
+typedef struct vp_context vp_context;
+
+/* Loads time zone data and precalculated databases from data_dir (the directory with
+ * eph/ and tzdata/, usually next to the executables). Must be called before anything else,
+ * may be called again to switch data dirs when no context is in use. */
+VP_API vp_status vp_init(const char * data_dir);
+/* Threads for vp_next_vratas() with "all" locations: 1 (default) calculates them one by one,
+ * 0 means one per CPU core. */
+VP_API vp_status vp_set_threads(uint32_t count);
+/* NULL if out of memory. flags are VP_FLAGS_* ORed together. */
+VP_API vp_context * vp_context_create(uint32_t flags);
+VP_API void vp_context_destroy(vp_context * context);
+
+/* Next vrata on or after the given date for a built-in (or place db) location name. */
+VP_API vp_status vp_next_vrata(vp_context * context, int32_t year, int32_t month, int32_t day,
+                               const char * location_name, vp_vrata * result);
+/* Same for arbitrary coordinates (decimal degrees), time zone is found by them. */
+VP_API vp_status vp_next_vrata_at(vp_context * context, int32_t year, int32_t month, int32_t day,
+                                  double latitude, double longitude, vp_vrata * result);
+/* Next vratas for every built-in location ("all") or for one named location, one result per location
+ * (each with its own status). VP_ERROR_BUFFER_TOO_SMALL if there are more than capacity of them;
+ * *count is the number of results either way. */
+VP_API vp_status vp_next_vratas(vp_context * context, int32_t year, int32_t month, int32_t day,
+                                const char * location_name, vp_vrata * results, size_t capacity, size_t * count);
+/* Human-readable report on the next vrata, same as the command line program prints.
+ * Always zero-terminated when size > 0; VP_ERROR_BUFFER_TOO_SMALL if truncated.
+ * *length (if not NULL) is the full length of the report without the terminating zero. */
+VP_API vp_status vp_report(vp_context * context, int32_t year, int32_t month, int32_t day,
+                           const char * location_name, char * buffer, size_t size, size_t * length);
+
+/* static English description of the status, never NULL */
+VP_API const char * vp_status_message(vp_status status);
+/* static string like "Vaiṣṇavaṁ Pañcāṅgam preview 2021-01-01 rev abcdef" */
+VP_API const char * vp_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VP_C_API_H */
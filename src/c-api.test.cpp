@@ -0,0 +1,117 @@
+#include "catch-formatters.h"
+
+#include "c-api.h"
+#include "text-interface.h"
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+using ContextPtr = std::unique_ptr<vp_context, decltype(&vp_context_destroy)>;
+
+ContextPtr make_context(uint32_t flags = VP_FLAGS_DEFAULT) {
+    REQUIRE(vp_init(".") == VP_OK);
+    ContextPtr context{vp_context_create(flags), &vp_context_destroy};
+    REQUIRE(context);
+    return context;
+}
+}
+
+TEST_CASE("vp_next_vrata() gives the same vrata as calc_one()") {
+    auto context = make_context();
+    vp_vrata vrata;
+    REQUIRE(vp_next_vrata(context.get(), 2021, 2, 9, "Udupi", &vrata) == VP_OK);
+
+    const auto expected = vp::text_ui::calc_one(date::local_days{date::year{2021}/2/9}, vp::udupi_coord);
+    REQUIRE(expected.has_value());
+    const date::year_month_day expected_date{expected->date};
+    REQUIRE(vrata.status == VP_OK);
+    REQUIRE(vrata.year == static_cast<int>(expected_date.year()));
+    REQUIRE(vrata.month == static_cast<int32_t>(static_cast<unsigned>(expected_date.month())));
+    REQUIRE(vrata.day == static_cast<int32_t>(static_cast<unsigned>(expected_date.day())));
+    REQUIRE(vrata.type == static_cast<int32_t>(expected->type));
+    REQUIRE(vrata.masa == static_cast<int32_t>(expected->masa));
+    REQUIRE(vrata.sunrise1 == expected->sunrise1.raw_julian_days_ut().count());
+    REQUIRE(std::string{vrata.location_name} == "Udupi");
+    REQUIRE(std::string{vrata.time_zone} == "Asia/Kolkata");
+
+    vp_vrata at_coords;
+    REQUIRE(vp_next_vrata_at(context.get(), 2021, 2, 9, vp::udupi_coord.latitude.latitude, vp::udupi_coord.longitude.longitude, &at_coords) == VP_OK);
+    REQUIRE(at_coords.year == vrata.year);
+    REQUIRE(at_coords.month == vrata.month);
+    REQUIRE(at_coords.day == vrata.day);
+    REQUIRE(at_coords.type == vrata.type);
+}
+
+TEST_CASE("vp_next_vrata() with VP_FLAGS_DATE_ONLY gives the same date, but no type") {
+    auto full_context = make_context();
+    auto date_only_context = make_context(VP_FLAGS_DATE_ONLY);
+    vp_vrata full;
+    vp_vrata date_only;
+    REQUIRE(vp_next_vrata(full_context.get(), 2021, 2, 9, "Udupi", &full) == VP_OK);
+    REQUIRE(vp_next_vrata(date_only_context.get(), 2021, 2, 9, "Udupi", &date_only) == VP_OK);
+    REQUIRE(date_only.year == full.year);
+    REQUIRE(date_only.month == full.month);
+    REQUIRE(date_only.day == full.day);
+    REQUIRE(date_only.paksha == full.paksha);
+    REQUIRE(date_only.type == VP_VRATA_UNKNOWN);
+    REQUIRE(date_only.masa == 0);
+    REQUIRE(std::isnan(date_only.paran_start));
+}
+
+TEST_CASE("vp_next_vratas() fills caller's buffer and tells if it's too small") {
+    auto context = make_context();
+    std::size_t count = 0;
+    std::array<vp_vrata, 1> one;
+    REQUIRE(vp_next_vratas(context.get(), 2021, 2, 9, "all", one.data(), one.size(), &count) == VP_ERROR_BUFFER_TOO_SMALL);
+    REQUIRE(count == vp::text_ui::LocationDb::size());
+    REQUIRE(one[0].status == VP_OK);
+
+    std::vector<vp_vrata> all(count);
+    REQUIRE(vp_next_vratas(context.get(), 2021, 2, 9, "all", all.data(), all.size(), &count) == VP_OK);
+    REQUIRE(count == all.size());
+    for (const auto & vrata : all) {
+        REQUIRE(vrata.status == VP_OK);
+        REQUIRE(vrata.year == 2021);
+    }
+    REQUIRE(std::string{all[0].location_name} == std::string{one[0].location_name});
+    REQUIRE(all[0].day == one[0].day);
+}
+
+TEST_CASE("vp_report() gives the same text as the command line program") {
+    auto context = make_context();
+    fmt::memory_buffer expected;
+    vp::text_ui::find_calc_and_report_one(date::year{2021}/2/9, "Udupi", fmt::appender{expected});
+    const std::string expected_text{expected.data(), expected.size()};
+
+    std::vector<char> buffer(expected_text.size() + 1);
+    std::size_t length = 0;
+    REQUIRE(vp_report(context.get(), 2021, 2, 9, "Udupi", buffer.data(), buffer.size(), &length) == VP_OK);
+    REQUIRE(length == expected_text.size());
+    REQUIRE(std::string{buffer.data()} == expected_text);
+
+    std::array<char, 10> small;
+    REQUIRE(vp_report(context.get(), 2021, 2, 9, "Udupi", small.data(), small.size(), &length) == VP_ERROR_BUFFER_TOO_SMALL);
+    REQUIRE(length == expected_text.size());
+    REQUIRE(std::string{small.data()} == expected_text.substr(0, small.size() - 1));
+}
+
+TEST_CASE("C API reports errors instead of throwing") {
+    auto context = make_context();
+    vp_vrata vrata;
+    REQUIRE(vp_next_vrata(context.get(), 2021, 2, 9, "No such place", &vrata) == VP_ERROR_UNKNOWN_LOCATION);
+    REQUIRE(vrata.status == VP_ERROR_UNKNOWN_LOCATION);
+    REQUIRE(vp_next_vrata(context.get(), 2021, 2, 30, "Udupi", &vrata) == VP_ERROR_INVALID_ARGUMENT);
+    REQUIRE(vp_next_vrata(nullptr, 2021, 2, 9, "Udupi", &vrata) == VP_ERROR_INVALID_ARGUMENT);
+    REQUIRE(vp_next_vrata(context.get(), 2021, 2, 9, nullptr, &vrata) == VP_ERROR_INVALID_ARGUMENT);
+    REQUIRE(vp_next_vrata_at(context.get(), 2021, 2, 9, 91.0, 0.0, &vrata) == VP_ERROR_INVALID_ARGUMENT);
+    REQUIRE(vp_next_vrata_at(context.get(), 2021, 2, 9, std::nan(""), 0.0, &vrata) == VP_ERROR_INVALID_ARGUMENT);
+    REQUIRE(vp_context_create(1u << 20) == nullptr);
+    REQUIRE(vp_init(nullptr) == VP_ERROR_INVALID_ARGUMENT);
+    REQUIRE(vp_set_threads(1) == VP_OK);
+    REQUIRE(std::string{vp_status_message(VP_ERROR_BUFFER_TOO_SMALL)} == "buffer too small");
+    REQUIRE(std::string{vp_version()} == vp::text_ui::program_name_and_version());
+}
@@ -0,0 +1,103 @@
+#include "calc-variants.h"
+
+#include "boundary-cache.h"
+#include "text-interface.h"
+
+#include <cmath>
+#include <memory>
+
+namespace vp {
+
+namespace {
+bool has(CalcFlags flags, CalcFlags mask, CalcFlags value) {
+    return (flags & mask) == value;
+}
+
+// seconds from one to another, if both are set and differ by a second or more
+std::optional<double> seconds_difference(const std::optional<JulDays_UT> & one, const std::optional<JulDays_UT> & other) {
+    if (!one || !other) return std::nullopt;
+    const double seconds = std::chrono::duration<double>(*other - *one).count();
+    if (std::fabs(seconds) < 1.0) return std::nullopt;
+    return seconds;
+}
+
+void add_differences(const VariantResult & first, const VariantResult & variant, std::vector<std::string> & differences) {
+    const auto prefix = calc_flags_description(variant.flags);
+    const auto & one = first.vrata;
+    const auto & other = variant.vrata;
+    if (!one || !other) {
+        if (one.has_value() != other.has_value()) {
+            differences.push_back(other
+                ? fmt::format(FMT_STRING("{}: got vrata while {} has error: {}"), prefix, calc_flags_description(first.flags), one.error())
+                : fmt::format(FMT_STRING("{}: error: {}"), prefix, other.error()));
+        }
+        return;
+    }
+    if (other->date != one->date) {
+        differences.push_back(fmt::format(FMT_STRING("{}: date {} instead of {}"), prefix, date::year_month_day{other->date}, date::year_month_day{one->date}));
+    }
+    if (other->type != one->type) {
+        differences.push_back(fmt::format(FMT_STRING("{}: {} instead of {}"), prefix, other->type, one->type));
+    }
+    if (other->paran.type != one->paran.type) {
+        differences.push_back(fmt::format(FMT_STRING("{}: {} instead of {}"), prefix, other->paran.type, one->paran.type));
+    }
+    // pāraṇam times only make sense to compare for the same day
+    if (other->date != one->date || other->type != one->type) return;
+    if (const auto seconds = seconds_difference(one->paran.paran_start, other->paran.paran_start)) {
+        differences.push_back(fmt::format(FMT_STRING("{}: pāraṇam starts {:+.0f}s later"), prefix, *seconds));
+    }
+    if (const auto seconds = seconds_difference(one->paran.paran_end, other->paran.paran_end)) {
+        differences.push_back(fmt::format(FMT_STRING("{}: pāraṇam ends {:+.0f}s later"), prefix, *seconds));
+    }
+}
+} // anonymous namespace
+
+VariantsResult calc_variants(date::local_days base_date, const Location & location, const std::vector<CalcFlags> & flags)
+{
+    VariantsResult result;
+    std::shared_ptr<BoundaryCache> caches[] = {
+        std::make_shared<BoundaryCache>(CalcFlags::EphemerisSwiss),
+        std::make_shared<BoundaryCache>(CalcFlags::EphemerisMoshier),
+    };
+    for (const auto variant_flags : flags) {
+        auto & cache = has(variant_flags, CalcFlags::EphemerisMask, CalcFlags::EphemerisMoshier) ? caches[1] : caches[0];
+        result.variants.push_back(VariantResult{variant_flags, text_ui::calc_one(base_date, location, variant_flags, cache)});
+    }
+    for (std::size_t i = 1; i < result.variants.size(); ++i) {
+        add_differences(result.variants.front(), result.variants[i], result.differences);
+    }
+    for (const auto & cache : caches) {
+        result.reused_boundaries += cache->hits();
+    }
+    return result;
+}
+
+std::vector<CalcFlags> all_calc_flags_variants()
+{
+    const CalcFlags all_bits = CalcFlags::SunriseByDiscMask | CalcFlags::RefractionMask | CalcFlags::EphemerisMask
+            | CalcFlags::RiseSetGeocentricMask | CalcFlags::ShravanaDvadashiMask;
+    std::vector<CalcFlags> variants;
+    for (int bits = 0; bits <= static_cast<int>(all_bits); ++bits) {
+        variants.push_back(static_cast<CalcFlags>(bits));
+    }
+    return variants;
+}
+
+std::string calc_flags_description(CalcFlags flags)
+{
+    std::string description;
+    const auto add = [&](const char * what) {
+        if (!description.empty()) description += ", ";
+        description += what;
+    };
+    if (has(flags, CalcFlags::SunriseByDiscMask, CalcFlags::SunriseByDiscEdge)) add("edge");
+    if (has(flags, CalcFlags::RefractionMask, CalcFlags::RefractionOn)) add("refraction");
+    if (has(flags, CalcFlags::EphemerisMask, CalcFlags::EphemerisMoshier)) add("Moshier");
+    if (has(flags, CalcFlags::RiseSetGeocentricMask, CalcFlags::RiseSetGeocentricOn)) add("geocentric");
+    if (has(flags, CalcFlags::ShravanaDvadashiMask, CalcFlags::ShravanaDvadashi14ghPlus)) add("Śravaṇa-dvādaśī 14gh+");
+    if (description.empty()) description = "default";
+    return description;
+}
+
+} // namespace vp
@@ -0,0 +1,44 @@
+#ifndef VP_CALC_VARIANTS_H
+#define VP_CALC_VARIANTS_H
+
+#include "calc-flags.h"
+#include "location.h"
+#include "vrata.h"
+
+#include <string>
+#include <vector>
+
+namespace vp {
+
+struct VariantResult {
+    CalcFlags flags;
+    MaybeVrata vrata;
+};
+
+struct VariantsResult {
+    // in the same order as requested flags
+    std::vector<VariantResult> variants;
+    // One line per difference from the first variant, like
+    // "edge, refraction: date 2021-02-24 instead of 2021-02-23". Empty if all variants agree.
+    std::vector<std::string> differences;
+    // number of tithi/nakṣatra starts reused instead of being calculated again
+    std::size_t reused_boundaries = 0;
+};
+
+/* Calculate next vrata for the location with each of the given flags.
+ * Tithi and nakṣatra boundaries don't depend on sunrise/sunset flags, so they are
+ * only found once per ephemeris (via BoundaryCache) and shared by all variants;
+ * only sunrises/sunsets and things depending on them are calculated for each
+ * variant separately.
+ */
+VariantsResult calc_variants(date::local_days base_date, const Location & location, const std::vector<CalcFlags> & flags);
+
+// All meaningful combinations of CalcFlags, CalcFlags::Default first.
+std::vector<CalcFlags> all_calc_flags_variants();
+
+// Short human-readable description like "edge, refraction, Moshier", "default" for CalcFlags::Default.
+std::string calc_flags_description(CalcFlags flags);
+
+} // namespace vp
+
+#endif // VP_CALC_VARIANTS_H
@@ -0,0 +1,77 @@
+#include "catch-formatters.h"
+
+#include "boundary-cache.h"
+#include "calc-variants.h"
+#include "text-interface.h"
+
+#include <algorithm>
+
+using namespace date;
+
+TEST_CASE("BoundaryCache finds only the same boundary close enough") {
+    vp::BoundaryCache cache{vp::CalcFlags::RefractionOn | vp::CalcFlags::EphemerisMoshier};
+    REQUIRE(cache.ephemeris() == vp::CalcFlags::EphemerisMoshier);
+
+    const vp::JulDays_UT start{vp::double_days{2459250.5}};
+    cache.add(vp::BoundaryCache::Kind::Tithi, 10.0, start);
+    REQUIRE(cache.size() == 1);
+
+    REQUIRE(cache.find(vp::BoundaryCache::Kind::Tithi, 10.0, start + vp::double_days{1.5}) == start);
+    REQUIRE(cache.find(vp::BoundaryCache::Kind::Tithi, 10.0, start - vp::double_days{1.5}) == start);
+    REQUIRE(cache.hits() == 2);
+    // previous/next month's tithi with the same number
+    REQUIRE_FALSE(cache.find(vp::BoundaryCache::Kind::Tithi, 10.0, start + vp::double_days{29.5}).has_value());
+    REQUIRE_FALSE(cache.find(vp::BoundaryCache::Kind::Tithi, 10.0, start - vp::double_days{29.5}).has_value());
+    // different tithi or nakṣatra with the same value
+    REQUIRE_FALSE(cache.find(vp::BoundaryCache::Kind::Tithi, 11.0, start).has_value());
+    REQUIRE_FALSE(cache.find(vp::BoundaryCache::Kind::Nakshatra, 10.0, start).has_value());
+    REQUIRE(cache.hits() == 2);
+}
+
+TEST_CASE("all_calc_flags_variants() gives each combination once, default first") {
+    const auto variants = vp::all_calc_flags_variants();
+    REQUIRE(variants.size() == 32);
+    REQUIRE(variants.front() == vp::CalcFlags::Default);
+    auto sorted = variants;
+    std::sort(sorted.begin(), sorted.end());
+    REQUIRE(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+}
+
+TEST_CASE("calc_flags_description()") {
+    REQUIRE(vp::calc_flags_description(vp::CalcFlags::Default) == "default");
+    REQUIRE(vp::calc_flags_description(vp::CalcFlags::SunriseByDiscEdge | vp::CalcFlags::RefractionOn) == "edge, refraction");
+    REQUIRE(vp::calc_flags_description(vp::CalcFlags::EphemerisMoshier | vp::CalcFlags::ShravanaDvadashi14ghPlus) == "Moshier, Śravaṇa-dvādaśī 14gh+");
+}
+
+TEST_CASE("calc_variants() gives the same vratas as separate calculations") {
+    const auto location = GENERATE(vp::udupi_coord, vp::kiev_coord, vp::murmansk_coord);
+    const auto base_date = local_days{2021_y/February/1};
+    CAPTURE(location.name);
+
+    const auto result = vp::calc_variants(base_date, location, vp::all_calc_flags_variants());
+    REQUIRE(result.variants.size() == 32);
+    // every boundary is found once per ephemeris, the rest are reused
+    REQUIRE(result.reused_boundaries > 0);
+    for (const auto & [flags, vrata] : result.variants) {
+        CAPTURE(vp::calc_flags_description(flags));
+        const auto separate = vp::text_ui::calc_one(base_date, location, flags);
+        REQUIRE(vrata.has_value() == separate.has_value());
+        if (!vrata) continue;
+        REQUIRE(*vrata == *separate);
+        REQUIRE(vrata->paran.paran_start == separate->paran.paran_start);
+        REQUIRE(vrata->paran.paran_end == separate->paran.paran_end);
+
+        // any date change must be reported
+        const auto & first = result.variants.front().vrata;
+        if (first && vrata->date != first->date) {
+            const auto prefix = vp::calc_flags_description(flags) + ": date ";
+            REQUIRE(std::any_of(result.differences.begin(), result.differences.end(), [&](const std::string & d) { return d.rfind(prefix, 0) == 0; }));
+        }
+    }
+}
+
+TEST_CASE("calc_variants() reports no differences for the same flags") {
+    const auto result = vp::calc_variants(local_days{2021_y/February/1}, vp::udupi_coord, {vp::CalcFlags::Default, vp::CalcFlags::Default});
+    REQUIRE(result.variants.size() == 2);
+    REQUIRE(result.differences.empty());
+}
@@ -5,6 +5,7 @@
 #include <optional>
 #include <tl/expected.hpp>
 
+#include "boundary-cache.h"
 #include "calc.h"
 #include "calc-flags.h"
 #include "swe.h"
@@ -29,7 +30,14 @@
 
 namespace vp {
 
-Calc::Calc(Swe swe_):swe(std::move(swe_)) {}
+Calc::Calc(Swe swe_, std::shared_ptr<BoundaryCache> boundary_cache_, CancellationToken cancellation_)
+    :swe(std::move(swe_)), cancellation(std::move(cancellation_))
+{
+    // cache filled with another ephemeris would give (slightly) different results
+    if (boundary_cache_ && boundary_cache_->ephemeris() == (swe.calc_flags & CalcFlags::EphemerisMask)) {
+        boundary_cache = std::move(boundary_cache_);
+    }
+}
 
 /* Main calculation: return next vrata on a given date or after.
  * Determine type of vrata (Ekadashi, or either of two Atiriktas),
@@ -38,8 +46,12 @@ Calc::Calc(Swe swe_):swe(std::move(swe_)) {}
  * Can also return a CalcError when we can't get necessary sunrise/sunset.
  * It happens e.g. mid-summer and mid-winter in ~68+ degrees latitudes,
  * like Murmank on 2020-06-05 (no sunset) or 2017-11-27 (no sunrise).
+ *
+ * Only the parts asked for are calculated. E.g. for vrata date alone there are
+ * no Śravaṇa checks, pāraṇam or amāvāsyā searches for māsa. Dvādaśī and trayodaśī
+ * starts are always found: ativṛddhādi (and so the dashamī check and the date) depends on them.
  */
-tl::expected<Vrata, CalcError> Calc::find_next_vrata(date::local_days after) const
+tl::expected<Vrata, CalcError> Calc::find_next_vrata(date::local_days after, VrataParts parts) const
 {
     auto midnight = calc_astronomical_midnight(after);
     auto start_time = midnight - double_days{3.0};
@@ -72,18 +84,25 @@ repeat_with_fixed_start_time:
     }
 
     vrata.location = swe.location;
+    vrata.paksha = tithi_that_must_not_be_dashamI.get_paksha();
 
-    VP_TRY(vrata.sunset2, swe.find_sunset(vrata.sunrise2))
-    VP_TRY(vrata.sunrise3, next_sunrise(vrata.sunrise2))
-    VP_TRY(vrata.sunset3, swe.find_sunset(vrata.sunrise3))
+    if (wants(parts, VrataParts::Type)) {
+        VP_TRY(vrata.sunset2, swe.find_sunset(vrata.sunrise2))
+        VP_TRY(vrata.sunrise3, next_sunrise(vrata.sunrise2))
+        vrata.type = calc_vrata_type(vrata);
+    }
 
-    vrata.type = calc_vrata_type(vrata);
-    vrata.paran = is_atirikta(vrata.type) ?
-        atirikta_paran(vrata.sunrise3, vrata.sunset3, vrata.times.trayodashi_start)
-    :
-        get_paran(vrata.sunrise2, vrata.sunset2, vrata.times.dvadashi_start, vrata.times.trayodashi_start);
-    vrata.masa = chandra_masa_amanta(vrata.sunrise1);
-    vrata.paksha = tithi_that_must_not_be_dashamI.get_paksha();
+    if (wants(parts, VrataParts::Paran)) {
+        VP_TRY(vrata.sunset3, swe.find_sunset(vrata.sunrise3))
+        vrata.paran = is_atirikta(vrata.type) ?
+            atirikta_paran(vrata.sunrise3, vrata.sunset3, vrata.times.trayodashi_start)
+        :
+            get_paran(vrata.sunrise2, vrata.sunset2, vrata.times.dvadashi_start, vrata.times.trayodashi_start);
+    }
+
+    if (wants(parts, VrataParts::Masa)) {
+        vrata.masa = chandra_masa_amanta(vrata.sunrise1);
+    }
 
     return vrata;
 }
@@ -157,19 +176,20 @@ date::local_days Calc::get_vrata_date(const JulDays_UT sunrise) const
 
 Vrata_Type Calc::calc_vrata_type(const Vrata &vrata) const
 {
-    if (got_shravana_nakshatra_next_day(vrata)) {
+    const SunriseSkies skies{swe.evaluate(vrata.sunrise1), swe.evaluate(vrata.sunrise2), swe.evaluate(vrata.sunrise3)};
+    if (got_shravana_nakshatra_next_day(vrata, skies)) {
         return Vrata_Type::With_Shravana_Dvadashi_Next_Day;
     }
 
-    if (got_shravana_nakshatra_same_day(vrata)) {
+    if (got_shravana_nakshatra_same_day(vrata, skies)) {
         return Vrata_Type::With_Shravana_Dvadashi_Same_Day;
     }
 
-    if (got_atirikta_ekadashi(vrata)) {
+    if (got_atirikta_ekadashi(skies)) {
         return Vrata_Type::With_Atirikta_Ekadashi;
     }
 
-    if (got_atirikta_dvadashi(vrata)) {
+    if (got_atirikta_dvadashi(skies)) {
         return Vrata_Type::With_Atirikta_Dvadashi;
     }
 
@@ -177,14 +197,14 @@ Vrata_Type Calc::calc_vrata_type(const Vrata &vrata) const
 }
 
 namespace {
-bool got_shravana_for_sunrise_sunset(JulDays_UT sunrise, JulDays_UT sunset, JulDays_UT next_sunrise, const vp::Swe & swe) {
+// on_sunrise and on_next_sunrise are swe.evaluate() at sunrise and the next one
+bool got_shravana_for_sunrise_sunset(JulDays_UT sunrise, const SkyState & on_sunrise, JulDays_UT sunset, const SkyState & on_next_sunrise,
+                                     const vp::Swe & swe) {
     using ghatikas = std::chrono::duration<double, std::ratio_multiply<std::chrono::minutes::period, std::ratio<24>>>;
     using namespace std::chrono_literals;
 
-    DiscreteNakshatra nakshatra_on_sunrise = swe.get_nakshatra(sunrise);
-    if (nakshatra_on_sunrise != DiscreteNakshatra::Shravana()) { return false; }
-    Tithi tithi_on_sunrise = swe.get_tithi(sunrise);
-    if (!tithi_on_sunrise.is_dvadashi()) { return false; }
+    if (DiscreteNakshatra{on_sunrise.nakshatra} != DiscreteNakshatra::Shravana()) { return false; }
+    if (!on_sunrise.tithi.is_dvadashi()) { return false; }
 
     // limit until which both Dvādaśī and Śravaṇa must hold. 12 or 14 ghaṭikas
     // from sunrise, depending on which Kṛṣṇāmṛta-mahārṇava commentaries we rely upon.
@@ -196,55 +216,49 @@ bool got_shravana_for_sunrise_sunset(JulDays_UT sunrise, JulDays_UT sunset, JulD
     const bool require_14gh = ((swe.calc_flags & CalcFlags::ShravanaDvadashiMask) == CalcFlags::ShravanaDvadashi14ghPlus);
     const auto madhyahna_limit_ratio_from_daytime = require_14gh ? ratio_for_14gh : ratio_for_12gh;
     const auto madhyahna_limit = Calc::proportional_time(sunrise, sunset, madhyahna_limit_ratio_from_daytime);
-    DiscreteNakshatra nakshantra_at_limit = swe.get_nakshatra(madhyahna_limit);
-    if (nakshantra_at_limit != DiscreteNakshatra::Shravana()) { return false; }
-    Tithi tithi_at_limit = swe.get_tithi(madhyahna_limit);
-    if (!tithi_at_limit.is_dvadashi()) { return false; }
+    auto at_limit = swe.evaluate(madhyahna_limit);
+    if (DiscreteNakshatra{at_limit.nakshatra} != DiscreteNakshatra::Shravana()) { return false; }
+    if (!at_limit.tithi.is_dvadashi()) { return false; }
 
     // If Śravaṇa nakṣatra extends till another sunrise, then Śravaṇa dvādaśī condition is not fulfilled.
     // Since nakshatras cannot reach 72 ghatikas (60 for full ekādaśī day + 12 to reach madhyahnam on dvādaśī),
     // we don't have to check the previous sunrise (aka "sunrise1") for Śravaṇa.
     // So we only need to check for next sunrise.
-    const DiscreteNakshatra nakshatra_at_next_sunrise = swe.get_nakshatra(next_sunrise);
-    if (nakshatra_at_next_sunrise == DiscreteNakshatra::Shravana()) {
+    if (DiscreteNakshatra{on_next_sunrise.nakshatra} == DiscreteNakshatra::Shravana()) {
         return false;
     }
     return true;
 }
 }
 
-bool Calc::got_shravana_nakshatra_next_day(const Vrata &vrata) const
+bool Calc::got_shravana_nakshatra_next_day(const Vrata &vrata, const SunriseSkies & skies) const
 {
-    return got_shravana_for_sunrise_sunset(vrata.sunrise2, vrata.sunset2, vrata.sunrise3, swe);
+    return got_shravana_for_sunrise_sunset(vrata.sunrise2, skies.sunrise2, vrata.sunset2, skies.sunrise3, swe);
 }
 
-bool Calc::got_shravana_nakshatra_same_day(const Vrata &vrata) const
+bool Calc::got_shravana_nakshatra_same_day(const Vrata &vrata, const SunriseSkies & skies) const
 {
     auto sunset1 = swe.find_sunset(vrata.sunrise1);
     if (!sunset1) return false;
-    return got_shravana_for_sunrise_sunset(vrata.sunrise1, *sunset1, vrata.sunrise2, swe);
+    return got_shravana_for_sunrise_sunset(vrata.sunrise1, skies.sunrise1, *sunset1, skies.sunrise2, swe);
 }
 
 /* Find out if we have "atiriktA ekAdashI" situation (shuddha ekAdashI encompasses two sunrises).
  * This function assumes that if first sunrise is ekAdashI, then it's shuddhA-ekAdashI.
  * Otherwise the sunrise under consideration would have been "next sunrise" already.
  */
-bool Calc::got_atirikta_ekadashi(const Vrata & vrata) const
+bool Calc::got_atirikta_ekadashi(const SunriseSkies & skies) const
 {
-    Tithi tithi_on_first_sunrise = swe.get_tithi(vrata.sunrise1);
-    Tithi tithi_on_second_sunrise = swe.get_tithi(vrata.sunrise2);
-    return tithi_on_first_sunrise.is_ekadashi() && tithi_on_second_sunrise.is_ekadashi();
+    return skies.sunrise1.tithi.is_ekadashi() && skies.sunrise2.tithi.is_ekadashi();
 }
 
 /* Find out if we have "atiriktA dvAdashI" situation (dvadashI encompasses two sunrises).
  * If yes, then adjust the sunrise to be next day's sunrise
  * (because it has to be the sunrise of last fastiung day).
  */
-bool Calc::got_atirikta_dvadashi(const Vrata & vrata) const
+bool Calc::got_atirikta_dvadashi(const SunriseSkies & skies) const
 {
-    Tithi tithi_on_second_sunrise = swe.get_tithi(vrata.sunrise2);
-    Tithi tithi_on_third_sunrise = swe.get_tithi(vrata.sunrise3);
-    return tithi_on_second_sunrise.is_dvadashi() && tithi_on_third_sunrise.is_dvadashi();
+    return skies.sunrise2.tithi.is_dvadashi() && skies.sunrise3.tithi.is_dvadashi();
 }
 
 JulDays_UT Calc::proportional_time(JulDays_UT const t1, JulDays_UT const t2, double const proportion) {
@@ -295,13 +309,21 @@ Paran Calc::atirikta_paran(const JulDays_UT sunrise3, const JulDays_UT sunset3,
 tl::expected<JulDays_UT, CalcError> Calc::arunodaya_for_sunrise(JulDays_UT const sunrise) const
 {
     VP_TRY_AUTO(prev_sunset, sunset_before_sunrise(sunrise))
+    return arunodaya_for_sunrise(sunrise, *prev_sunset);
+}
+
+JulDays_UT Calc::arunodaya_for_sunrise(JulDays_UT const sunrise, JulDays_UT const sunset_before) const
+{
     constexpr double muhurtas_per_night = (12*60) / 48.0;
     constexpr double proportion_arunodaya = 2 / muhurtas_per_night; // 2/15 = 1/7.5
-    return proportional_time(sunrise, *prev_sunset, proportion_arunodaya);
+    return proportional_time(sunrise, sunset_before, proportion_arunodaya);
 }
 
 namespace {
-template<class Value, class ValueGetter, class PosDeltaCalculator, class MinDeltaCalculator, class ExceptionThrower, class InitialTargetFixer>
+// cache_lookup(target, initial_estimate) can return already known answer (or nullopt),
+// cache_store(target, answer) is called for every answer found by iterations.
+// Throws Cancelled on any iteration once cancellation is cancelled.
+template<class Value, class ValueGetter, class PosDeltaCalculator, class MinDeltaCalculator, class ExceptionThrower, class InitialTargetFixer, class CacheLookup, class CacheStore>
 JulDays_UT find_time_with_given_value(
     const JulDays_UT from,
     Value target_value,
@@ -310,8 +332,12 @@ JulDays_UT find_time_with_given_value(
     PosDeltaCalculator pos_delta_calc,
     MinDeltaCalculator min_delta_calc,
     ExceptionThrower exception_thrower,
-    InitialTargetFixer initial_target_fixer)
+    InitialTargetFixer initial_target_fixer,
+    CacheLookup cache_lookup,
+    CacheStore cache_store,
+    const CancellationToken & cancellation)
 {
+    cancellation.throw_if_cancelled();
     Value cur_value = getter(from);
 
     double initial_delta = pos_delta_calc(cur_value, target_value);
@@ -319,6 +345,9 @@ JulDays_UT find_time_with_given_value(
     initial_target_fixer(target_value, initial_delta);
 
     JulDays_UT time{from + initial_delta * average_length};
+    if (const std::optional<JulDays_UT> cached = cache_lookup(target_value, time)) {
+        return *cached;
+    }
     cur_value = getter(time);
 
     double prev_abs_delta = std::numeric_limits<double>::max();
@@ -327,6 +356,7 @@ JulDays_UT find_time_with_given_value(
     int iteration = 0;
 
     while (cur_value != target_value) {
+        cancellation.throw_if_cancelled();
         double const delta = min_delta_calc(cur_value, target_value);
         time += delta * average_length;
         cur_value = getter(time);
@@ -341,11 +371,23 @@ JulDays_UT find_time_with_given_value(
             exception_thrower(target_value, from);
         }
     }
+    cache_store(target_value, time);
     return time;
 }
 
 }
 
+std::optional<JulDays_UT> Calc::cached_boundary(BoundaryCache::Kind kind, double value, JulDays_UT near) const
+{
+    if (!boundary_cache) return std::nullopt;
+    return boundary_cache->find(kind, value, near);
+}
+
+void Calc::cache_boundary(BoundaryCache::Kind kind, double value, JulDays_UT start) const
+{
+    if (boundary_cache) boundary_cache->add(kind, value, start);
+}
+
 JulDays_UT Calc::find_exact_tithi_start(JulDays_UT from, Tithi tithi) const {
     return find_time_with_given_value(
         from,
@@ -355,7 +397,10 @@ JulDays_UT Calc::find_exact_tithi_start(JulDays_UT from, Tithi tithi) const {
         [](Tithi t1, Tithi t2) { return t1.positive_delta_until_tithi(t2); },
         [](Tithi t1, Tithi t2) { return t1.delta_to_nearest_tithi(t2); },
         [](Tithi target, JulDays_UT from) { throw CantFindTithiAfter{target, from}; },
-        [](Tithi & /*target*/, double & /*delta*/) {} );
+        [](Tithi & /*target*/, double & /*delta*/) {},
+        [this](Tithi target, JulDays_UT near) { return cached_boundary(BoundaryCache::Kind::Tithi, target.tithi, near); },
+        [this](Tithi target, JulDays_UT start) { cache_boundary(BoundaryCache::Kind::Tithi, target.tithi, start); },
+        cancellation);
 }
 
 tl::expected<date::local_days, CalcError> Calc::find_exact_tithi_date(const JulDays_UT from, const DiscreteTithi tithi, const date::time_zone * tz) const
@@ -384,7 +429,10 @@ JulDays_UT Calc::find_either_tithi_start(JulDays_UT from, Tithi tithi) const
                 target += 15.0;
                 delta -= 15.0;
             }
-        }
+        },
+        [this](Tithi target, JulDays_UT near) { return cached_boundary(BoundaryCache::Kind::Tithi, target.tithi, near); },
+        [this](Tithi target, JulDays_UT start) { cache_boundary(BoundaryCache::Kind::Tithi, target.tithi, start); },
+        cancellation
         );
 }
 
@@ -398,7 +446,10 @@ JulDays_UT Calc::find_nakshatra_start(const JulDays_UT from, const Nakshatra tar
         positive_delta_between_nakshatras,
         minimal_delta_between_nakshatras,
         [](Nakshatra target, JulDays_UT from) { throw CantFindNakshatraAfter{target, from}; },
-        [](Nakshatra & /*target*/, double & /*delta*/) {}
+        [](Nakshatra & /*target*/, double & /*delta*/) {},
+        [this](Nakshatra target, JulDays_UT near) { return cached_boundary(BoundaryCache::Kind::Nakshatra, target.nakshatra, near); },
+        [this](Nakshatra target, JulDays_UT start) { cache_boundary(BoundaryCache::Kind::Nakshatra, target.nakshatra, start); },
+        cancellation
     );
 }
 
@@ -414,7 +465,10 @@ JulDays_UT Calc::find_sankranti(JulDays_UT after, Saura_Masa masa) const
         positive_delta_between_longitudes,
         minimal_delta_between_longitudes,
         [&](Nirayana_Longitude target, JulDays_UT from) { throw CantFindSankrantiAfter{masa, target, from}; },
-        [](Nirayana_Longitude & /*target*/, double & /*delta*/) {}
+        [](Nirayana_Longitude & /*target*/, double & /*delta*/) {},
+        [](Nirayana_Longitude /*target*/, JulDays_UT /*near*/) { return std::optional<JulDays_UT>{}; },
+        [](Nirayana_Longitude /*target*/, JulDays_UT /*start*/) {},
+        cancellation
         );
 }
 
@@ -1,6 +1,8 @@
 #ifndef CALC_H
 #define CALC_H
 
+#include "boundary-cache.h"
+#include "cancellation.h"
 #include "location.h"
 #include "date-fixed.h"
 #include "masa.h"
@@ -9,7 +11,9 @@
 #include "juldays_ut.h"
 #include "tithi.h"
 #include "vrata.h"
+#include "vrata-parts.h"
 
+#include <memory>
 #include <tl/expected.hpp>
 
 namespace vp {
@@ -36,9 +40,13 @@ struct CantFindSankrantiAfter {
 class Calc
 {
 public:
-    Calc(Swe swe);
+    // boundary_cache (if any) is shared with other Calc instances to avoid finding
+    // the same tithi/nakṣatra starts again. It's ignored if made for another ephemeris.
+    // Once cancellation is cancelled, searches for tithi/nakṣatra starts and saṅkrāntis
+    // throw Cancelled.
+    Calc(Swe swe, std::shared_ptr<BoundaryCache> boundary_cache = nullptr, CancellationToken cancellation = {});
     // main interface: get info for nearest future Vrata after given date
-    tl::expected<Vrata, CalcError> find_next_vrata(date::local_days after) const;
+    tl::expected<Vrata, CalcError> find_next_vrata(date::local_days after, VrataParts parts = VrataParts::All) const;
 
     // Helper functions. They are public for easier testing,
     // but should be considered private otherwise.
@@ -48,6 +56,9 @@ public:
 
     // get arunodaya(= sunrise - night_length/8) for given sunrise
     tl::expected<JulDays_UT, CalcError> arunodaya_for_sunrise(JulDays_UT sunrise) const;
+    // same, when the sunset before that sunrise is already known
+    JulDays_UT arunodaya_for_sunrise(JulDays_UT sunrise, JulDays_UT sunset_before) const;
+    tl::expected<JulDays_UT, CalcError> sunset_before_sunrise(JulDays_UT const sunrise) const;
 
     // find Shukla- or Krishna- tithi - whichever is closest. Expects Tithi argument to be < 15.0 (shukla paksha)
     JulDays_UT find_either_tithi_start(JulDays_UT, Tithi) const;
@@ -65,18 +76,28 @@ public:
     vp::Swe swe;
 
 private:
+    std::shared_ptr<BoundaryCache> boundary_cache;
+    CancellationToken cancellation;
+    std::optional<JulDays_UT> cached_boundary(BoundaryCache::Kind kind, double value, JulDays_UT near) const;
+    void cache_boundary(BoundaryCache::Kind kind, double value, JulDays_UT start) const;
+
     Vrata_Time_Points calc_key_times_from_sunset_and_sunrise(JulDays_UT sunset0, JulDays_UT sunrise1) const;
-    tl::expected<JulDays_UT, CalcError> sunset_before_sunrise(JulDays_UT const sunrise) const;
     date::local_days get_vrata_date(const JulDays_UT sunrise) const;
     Paran get_paran(const JulDays_UT sunrise2, const JulDays_UT sunset2, const JulDays_UT dvadashi_start, const JulDays_UT dvadashi_end) const;
     Paran atirikta_paran(const JulDays_UT sunrise3, const JulDays_UT sunset3, const JulDays_UT dvadashi_end) const;
 
     tl::expected<JulDays_UT, CalcError> next_sunrise(JulDays_UT sunrise) const;
     JulDays_UT next_sunrise_v(JulDays_UT sunrise) const;
-    bool got_shravana_nakshatra_next_day(const Vrata & vrata) const;
-    bool got_shravana_nakshatra_same_day(const Vrata & vrata) const;
-    bool got_atirikta_ekadashi(const Vrata & vrata) const;
-    bool got_atirikta_dvadashi(const Vrata & vrata) const;
+    // swe.evaluate() at vrata sunrises, shared by all vrata type checks
+    struct SunriseSkies {
+        SkyState sunrise1;
+        SkyState sunrise2;
+        SkyState sunrise3;
+    };
+    bool got_shravana_nakshatra_next_day(const Vrata & vrata, const SunriseSkies & skies) const;
+    bool got_shravana_nakshatra_same_day(const Vrata & vrata, const SunriseSkies & skies) const;
+    bool got_atirikta_ekadashi(const SunriseSkies & skies) const;
+    bool got_atirikta_dvadashi(const SunriseSkies & skies) const;
     Vrata_Type calc_vrata_type(const Vrata & vrata) const;
 };
 
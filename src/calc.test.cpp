@@ -832,3 +832,56 @@ TEST_CASE("shravana dvadashi") {
         REQUIRE(v_14gh_rule == vrata(Calc{Swe{kiev_coord, CalcFlags::ShravanaDvadashi14ghPlus}}, date));
     }
 }
+
+TEST_CASE("find_next_vrata() calculates only requested parts, the same way as full calculation") {
+    // Tekeli: Śravaṇa-dvādaśī same day, Fredericton: next day (so pāraṇam is on the third day)
+    const auto [location, base_date] = GENERATE(
+        std::make_pair(tekeli_coord, date::local_days{2020_y/3/20}),
+        std::make_pair(fredericton_coord, date::local_days{2019_y/9/9}),
+        std::make_pair(kiev_coord, date::local_days{2021_y/1/20}));
+    CAPTURE(location.name, base_date);
+    const Calc calc{location};
+    const auto full = calc.find_next_vrata(base_date);
+    REQUIRE(full.has_value());
+
+    const auto date_only = calc.find_next_vrata(base_date, VrataParts::DateOnly);
+    REQUIRE(date_only.has_value());
+    REQUIRE(date_only->date == full->date);
+    REQUIRE(date_only->paksha == full->paksha);
+    REQUIRE(date_only->sunrise1 == full->sunrise1);
+    REQUIRE(date_only->masa == Chandra_Masa::Unknown);
+    REQUIRE_FALSE(date_only->paran.paran_start.has_value());
+
+    const auto with_type = calc.find_next_vrata(base_date, VrataParts::Type);
+    REQUIRE(with_type.has_value());
+    REQUIRE(with_type->type == full->type);
+    REQUIRE(with_type->masa == Chandra_Masa::Unknown);
+
+    const auto with_paran_and_masa = calc.find_next_vrata(base_date, VrataParts::Paran | VrataParts::Masa);
+    REQUIRE(with_paran_and_masa.has_value());
+    REQUIRE(*with_paran_and_masa == *full);
+    REQUIRE(with_paran_and_masa->paran.paran_start == full->paran.paran_start);
+    REQUIRE(with_paran_and_masa->paran.paran_end == full->paran.paran_end);
+}
+
+TEST_CASE("find_next_vrata() for date only checks the same ativRddhAdi time point as full calculation") {
+    // Kiev: hrasva and vRddha; Petropavlovsk-Kamchatskiy: 55gh_55vigh (hrasva) is still dashamI, so vrata moves to the next day
+    const auto [location, base_date] = GENERATE(
+        std::make_pair(kiev_coord, date::local_days{2020_y/May/25}),
+        std::make_pair(kiev_coord, date::local_days{2020_y/August/25}),
+        std::make_pair(petropavlovskkamchatskiy_coord, date::local_days{2019_y/March/15}));
+    CAPTURE(location.name, base_date);
+    const Calc calc{location};
+    const auto full = calc.find_next_vrata(base_date);
+    REQUIRE(full.has_value());
+    REQUIRE(full->times.ativrddhaadi() != Vrata_Time_Points::Ativrddhaadi::samyam);
+
+    for (const auto parts : {VrataParts::DateOnly, VrataParts::Type}) {
+        const auto partial = calc.find_next_vrata(base_date, parts);
+        REQUIRE(partial.has_value());
+        REQUIRE(partial->times.ativrddhaadi() == full->times.ativrddhaadi());
+        REQUIRE(partial->times.ativrddhaditvam_timepoint() == full->times.ativrddhaditvam_timepoint());
+        REQUIRE(partial->date == full->date);
+        REQUIRE(partial->paksha == full->paksha);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef VP_CANCELLATION_H
+#define VP_CANCELLATION_H
+
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace vp {
+
+// thrown from calculations when their CancellationToken was cancelled
+struct Cancelled : std::exception {
+    const char * what() const noexcept override { return "calculation cancelled"; }
+};
+
+/* Cooperative cancellation: whoever runs a long calculation passes the token to it,
+ * whoever wants it abandoned calls cancel() on a copy (possibly from another thread).
+ * Calculations check it every step of their searches and throw Cancelled.
+ *
+ * All copies share the same flag. Default-constructed token can't be cancelled,
+ * and checking it costs nothing.
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+    static CancellationToken make() {
+        CancellationToken token;
+        token.flag_ = std::make_shared<std::atomic<bool>>(false);
+        return token;
+    }
+
+    bool can_be_cancelled() const { return flag_ != nullptr; }
+    void cancel() const {
+        if (flag_) flag_->store(true, std::memory_order_relaxed);
+    }
+    bool cancelled() const {
+        return flag_ && flag_->load(std::memory_order_relaxed);
+    }
+    void throw_if_cancelled() const {
+        if (cancelled()) throw Cancelled{};
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+} // namespace vp
+
+#endif // VP_CANCELLATION_H
@@ -0,0 +1,189 @@
+#include "compact-table.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vp {
+
+String_Pool::String_Pool(std::pmr::memory_resource * resource) : strings_(resource), ids_(resource)
+{
+    intern({});
+}
+
+String_Pool::Id String_Pool::intern(std::string_view s)
+{
+    if (auto found = ids_.find(s); found != ids_.end()) {
+        return found->second;
+    }
+    const auto id = static_cast<Id>(strings_.size());
+    const auto & stored = strings_.emplace_back(s);
+    ids_.emplace(stored, id);
+    return id;
+}
+
+String_Pool::Id String_Pool::join_with_space(Id first, std::string_view second)
+{
+    if (second.empty()) return first;
+    if (first == Empty) return intern(second);
+    std::pmr::string joined{get(first), strings_.get_allocator()};
+    joined += ' ';
+    joined += second;
+    return intern(joined);
+}
+
+Compact_Table::Cell_Ref & Compact_Table::Cell_Ref::set_title(std::string_view title)
+{
+    table_.cells_[index_].title = table_.pool_.intern(title);
+    return *this;
+}
+
+Compact_Table::Compact_Table(std::pmr::memory_resource * resource) : pool_(resource), rows_(resource), cells_(resource)
+{}
+
+std::size_t Compact_Table::width() const
+{
+    std::size_t max_length = 0;
+    for (std::size_t row = 0; row < height(); ++row) {
+        max_length = std::max(max_length, row_length(row));
+    }
+    return max_length;
+}
+
+std::size_t Compact_Table::row_length(std::size_t row) const
+{
+    const auto next_row_start = (row + 1 < rows_.size()) ? rows_[row + 1].first_cell : cells_.size();
+    return next_row_start - rows_[row].first_cell;
+}
+
+bool Compact_Table::has_cell(std::size_t row, std::size_t col) const
+{
+    if (row >= height()) return false;
+    return col < row_length(row);
+}
+
+const Compact_Table::Cell & Compact_Table::at(std::size_t row, std::size_t col) const
+{
+    if (!has_cell(row, col)) {
+        throw std::out_of_range("Compact_Table::at(): no such cell");
+    }
+    return cells_[rows_[row].first_cell + col];
+}
+
+Compact_Table::Cell & Compact_Table::cell_at(std::size_t row, std::size_t col)
+{
+    return cells_[rows_[row].first_cell + col];
+}
+
+void Compact_Table::start_new_row(std::string_view classes)
+{
+    rows_.push_back(Row{cells_.size(), pool_.intern(classes)});
+}
+
+Compact_Table::Cell_Ref Compact_Table::do_add_cell(std::string_view text, std::string_view classes, CellType type, Mergeable mergeable)
+{
+    if (rows_.empty()) { start_new_row(); }
+    Cell cell;
+    cell.text = pool_.intern(text);
+    cell.classes = pool_.intern(classes);
+    cell.col = static_cast<std::uint32_t>(row_length(height() - 1));
+    cell.type = type;
+    cell.mergeable = mergeable;
+    cells_.push_back(cell);
+    return Cell_Ref{*this, cells_.size() - 1};
+}
+
+Compact_Table::Cell_Ref Compact_Table::add_cell(std::string_view text, std::string_view classes)
+{
+    return do_add_cell(text, classes, CellType::Normal, Mergeable::Yes);
+}
+
+Compact_Table::Cell_Ref Compact_Table::add_unmergeable_cell(std::string_view text, std::string_view classes)
+{
+    return do_add_cell(text, classes, CellType::Normal, Mergeable::No);
+}
+
+Compact_Table::Cell_Ref Compact_Table::add_header_cell(std::string_view text, std::string_view classes)
+{
+    return do_add_cell(text, classes, CellType::Header, Mergeable::Yes);
+}
+
+bool Compact_Table::mergeable_cells(const Cell & c1, const Cell & c2)
+{
+    if (c1.mergeable == Mergeable::No || c2.mergeable == Mergeable::No) return false;
+    if (c1.type != c2.type) return false;
+    return c1.text == c2.text;
+}
+
+// Same splitting of long spans into even sections of at most 12 rows as in vp::Table::add_row_span()
+void Compact_Table::add_row_span(std::size_t row, std::size_t col, std::size_t overall_span_size)
+{
+    constexpr std::size_t max_span_size = 12;
+    if (overall_span_size < max_span_size) {
+        cell_at(row, col).rowspan = static_cast<std::uint16_t>(overall_span_size);
+        return;
+    }
+    std::size_t num_sections = (overall_span_size + max_span_size - 1) / max_span_size; // rounding up
+    std::size_t section_size = (overall_span_size + num_sections - 1) / num_sections; // rounding up
+    std::size_t first_row_after_span = row + overall_span_size;
+    for (std::size_t section_row = row; section_row < first_row_after_span; section_row += section_size) {
+        auto & curr_cell = cell_at(section_row, col);
+        curr_cell.rowspan = static_cast<std::uint16_t>(std::min(section_size, first_row_after_span - section_row));
+
+        // merge-to-top all cell runs except the first one
+        if (section_row != row) {
+            curr_cell.classes = pool_.join_with_space(curr_cell.classes, "merge-to-top");
+        }
+        // merge-to-bottom all cell runs except the last one
+        if (section_row + section_size < first_row_after_span) {
+            curr_cell.classes = pool_.join_with_space(curr_cell.classes, "merge-to-bottom");
+        }
+    }
+}
+
+void Compact_Table::merge_cells()
+{
+    // length of the run of identical cells below the current one, for each column
+    std::vector<std::size_t> rowspan_run(width(), 1);
+    for (std::size_t row = height(); row-- > 0;) {
+        std::size_t colspan_run = 1;
+        for (std::size_t col = row_length(row); col-- > 0;) {
+            auto & cell = cell_at(row, col);
+
+            if (col > 0 && mergeable_cells(cell, cell_at(row, col - 1))) {
+                ++colspan_run;
+                cell.colspan = 0;
+            } else {
+                cell.colspan = static_cast<std::uint16_t>(colspan_run);
+                colspan_run = 1;
+            }
+
+            if (row > 0 && has_cell(row - 1, col) && mergeable_cells(cell, cell_at(row - 1, col))) {
+                ++rowspan_run[col];
+                cell.rowspan = 0;
+            } else {
+                add_row_span(row, col, rowspan_run[col]);
+                rowspan_run[col] = 1;
+            }
+        }
+    }
+}
+
+void Compact_Table::add_even_odd_classes_for_col(std::size_t col, StartFrom start_from)
+{
+    bool odd = (start_from == StartFrom::Odd);
+    const Cell * prev_cell{};
+    for (std::size_t row = 0; row < height(); ++row) {
+        if (!has_cell(row, col)) { continue; }
+        auto & cell = cell_at(row, col);
+        // do not switch between odd/even for multiple runs of rowspanning cell with the same text
+        if (prev_cell && prev_cell->text != cell.text) {
+            odd = !odd;
+        }
+        if (cell.rowspan >= 1) {
+            cell.classes = pool_.join_with_space(cell.classes, odd ? "odd" : "even");
+        }
+        prev_cell = &cell;
+    }
+}
+
+} // namespace vp
@@ -0,0 +1,128 @@
+#ifndef VP_COMPACT_TABLE_H
+#define VP_COMPACT_TABLE_H
+
+#include "table.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vp {
+
+// Stores every distinct string exactly once and hands out small integer ids for them.
+// Equal strings always get equal ids, so comparing ids is the same as comparing text.
+class String_Pool
+{
+public:
+    using Id = std::uint32_t;
+    // id of the empty string, always present in the pool
+    static constexpr Id Empty = 0;
+
+    explicit String_Pool(std::pmr::memory_resource * resource = std::pmr::get_default_resource());
+    Id intern(std::string_view s);
+    std::string_view get(Id id) const { return strings_[id]; }
+    // id of "<first> <second>" (or of just one of them if the other one is empty)
+    Id join_with_space(Id first, std::string_view second);
+    std::size_t size() const { return strings_.size(); }
+
+private:
+    // deque never moves its elements, so string_view keys in ids_ stay valid
+    std::pmr::deque<std::pmr::string> strings_;
+    std::pmr::unordered_map<std::string_view, Id> ids_;
+};
+
+// Same data as vp::Table, but cells keep only ids of interned strings and
+// are stored in one flat vector instead of a vector per row.
+// Use it when the table is only generated to be written out right away (see write_html_table()).
+// All strings and cells are allocated from the memory resource given on construction.
+class Compact_Table
+{
+public:
+    using CellType = Table::CellType;
+    using Mergeable = Table::Mergeable;
+    using StartFrom = Table::StartFrom;
+    using Id = String_Pool::Id;
+
+    struct Cell {
+        Id text = String_Pool::Empty;
+        Id classes = String_Pool::Empty;
+        Id title = String_Pool::Empty;
+        std::uint32_t col = 0;
+        // 0 means "merged into another cell", just like in vp::Table
+        std::uint16_t rowspan = 1;
+        std::uint16_t colspan = 1;
+        CellType type = CellType::Normal;
+        Mergeable mergeable = Mergeable::Yes;
+    };
+
+    // Returned by add_*cell() to allow for vp::Table-like table.add_cell(...).set_title(...) calls.
+    class Cell_Ref {
+    public:
+        Cell_Ref(Compact_Table & table, std::size_t index) : table_(table), index_(index) {}
+        Cell_Ref & set_title(std::string_view title);
+    private:
+        Compact_Table & table_;
+        std::size_t index_;
+    };
+
+    struct Row {
+        std::size_t first_cell;
+        Id classes;
+    };
+
+    explicit Compact_Table(std::pmr::memory_resource * resource = std::pmr::get_default_resource());
+
+    std::size_t width() const;
+    std::size_t height() const { return rows_.size(); }
+    std::size_t row_length(std::size_t row) const;
+    bool has_cell(std::size_t row, std::size_t col) const;
+    const Cell & at(std::size_t row, std::size_t col) const;
+    const Row & row(std::size_t row_num) const { return rows_.at(row_num); }
+    std::string_view text(Id id) const { return pool_.get(id); }
+
+    void start_new_row(std::string_view classes = {});
+    Cell_Ref add_cell(std::string_view text, std::string_view classes = {});
+    Cell_Ref add_unmergeable_cell(std::string_view text, std::string_view classes = {});
+    Cell_Ref add_header_cell(std::string_view text, std::string_view classes = {});
+
+    // Does the same as vp::Table::merge_cells_into_rowspans() followed by
+    // merge_cells_into_colspans(), but in a single bottom-to-top pass over all cells.
+    void merge_cells();
+    void set_column_widths(std::vector<double> col_widths) { col_widths_ = std::move(col_widths); }
+    const std::vector<double> & column_widths() const { return col_widths_; }
+    void add_even_odd_classes_for_col(std::size_t col, StartFrom start_from = StartFrom::Odd);
+
+    // calls callable(cell) for each cell which must be written out, i.e. skips merged ones
+    template<typename RowBegin, typename CellCallable, typename RowEnd>
+    void iterate(RowBegin row_begin, CellCallable cell_callable, RowEnd row_end) const {
+        for (std::size_t row_num = 0; row_num < height(); ++row_num) {
+            row_begin(rows_[row_num]);
+            const auto end = rows_[row_num].first_cell + row_length(row_num);
+            for (auto i = rows_[row_num].first_cell; i < end; ++i) {
+                const auto & cell = cells_[i];
+                if (cell.rowspan == 0 || cell.colspan == 0) continue;
+                cell_callable(cell);
+            }
+            row_end();
+        }
+    }
+
+private:
+    String_Pool pool_;
+    std::pmr::vector<Row> rows_;
+    std::pmr::vector<Cell> cells_;
+    std::vector<double> col_widths_;
+
+    Cell & cell_at(std::size_t row, std::size_t col);
+    Cell_Ref do_add_cell(std::string_view text, std::string_view classes, CellType type, Mergeable mergeable);
+    static bool mergeable_cells(const Cell & c1, const Cell & c2);
+    void add_row_span(std::size_t row, std::size_t col, std::size_t span_size);
+};
+
+} // namespace vp
+
+#endif // VP_COMPACT_TABLE_H
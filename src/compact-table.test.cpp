@@ -0,0 +1,119 @@
+#include "catch-formatters.h"
+
+#include "compact-table.h"
+#include "html-table-writer.h"
+
+#include <sstream>
+
+namespace {
+std::string to_html(const vp::Table & table) {
+    std::stringstream stream;
+    stream << vp::Html_Table_Writer(table);
+    return stream.str();
+}
+
+std::string to_html(const vp::Compact_Table & table) {
+    fmt::memory_buffer buf;
+    vp::write_html_table(buf, table);
+    return fmt::to_string(buf);
+}
+
+// Fill both kinds of tables with the same data.
+template<class TableT>
+void fill_sample_table(TableT & table) {
+    table.add_header_cell("header");
+    table.add_header_cell("header");
+    table.add_header_cell("date1", "mainpart");
+    for (int row = 0; row < 30; ++row) {
+        table.start_new_row(row % 2 ? "odd" : "even");
+        table.add_cell(row < 20 ? "+5:30" : "+3:00");
+        table.add_cell("same").set_title("title with \"quotes\"");
+        if (row == 7) {
+            table.add_unmergeable_cell("", "mainpart");
+        } else {
+            table.add_cell(row < 5 ? "a" : "b", "mainpart vrata");
+        }
+    }
+    table.start_new_row("separator");
+    table.start_new_row();
+    table.add_cell("x");
+    table.add_cell("x");
+    table.add_cell("x");
+    table.set_column_widths({10.0, 30.0, 60.0/7});
+}
+}
+
+TEST_CASE("String_Pool gives equal ids for equal strings") {
+    vp::String_Pool pool;
+    REQUIRE(pool.intern("") == vp::String_Pool::Empty);
+    auto id1 = pool.intern("abc");
+    auto id2 = pool.intern(std::string{"ab"} + "c");
+    REQUIRE(id1 == id2);
+    REQUIRE(pool.intern("abd") != id1);
+    REQUIRE(pool.get(id1) == "abc");
+    REQUIRE(pool.size() == 3);
+}
+
+TEST_CASE("String_Pool joins strings with space") {
+    vp::String_Pool pool;
+    auto id = pool.intern("mainpart");
+    REQUIRE(pool.get(pool.join_with_space(id, "odd")) == "mainpart odd");
+    REQUIRE(pool.get(pool.join_with_space(vp::String_Pool::Empty, "odd")) == "odd");
+    REQUIRE(pool.join_with_space(id, "") == id);
+}
+
+TEST_CASE("Compact_Table merges cells the same way vp::Table does") {
+    vp::Table table;
+    vp::Compact_Table compact;
+    fill_sample_table(table);
+    fill_sample_table(compact);
+    table.merge_cells_into_rowspans();
+    table.merge_cells_into_colspans();
+    compact.merge_cells();
+
+    REQUIRE(compact.height() == table.height());
+    REQUIRE(compact.width() == table.width());
+    for (std::size_t row = 0; row < table.height(); ++row) {
+        REQUIRE(compact.row_length(row) == table.row(row).data.size());
+        for (std::size_t col = 0; col < compact.row_length(row); ++col) {
+            CAPTURE(row, col);
+            const auto & cell = table.at(row, col);
+            const auto & compact_cell = compact.at(row, col);
+            REQUIRE(compact.text(compact_cell.text) == cell.text);
+            REQUIRE(compact.text(compact_cell.classes) == cell.classes);
+            REQUIRE(compact_cell.rowspan == cell.rowspan);
+            REQUIRE(compact_cell.colspan == cell.colspan);
+        }
+    }
+}
+
+TEST_CASE("write_html_table() writes exactly the same HTML as Html_Table_Writer") {
+    vp::Table table;
+    vp::Compact_Table compact;
+    fill_sample_table(table);
+    fill_sample_table(compact);
+    table.merge_cells_into_rowspans();
+    table.merge_cells_into_colspans();
+    table.add_even_odd_classes_for_col(0);
+    table.add_even_odd_classes_for_col(1, vp::Table::StartFrom::Even);
+    compact.merge_cells();
+    compact.add_even_odd_classes_for_col(0);
+    compact.add_even_odd_classes_for_col(1, vp::Compact_Table::StartFrom::Even);
+
+    const auto html = to_html(compact);
+    REQUIRE(html == to_html(table));
+    using Catch::Matchers::Contains;
+    REQUIRE_THAT(html, Contains("merge-to-top"));
+    REQUIRE_THAT(html, Contains("&quot;quotes&quot;"));
+}
+
+TEST_CASE("Compact_Table allocated from monotonic buffer gives the same HTML") {
+    std::pmr::monotonic_buffer_resource arena;
+    vp::Compact_Table compact{&arena};
+    vp::Compact_Table reference;
+    fill_sample_table(compact);
+    fill_sample_table(reference);
+    compact.merge_cells();
+    reference.merge_cells();
+    REQUIRE(to_html(compact) == to_html(reference));
+}
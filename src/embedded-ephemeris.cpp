@@ -0,0 +1,238 @@
+#include "embedded-ephemeris.h"
+
+#include "fmt-format-fixed.h"
+#include "location.h"
+#include "swe.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include "swephexp.h"
+
+#ifdef VP_EMBEDDED_EPHEMERIS
+namespace vp::detail {
+// defined in the source made by EmbeddedEphemerisWriter::write_source()
+extern const EmbeddedEphemeris embedded_ephemeris;
+}
+#endif
+
+namespace vp {
+
+namespace {
+constexpr double pi = 3.14159265358979323846;
+// julian days of 1970-01-01 00:00 UT
+constexpr double unix_epoch_julian_days = 2440587.5;
+// searches for tithis, nakṣatras and saṅkrāntis look that far around the dates of interest
+constexpr double spare_days = 64.0;
+
+constexpr double sun_segment_days = 16.0;
+constexpr std::uint32_t sun_order = 12;
+constexpr double moon_segment_days = 4.0;
+constexpr std::uint32_t moon_order = 14;
+// points per segment compared with the source after fitting
+constexpr int check_points = 32;
+
+// difference of two longitudes, degrees [-180..180)
+double longitude_delta(double from, double to) {
+    return to - from - 360.0 * std::floor((to - from + 180.0) / 360.0);
+}
+
+double julian_days(date::year_month_day date) {
+    return static_cast<double>(date::sys_days{date}.time_since_epoch().count()) + unix_epoch_julian_days;
+}
+}
+
+bool EmbeddedEphemeris::Series::covers(JulDays_UT time) const
+{
+    const double days = time.raw_julian_days_ut().count() - start;
+    return days >= 0.0 && days <= segment_days * segment_count;
+}
+
+double EmbeddedEphemeris::Series::longitude(JulDays_UT time) const
+{
+    const double days = time.raw_julian_days_ut().count() - start;
+    // the very end of the last segment belongs to it, too
+    const auto segment = std::min(static_cast<std::uint32_t>(days / segment_days), segment_count - 1);
+    const double x = 2.0 * (days - segment * segment_days) / segment_days - 1.0;
+
+    // Clenshaw's recurrence for sum of c[k]*T[k](x)
+    const std::int32_t * c = coefficients + std::size_t{segment} * (order - 1);
+    double b1 = 0.0;
+    double b2 = 0.0;
+    for (std::uint32_t k = order - 1; k >= 1; --k) {
+        const double b0 = c[k - 1] * CoefficientUnit + 2.0 * x * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    double longitude = std::fmod(constant_terms[segment] + x * b1 - b2, 360.0);
+    if (longitude < 0.0) longitude += 360.0;
+    // adding 360 to tiny negative values gives exactly 360.0
+    if (longitude >= 360.0) longitude -= 360.0;
+    return longitude;
+}
+
+const EmbeddedEphemeris * EmbeddedEphemeris::get()
+{
+#ifdef VP_EMBEDDED_EPHEMERIS
+    return &detail::embedded_ephemeris;
+#else
+    return nullptr;
+#endif
+}
+
+EmbeddedEphemerisWriter::EmbeddedEphemerisWriter(int from_year, int to_year) : from_year_(from_year), to_year_(to_year)
+{
+    // Swe sets up ephemeris path and ayanāṃśa, but positions are taken from sweph directly:
+    // Swe itself would take them from the embedded tables when there are some.
+    const Swe swe{Location{}, CalcFlags::EphemerisSwiss};
+    // Tropical minus the true ayanāṃśa, like Swe::evaluate() and the rest of Swe (not SEFLG_SIDEREAL,
+    // which uses mean equinox and mean ayanāṃśa): embedded and sweph results must be comparable.
+    const auto sidereal_longitude = [](int planet) {
+        return [planet](JulDays_UT time) {
+            constexpr int32 flags = SEFLG_SWIEPH;
+            const double jd = time.raw_julian_days_ut().count();
+            std::array<double, 6> res;
+            std::array<char, AS_MAXCH> serr;
+            const int32 res_flags = swe_calc_ut(jd, planet, flags, res.data(), serr.data());
+            if (res_flags == ERR) throw std::runtime_error(serr.data());
+            // without the files sweph quietly falls back to Moshier ephemeris
+            if ((res_flags & SEFLG_SWIEPH) == 0) throw std::runtime_error(fmt::format("Swiss ephemeris files are needed for {}", time));
+            double ayanamsha;
+            if (swe_get_ayanamsa_ex_ut(jd, flags, &ayanamsha, serr.data()) == ERR) throw std::runtime_error(serr.data());
+            const double sidereal = std::fmod(res[0] - ayanamsha + 360.0, 360.0);
+            // adding 360 to tiny negative values gives exactly 360.0
+            return sidereal >= 360.0 ? sidereal - 360.0 : sidereal;
+        };
+    };
+    fit_both(sidereal_longitude(SE_SUN), sidereal_longitude(SE_MOON));
+}
+
+EmbeddedEphemerisWriter::EmbeddedEphemerisWriter(int from_year, int to_year, const LongitudeFunction & sun, const LongitudeFunction & moon)
+    : from_year_(from_year), to_year_(to_year)
+{
+    fit_both(sun, moon);
+}
+
+void EmbeddedEphemerisWriter::fit_both(const LongitudeFunction & sun, const LongitudeFunction & moon)
+{
+    if (to_year_ < from_year_) throw std::runtime_error(fmt::format("wrong year range: {}..{}", from_year_, to_year_));
+    sun_ = fit(sun_segment_days, sun_order, sun);
+    moon_ = fit(moon_segment_days, moon_order, moon);
+    if (max_error_ > EmbeddedEphemeris::MaxError) {
+        throw std::runtime_error(fmt::format("embedded ephemeris would be off by up to {}° (more than {}°)", max_error_, EmbeddedEphemeris::MaxError));
+    }
+}
+
+EmbeddedEphemerisWriter::FittedSeries EmbeddedEphemerisWriter::fit(double segment_days, std::uint32_t order, const LongitudeFunction & longitude)
+{
+    using namespace date;
+    const double start = julian_days(year{from_year_}/January/1) - spare_days;
+    const double end = julian_days(year{to_year_ + 1}/January/1) + spare_days;
+    const auto segment_count = static_cast<std::uint32_t>(std::ceil((end - start) / segment_days));
+
+    FittedSeries series{start, segment_days, order, {}, {}};
+    series.constant_terms.reserve(segment_count);
+    series.coefficients.reserve(std::size_t{segment_count} * (order - 1));
+
+    // Chebyshev interpolation: values at the nodes cos(θ[j]), θ[j] = π(j+½)/order.
+    std::vector<double> angles(order);
+    for (std::uint32_t j = 0; j < order; ++j) angles[j] = pi * (j + 0.5) / order;
+    std::vector<double> values(order);
+    for (std::uint32_t segment = 0; segment < segment_count; ++segment) {
+        const double middle = start + (segment + 0.5) * segment_days;
+        double previous = 0.0;
+        for (std::uint32_t j = 0; j < order; ++j) {
+            const double value = longitude(JulDays_UT{double_days{middle + 0.5 * segment_days * std::cos(angles[j])}});
+            // nodes are less than a day apart, so it's never more than 180° from the previous one
+            values[j] = (j == 0) ? value : values[j - 1] + longitude_delta(previous, value);
+            previous = value;
+        }
+        for (std::uint32_t k = 0; k < order; ++k) {
+            double sum = 0.0;
+            for (std::uint32_t j = 0; j < order; ++j) sum += values[j] * std::cos(k * angles[j]);
+            const double coefficient = sum * 2.0 / order;
+            if (k == 0) {
+                series.constant_terms.push_back(coefficient / 2.0);
+                continue;
+            }
+            const double units = std::round(coefficient / EmbeddedEphemeris::CoefficientUnit);
+            if (std::fabs(units) > std::numeric_limits<std::int32_t>::max()) {
+                throw std::runtime_error(fmt::format("Chebyshev coefficient {} is too big for embedded ephemeris", coefficient));
+            }
+            series.coefficients.push_back(static_cast<std::int32_t>(units));
+        }
+    }
+
+    const auto fitted = series.view();
+    for (std::uint32_t segment = 0; segment < segment_count; ++segment) {
+        for (int i = 0; i < check_points; ++i) {
+            const JulDays_UT time{double_days{start + (segment + (i + 0.5) / check_points) * segment_days}};
+            max_error_ = std::max(max_error_, std::fabs(longitude_delta(longitude(time), fitted.longitude(time))));
+        }
+    }
+    return series;
+}
+
+EmbeddedEphemeris::Series EmbeddedEphemerisWriter::FittedSeries::view() const
+{
+    return EmbeddedEphemeris::Series{
+        start,
+        segment_days,
+        static_cast<std::uint32_t>(constant_terms.size()),
+        order,
+        constant_terms.data(),
+        coefficients.data()};
+}
+
+EmbeddedEphemeris EmbeddedEphemerisWriter::ephemeris() const
+{
+    return EmbeddedEphemeris{sun_.view(), moon_.view()};
+}
+
+void EmbeddedEphemerisWriter::write_source(std::ostream & out) const
+{
+    fmt::memory_buffer buf;
+    fmt::appender it{buf};
+    fmt::format_to(it,
+                   "// Generated by vaishnavam-panchangam-db -e {} {}: Sun and Moon for VP_EMBEDDED_EPHEMERIS,\n"
+                   "// see embedded-ephemeris.h. Largest error is {:.3g} degrees.\n"
+                   "#include \"embedded-ephemeris.h\"\n"
+                   "\n"
+                   "namespace {{\n",
+                   from_year_, to_year_, max_error_);
+    const auto write_tables = [&](const char * name, const FittedSeries & series) {
+        fmt::format_to(it, "const double {}_constant_terms[] = {{\n", name);
+        for (const double term : series.constant_terms) fmt::format_to(it, "    {},\n", term);
+        fmt::format_to(it, "}};\nconst std::int32_t {}_coefficients[] = {{\n", name);
+        // one segment per line
+        const std::size_t per_segment = series.order - 1;
+        for (std::size_t i = 0; i < series.coefficients.size(); ++i) {
+            fmt::format_to(it, "{}{},{}", (i % per_segment == 0) ? "    " : " ", series.coefficients[i],
+                           (i % per_segment == per_segment - 1) ? "\n" : "");
+        }
+        fmt::format_to(it, "}};\n");
+    };
+    write_tables("sun", sun_);
+    write_tables("moon", moon_);
+    const auto series_initializer = [&](const char * name, const FittedSeries & series) {
+        fmt::format_to(it, "    {{{}, {}, {}, {}, {}_constant_terms, {}_coefficients}},\n",
+                       series.start, series.segment_days, series.constant_terms.size(), series.order, name, name);
+    };
+    fmt::format_to(it,
+                   "}} // anonymous namespace\n"
+                   "\n"
+                   "namespace vp::detail {{\n"
+                   "extern const EmbeddedEphemeris embedded_ephemeris;\n"
+                   "const EmbeddedEphemeris embedded_ephemeris{{\n");
+    series_initializer("sun", sun_);
+    series_initializer("moon", moon_);
+    fmt::format_to(it,
+                   "}};\n"
+                   "}} // namespace vp::detail\n");
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+} // namespace vp
@@ -0,0 +1,92 @@
+#ifndef VP_EMBEDDED_EPHEMERIS_H
+#define VP_EMBEDDED_EPHEMERIS_H
+
+#include "juldays_ut.h"
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+namespace vp {
+
+/* Sidereal (Lahiri) longitudes of the Sun and the Moon compiled into the binary
+ * (see VP_EMBEDDED_EPHEMERIS in CMakeLists.txt): Chebyshev series fitted to Swiss
+ * ephemeris by EmbeddedEphemerisWriter for a range of years. Swe uses them instead
+ * of sweph files within that range, so tithi/nakṣatra/saṅkrānti searches never touch the disk.
+ *
+ * Each segment has its constant term as double and the rest as int32 multiples of
+ * CoefficientUnit, less than half the size of plain doubles. The writer makes sure
+ * the longitudes are within MaxError of Swiss ephemeris ones (i.e. tithi and
+ * nakṣatra starts within ~0.01 second).
+ */
+struct EmbeddedEphemeris {
+    static constexpr double CoefficientUnit = 1.0 / (1 << 24); // degrees
+    static constexpr double MaxError = 1e-6; // degrees
+
+    // Longitude of one body, unwrapped (not limited to 360°) within each segment.
+    struct Series {
+        double start; // raw julian days (UT) of the first segment start
+        double segment_days;
+        std::uint32_t segment_count;
+        std::uint32_t order; // coefficients per segment
+        const double * constant_terms; // one per segment
+        const std::int32_t * coefficients; // order-1 per segment
+
+        bool covers(JulDays_UT time) const;
+        // degrees [0..360); time must be covered
+        double longitude(JulDays_UT time) const;
+    };
+
+    Series sun;
+    Series moon;
+
+    bool covers(JulDays_UT time) const { return sun.covers(time) && moon.covers(time); }
+
+    // Compiled-in ephemeris, nullptr unless built with VP_EMBEDDED_EPHEMERIS.
+    static const EmbeddedEphemeris * get();
+};
+
+/* Fits Sun and Moon longitudes for all dates from 1st January of from_year to 31st
+ * December of to_year (with a couple of months to spare on both sides for searches
+ * around the ends) and writes them as C++ source for VP_EMBEDDED_EPHEMERIS.
+ */
+class EmbeddedEphemerisWriter {
+public:
+    using LongitudeFunction = std::function<double(JulDays_UT time)>;
+
+    // Sidereal longitudes from sweph's Swiss ephemeris (needs the files in Swe's ephemeris path).
+    EmbeddedEphemerisWriter(int from_year, int to_year);
+    // Sidereal longitudes (degrees) from given functions, mostly for testing.
+    EmbeddedEphemerisWriter(int from_year, int to_year, const LongitudeFunction & sun, const LongitudeFunction & moon);
+
+    // largest difference from the source functions found while checking each segment, degrees
+    double max_error() const { return max_error_; }
+    // view of the tables kept by this writer
+    EmbeddedEphemeris ephemeris() const;
+    void write_source(std::ostream & out) const;
+
+private:
+    struct FittedSeries {
+        double start;
+        double segment_days;
+        std::uint32_t order;
+        std::vector<double> constant_terms;
+        std::vector<std::int32_t> coefficients;
+
+        EmbeddedEphemeris::Series view() const;
+    };
+
+    FittedSeries sun_;
+    FittedSeries moon_;
+    int from_year_;
+    int to_year_;
+    double max_error_ = 0.0;
+
+    void fit_both(const LongitudeFunction & sun, const LongitudeFunction & moon);
+    FittedSeries fit(double segment_days, std::uint32_t order, const LongitudeFunction & longitude);
+};
+
+} // namespace vp
+
+#endif // VP_EMBEDDED_EPHEMERIS_H
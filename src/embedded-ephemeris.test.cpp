@@ -0,0 +1,82 @@
+#include "catch-formatters.h"
+
+#include "embedded-ephemeris.h"
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+constexpr double degrees = 3.14159265358979323846 / 180.0;
+constexpr double j2000 = 2451545.0;
+
+double normalize(double longitude) {
+    longitude = std::fmod(longitude, 360.0);
+    return longitude < 0.0 ? longitude + 360.0 : longitude;
+}
+
+// main terms of Sun and Moon motion, good enough as something to fit
+double sun(vp::JulDays_UT time) {
+    const double d = time.raw_julian_days_ut().count() - j2000;
+    const double anomaly = (357.529 + 0.98560028 * d) * degrees;
+    return normalize(256.459 + 0.98564736 * d + 1.915 * std::sin(anomaly) + 0.020 * std::sin(2 * anomaly));
+}
+
+double moon(vp::JulDays_UT time) {
+    const double d = time.raw_julian_days_ut().count() - j2000;
+    const double anomaly = (134.963 + 13.064993 * d) * degrees;
+    const double elongation = (297.850 + 12.190749 * d) * degrees;
+    const double latitude_argument = (93.272 + 13.229350 * d) * degrees;
+    return normalize(194.316 + 13.176396 * d + 6.289 * std::sin(anomaly) + 1.274 * std::sin(2 * elongation - anomaly)
+                     + 0.658 * std::sin(2 * elongation) + 0.214 * std::sin(2 * anomaly) - 0.114 * std::sin(2 * latitude_argument));
+}
+
+double distance(double longitude1, double longitude2) {
+    const double delta = std::fabs(longitude1 - longitude2);
+    return std::min(delta, 360.0 - delta);
+}
+}
+
+TEST_CASE("EmbeddedEphemeris gives the longitudes it was made from") {
+    const vp::EmbeddedEphemerisWriter writer{2020, 2030, sun, moon};
+    REQUIRE(writer.max_error() <= vp::EmbeddedEphemeris::MaxError);
+    const auto ephemeris = writer.ephemeris();
+
+    const double from = vp::JulDays_UT{date::local_days{date::year{2020}/1/1}}.raw_julian_days_ut().count() - 30.0;
+    const double to = vp::JulDays_UT{date::local_days{date::year{2031}/1/1}}.raw_julian_days_ut().count() + 30.0;
+    std::mt19937 rng{1};
+    std::uniform_real_distribution<double> days{from, to};
+    for (int i = 0; i < 10000; ++i) {
+        const vp::JulDays_UT time{vp::double_days{days(rng)}};
+        REQUIRE(ephemeris.covers(time));
+        const double sun_longitude = ephemeris.sun.longitude(time);
+        const double moon_longitude = ephemeris.moon.longitude(time);
+        REQUIRE(sun_longitude >= 0.0);
+        REQUIRE(sun_longitude < 360.0);
+        REQUIRE(moon_longitude >= 0.0);
+        REQUIRE(moon_longitude < 360.0);
+        REQUIRE(distance(sun_longitude, sun(time)) <= vp::EmbeddedEphemeris::MaxError);
+        REQUIRE(distance(moon_longitude, moon(time)) <= vp::EmbeddedEphemeris::MaxError);
+    }
+    REQUIRE_FALSE(ephemeris.covers(vp::JulDays_UT{vp::double_days{from - 100.0}}));
+    REQUIRE_FALSE(ephemeris.covers(vp::JulDays_UT{vp::double_days{to + 100.0}}));
+}
+
+TEST_CASE("EmbeddedEphemerisWriter writes tables as C++ source") {
+    const vp::EmbeddedEphemerisWriter writer{2021, 2021, sun, moon};
+    std::ostringstream out;
+    writer.write_source(out);
+    const auto source = out.str();
+    REQUIRE_THAT(source, Catch::Matchers::Contains("#include \"embedded-ephemeris.h\""));
+    REQUIRE_THAT(source, Catch::Matchers::Contains("const EmbeddedEphemeris embedded_ephemeris{"));
+    REQUIRE_THAT(source, Catch::Matchers::Contains(fmt::format("{}, 4, {}, 14, moon_constant_terms, moon_coefficients",
+                                                                writer.ephemeris().moon.start, writer.ephemeris().moon.segment_count)));
+}
+
+TEST_CASE("EmbeddedEphemerisWriter refuses what it can't fit precisely enough") {
+    // wiggling a degree several times a day
+    const auto wiggly = [](vp::JulDays_UT time) { return normalize(moon(time) + std::sin(time.raw_julian_days_ut().count() * 20.0)); };
+    REQUIRE_THROWS_AS((vp::EmbeddedEphemerisWriter{2021, 2021, sun, wiggly}), std::runtime_error);
+    REQUIRE_THROWS_AS((vp::EmbeddedEphemerisWriter{2022, 2021, sun, moon}), std::runtime_error);
+}
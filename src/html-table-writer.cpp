@@ -72,4 +72,59 @@ std::ostream &operator<<(std::ostream &s, const Html_Table_Writer &tw)
     return s;
 }
 
+void write_html_table(fmt::memory_buffer & out, const vp::Compact_Table & table)
+{
+    auto append = [&out](std::string_view text) { out.append(text.data(), text.data() + text.size()); };
+    const auto & col_widths = table.column_widths();
+    std::vector<bool> width_written_for_column(table.width());
+
+    auto write_cell = [&](const vp::Compact_Table::Cell & cell) {
+        std::string_view tag = (cell.type == vp::Compact_Table::CellType::Header) ? "th" : "td";
+        out.push_back('<');
+        append(tag);
+        if (cell.rowspan != 1) {
+            fmt::format_to(fmt::appender{out}, FMT_STRING(" rowspan=\"{}\""), cell.rowspan);
+        }
+        if (cell.colspan != 1) {
+            fmt::format_to(fmt::appender{out}, FMT_STRING(" colspan=\"{}\""), cell.colspan);
+        } else if (!width_written_for_column[cell.col]) {
+            if (col_widths.size() >= cell.col+1) {
+                // {:g} gives the same output as default std::ostream formatting of double
+                fmt::format_to(fmt::appender{out}, FMT_STRING(" width=\"{:g}%\""), col_widths[cell.col]);
+            }
+            width_written_for_column[cell.col] = true;
+        }
+        if (cell.classes != String_Pool::Empty) {
+            append(" class=\"");
+            append(table.text(cell.classes));
+            out.push_back('"');
+        }
+        if (cell.title != String_Pool::Empty) {
+            append(" title=\"");
+            html::escape_attribute_to(out, table.text(cell.title));
+            out.push_back('"');
+        }
+        out.push_back('>');
+        append(table.text(cell.text));
+        append("</");
+        append(tag);
+        append(">\n");
+    };
+
+    append("<table>\n");
+    table.iterate(
+        [&](const vp::Compact_Table::Row & row) {
+            append("<tr");
+            if (row.classes != String_Pool::Empty) {
+                append(" class=\"");
+                append(table.text(row.classes));
+                out.push_back('"');
+            }
+            out.push_back('>');
+        },
+        write_cell,
+        [&]() { append("</tr>\n"); });
+    append("</table>\n");
+}
+
 }
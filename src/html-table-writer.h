@@ -2,6 +2,8 @@
 #define HTML_TABLE_WRITER_H
 
 #include <ostream>
+#include "compact-table.h"
+#include "fmt-format-fixed.h"
 #include "table.h"
 
 namespace vp {
@@ -17,6 +19,9 @@ private:
 
 std::ostream & operator<<(std::ostream & s, const vp::Html_Table_Writer & tw);
 
+// Streaming counterpart of Html_Table_Writer: appends the same HTML directly to the buffer.
+void write_html_table(fmt::memory_buffer & out, const vp::Compact_Table & table);
+
 }
 
 #endif // HMTL_TABLE_WRITER_H
@@ -15,3 +15,18 @@ std::string html::escape_attribute(const std::string &s)
     }
     return escaped;
 }
+
+void html::escape_attribute_to(fmt::memory_buffer & out, std::string_view s)
+{
+    auto append = [&out](std::string_view text) { out.append(text.data(), text.data() + text.size()); };
+    for (auto c : s) {
+        switch(c) {
+        case '&': append("&amp;"); break;
+        case '"': append("&quot;"); break;
+        case '\'': append("&#039;"); break;
+        case '<': append("&lt;"); break;
+        case '>': append("&gt;"); break;
+        default: out.push_back(c); break;
+        }
+    }
+}
@@ -1,11 +1,16 @@
 #ifndef HTMLUTIL_H
 #define HTMLUTIL_H
 
+#include "fmt-format-fixed.h"
+
 #include <string>
+#include <string_view>
 
 namespace html {
 
 std::string escape_attribute(const std::string & s);
+// same as above, but appends escaped text to the buffer without temporary strings
+void escape_attribute_to(fmt::memory_buffer & out, std::string_view s);
 
 }
 
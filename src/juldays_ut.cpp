@@ -165,4 +165,20 @@ date::zoned_time<double_days> JulDays_UT::as_zoned_time(const date::time_zone *
     return date::make_zoned(time_zone, as_sys_time());
 }
 
+const date::sys_info & LocalTimeCache::info(JulDays_UT t)
+{
+    // same rounding as date::zoned_time
+    const date::sys_time<LocalTime::duration> sys{t.as_sys_time()};
+    if (sys < info_.begin || sys >= info_.end) {
+        info_ = time_zone_->get_info(date::floor<std::chrono::seconds>(sys));
+    }
+    return info_;
+}
+
+LocalTimeCache::LocalTime LocalTimeCache::local_time(JulDays_UT t)
+{
+    const date::sys_time<LocalTime::duration> sys{t.as_sys_time()};
+    return LocalTime{sys.time_since_epoch() + info(t).offset};
+}
+
 } // namespace vp
@@ -4,6 +4,8 @@
 #include "date-fixed.h"
 #include "tz-fixed.h"
 
+#include <utility>
+
 namespace vp {
 
 using double_hours = std::chrono::duration<double, std::ratio<3600>>;
@@ -58,6 +60,26 @@ public:
         t_(t), time_zone_(time_zone) {}
 };
 
+/* Local times in one time zone with a single time_zone::get_info() per UTC offset period
+ * instead of one per conversion. Times of a vrata are days apart and offset changes are
+ * months apart, so all of them usually share one lookup. Not thread-safe: keep one per location.
+ */
+class LocalTimeCache {
+public:
+    // the same type as JulDays_UT::as_zoned_time().get_local_time(), for bit-exact results
+    using LocalTime = decltype(std::declval<date::zoned_time<double_days>>().get_local_time());
+
+    explicit LocalTimeCache(const date::time_zone * time_zone) : time_zone_(time_zone) {}
+    const date::time_zone * time_zone() const { return time_zone_; }
+    // same as t.as_zoned_time(time_zone()).get_info()
+    const date::sys_info & info(JulDays_UT t);
+    // same as t.as_zoned_time(time_zone()).get_local_time()
+    LocalTime local_time(JulDays_UT t);
+private:
+    const date::time_zone * time_zone_;
+    date::sys_info info_{}; // empty begin..end range until the first lookup
+};
+
 JulDays_UT operator +(const JulDays_UT &, double_days);
 JulDays_UT operator -(const JulDays_UT &, double_days);
 
@@ -134,3 +134,17 @@ TEST_CASE("round_to_minute_down() works") {
     REQUIRE(date::sys_days(date) + pair2.second == JulDays_UT{date, pair2.first}.round_to_minute_down());
     REQUIRE(date::sys_days(date) + pair3.second == JulDays_UT{date, pair3.first}.round_to_minute_down());
 }
+
+TEST_CASE("LocalTimeCache gives the same local times as zoned conversion, across DST changes") {
+    const auto * kyiv = date::locate_zone("Europe/Kyiv");
+    LocalTimeCache cache{kyiv};
+    // hour by hour around the switch to DST on 2021-03-28 and back
+    for (const auto day : {2021_y/March/27, 2021_y/March/28, 2021_y/October/31, 2021_y/March/28}) {
+        for (int hour = 0; hour < 24; ++hour) {
+            const JulDays_UT t{day, double_hours{hour + 0.1234}};
+            CAPTURE(t);
+            REQUIRE(cache.local_time(t) == t.as_zoned_time(kyiv).get_local_time());
+            REQUIRE(cache.info(t).offset == t.as_zoned_time(kyiv).get_info().offset);
+        }
+    }
+}
@@ -1,8 +1,14 @@
 #include <chrono>
 #include <cstring>
+#include <iostream>
 #include "fmt-format-fixed.h"
 
+#include "calc-variants.h"
+#include "place-db.h"
 #include "text-interface.h"
+#include "time-zone-db.h"
+#include "vrata-boundary.h"
+#include "vrata-db.h"
 
 // include Windows.h should go after including date.h (which is included from text-interface.h).
 // Otherwise troubles with min() which is used both as: 1) a macro in Windows.h 2) method function in date.h.
@@ -15,9 +21,23 @@ void print_usage() {
                "USAGE:\n"
                "vaishnavam-panchangam YYYY-MM-DD latitude longitude\n"
                "vaishnavam-panchangam YYYY-MM-DD location-name\n"
+               "vaishnavam-panchangam -d YYYY-MM-DD [YYYY-MM-DD] location-name\n"
+               "vaishnavam-panchangam -g YYYY-MM-DD time-zone < coordinates.txt\n"
+               "vaishnavam-panchangam -b YYYY-MM-DD > boundaries.geojson\n"
+               "vaishnavam-panchangam -v YYYY-MM-DD location-name\n"
+               "vaishnavam-panchangam -p YYYY-MM-DD [location-name]\n"
                "\n"
-               "    latitude and longitude are given as decimal degrees (e.g. 30.7)\n",
-               vp::text_ui::program_name_and_version());
+               "    latitude and longitude are given as decimal degrees (e.g. 30.7), time zone is found\n"
+               "    by them ({} in the data dir has time zone boundaries, see vaishnavam-panchangam-db).\n"
+               "    -d prints all events day by day, for one date or for each date in the range.\n"
+               "    -g reads \"latitude longitude\" lines and finds vratas for all of them at once,\n"
+               "    interpolating times where possible (e.g. for maps). time-zone is like Europe/Kiev.\n"
+               "    -b finds curves where the date or type of the next vrata changes across the globe.\n"
+               "    -v compares the next vrata for all combinations of calculation flags.\n"
+               "    -p quickly finds dates and types of next vratas (for all locations by default),\n"
+               "    calculating exactly only those which approximate calculation can't tell for sure.\n",
+               vp::text_ui::program_name_and_version(),
+               vp::TimeZoneDb::DefaultFileName);
 }
 
 int main(int argc, char *argv[]) try
@@ -27,16 +47,89 @@ int main(int argc, char *argv[]) try
 #endif
     vp::text_ui::change_to_data_dir(argv[0]);
     date::set_install("tzdata");
+    vp::text_ui::use_vrata_db(vp::VrataDb::DefaultFileName);
+    vp::text_ui::use_place_db(vp::PlaceDb::DefaultFileName);
+    vp::text_ui::use_time_zone_db(vp::TimeZoneDb::DefaultFileName);
     if (argc-1 >= 1 && strcmp(argv[1], "-d") == 0) {
+        if (argc-1 != 3 && argc-1 != 4) {
+            print_usage();
+            exit(-1);
+        }
+        auto base_date = vp::text_ui::parse_ymd(argv[2]);
+        fmt::memory_buffer buf;
+        if (argc-1 == 4) {
+            auto to_date = vp::text_ui::parse_ymd(argv[3]);
+            const char * const location_name = argv[4];
+            vp::text_ui::daybyday_print_range(base_date, to_date, location_name, fmt::appender{buf}, vp::CalcFlags::Default);
+        } else {
+            const char * const location_name = argv[3];
+            vp::text_ui::daybyday_print_one(base_date, location_name, fmt::appender{buf}, vp::CalcFlags::Default);
+        }
+        fmt::print("{}", std::string_view{buf.data(), buf.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "-g") == 0) {
         if (argc-1 != 3) {
             print_usage();
             exit(-1);
         }
         auto base_date = vp::text_ui::parse_ymd(argv[2]);
-        const char * const location_name = argv[3];
+        const char * const time_zone_name = argv[3];
         fmt::memory_buffer buf;
-        vp::text_ui::daybyday_print_one(base_date, location_name, fmt::appender{buf}, vp::CalcFlags::Default);
+        vp::text_ui::grid_calc_and_report(base_date, time_zone_name, std::cin, fmt::appender{buf});
         fmt::print("{}", std::string_view{buf.data(), buf.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "-b") == 0) {
+        if (argc-1 != 2) {
+            print_usage();
+            exit(-1);
+        }
+        auto base_date = vp::text_ui::parse_ymd(argv[2]);
+        const auto lines = vp::find_vrata_boundaries(vp::vrata_classifier(date::local_days{base_date}), {},
+                                                     vp::vrata_boundary_condition(date::local_days{base_date}));
+        fmt::print("{}", vp::boundaries_to_geojson(lines));
+    } else if (argc-1 >= 1 && strcmp(argv[1], "-v") == 0) {
+        if (argc-1 != 3) {
+            print_usage();
+            exit(-1);
+        }
+        auto base_date = vp::text_ui::parse_ymd(argv[2]);
+        const auto location = vp::text_ui::LocationDb::find_coord(argv[3]);
+        if (!location) {
+            fmt::print(stderr, "Location not found: '{}'\n", argv[3]);
+            exit(-1);
+        }
+        const auto result = vp::calc_variants(date::local_days{base_date}, *location, vp::all_calc_flags_variants());
+        for (const auto & [flags, vrata] : result.variants) {
+            if (vrata) {
+                fmt::print("{}: {} {}\n", vp::calc_flags_description(flags), date::year_month_day{vrata->date}, vrata->type);
+            } else {
+                fmt::print("{}: error: {}\n", vp::calc_flags_description(flags), vrata.error());
+            }
+        }
+        fmt::print("\n{} difference(s) from default:\n", result.differences.size());
+        for (const auto & difference : result.differences) {
+            fmt::print("{}\n", difference);
+        }
+    } else if (argc-1 >= 1 && strcmp(argv[1], "-p") == 0) {
+        if (argc-1 != 2 && argc-1 != 3) {
+            print_usage();
+            exit(-1);
+        }
+        auto base_date = vp::text_ui::parse_ymd(argv[2]);
+        const std::string location_name = argc-1 == 3 ? argv[3] : "all";
+        const auto previews = vp::text_ui::preview(base_date, location_name);
+        if (previews.empty()) {
+            fmt::print(stderr, "Location not found: '{}'\n", location_name);
+            exit(-1);
+        }
+        const auto vratas = vp::text_ui::refine_previews(base_date, previews);
+        for (std::size_t i = 0; i < vratas.size(); ++i) {
+            const auto & location = previews[i].vrata.location;
+            const char * const recalculated = previews[i].uncertain ? " (recalculated)" : "";
+            if (vratas[i]) {
+                fmt::print("{}: {} {}{}\n", location.name, date::year_month_day{vratas[i]->date}, vratas[i]->type, recalculated);
+            } else {
+                fmt::print("{}: error: {}\n", location.name, vratas[i].error());
+            }
+        }
     } else {
         if (argc-1 != 1 && argc-1 != 2 && argc-1 != 3) {
             print_usage();
@@ -55,7 +148,7 @@ int main(int argc, char *argv[]) try
             double latitude = std::stod(argv[2]);
             double longitude = std::stod(argv[3]);
             fmt::memory_buffer buf;
-            vp::text_ui::calc_and_report_one(base_date, vp::Location{vp::Latitude{latitude}, vp::Longitude{longitude}}, fmt::appender{buf});
+            vp::text_ui::calc_and_report_one(base_date, vp::text_ui::custom_location(vp::Coord{vp::Latitude{latitude}, vp::Longitude{longitude}}), fmt::appender{buf});
             fmt::print("{}", std::string_view{buf.data(), buf.size()});
         }
     }
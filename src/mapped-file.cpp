@@ -0,0 +1,85 @@
+#include "mapped-file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vp {
+
+#ifdef _WIN32
+std::optional<MappedFile> MappedFile::open(const fs::path & path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::nullopt;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return std::nullopt;
+    // the view keeps the mapping alive, so the handle is not needed anymore
+    const void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return std::nullopt;
+    return MappedFile{static_cast<const unsigned char *>(view), static_cast<std::size_t>(size.QuadPart)};
+}
+
+void MappedFile::unmap()
+{
+    if (data_) UnmapViewOfFile(data_);
+}
+#else
+std::optional<MappedFile> MappedFile::open(const fs::path & path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) return std::nullopt;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    void * addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // mapping stays valid after closing the descriptor
+    ::close(fd);
+    if (addr == MAP_FAILED) return std::nullopt;
+    return MappedFile{static_cast<const unsigned char *>(addr), size};
+}
+
+void MappedFile::unmap()
+{
+    if (data_) munmap(const_cast<unsigned char *>(data_), size_);
+}
+#endif
+
+MappedFile::MappedFile(MappedFile && other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+{}
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+} // namespace vp
@@ -0,0 +1,36 @@
+#ifndef VP_MAPPED_FILE_H
+#define VP_MAPPED_FILE_H
+
+#include "filesystem-fixed.h"
+
+#include <cstddef>
+#include <optional>
+
+namespace vp {
+
+// Whole file mapped into memory read-only. Move-only, unmaps the file on destruction.
+class MappedFile {
+public:
+    // nullopt if the file does not exist, is empty or can't be mapped
+    static std::optional<MappedFile> open(const fs::path & path);
+
+    MappedFile(MappedFile && other) noexcept;
+    MappedFile & operator=(MappedFile && other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    const unsigned char * data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    MappedFile(const unsigned char * data, std::size_t size) : data_(data), size_(size) {}
+    void unmap();
+
+    const unsigned char * data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace vp
+
+#endif // VP_MAPPED_FILE_H
@@ -3,18 +3,31 @@
 
 #include "date-fixed.h"
 #include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 namespace vp{
+// Allocator-aware, so that strings of NamedDate inside NamedDates are allocated
+// from the same memory resource as the container itself (e.g. per-request arena).
 struct NamedDate {
-    std::string name;
-    std::string title;
-    std::string css_classes;
-    NamedDate(std::string name_, std::string title_="", std::string css_classes_="") :
-          name(name_), title(title_), css_classes(css_classes_) {}
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+    std::pmr::string name;
+    std::pmr::string title;
+    std::pmr::string css_classes;
+    NamedDate(std::string_view name_, std::string_view title_="", std::string_view css_classes_="", const allocator_type & alloc = {}) :
+          name(name_, alloc), title(title_, alloc), css_classes(css_classes_, alloc) {}
+    NamedDate(const NamedDate & other) = default;
+    NamedDate(NamedDate && other) = default;
+    NamedDate(const NamedDate & other, const allocator_type & alloc) :
+          name(other.name, alloc), title(other.title, alloc), css_classes(other.css_classes, alloc) {}
+    NamedDate(NamedDate && other, const allocator_type & alloc) :
+          name(std::move(other.name), alloc), title(std::move(other.title), alloc), css_classes(std::move(other.css_classes), alloc) {}
+    NamedDate & operator=(const NamedDate & other) = default;
+    NamedDate & operator=(NamedDate && other) = default;
 };
 
-using NamedDates = std::multimap<date::local_days, NamedDate>;
+using NamedDates = std::pmr::multimap<date::local_days, NamedDate>;
 }
 
 #endif // NAMEDDATES_H
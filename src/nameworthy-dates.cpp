@@ -3,31 +3,51 @@
 #include "calc.h"
 #include "html-util.h"
 #include "masa.h"
+#include "time-format.h"
 #include "tithi.h"
 
 #include <array>
 #include <string>
 
 namespace {
-std::string paran_title(const vp::Paran & paran) {
+std::string paran_title(const vp::Paran & paran, vp::LocalTimeCache & local_times) {
     std::string title;
 
     if (paran.paran_start) {
-        title += fmt::format(FMT_STRING("{} ({})"), paran.start_str_seconds(), paran.start_type());
+        title += fmt::format(FMT_STRING("{} ({})"), paran.start_str_seconds(local_times), paran.start_type());
     }
     title += "…";
     if (paran.paran_end) {
-        title += fmt::format(FMT_STRING("{} ({})"), paran.end_str_seconds(), paran.end_type());
+        title += fmt::format(FMT_STRING("{} ({})"), paran.end_str_seconds(local_times), paran.end_type());
     }
     if (paran.paran_limit) {
-        const auto limit_str = date::format("%H:%M:%S", date::floor<std::chrono::seconds>(paran.paran_limit->as_zoned_time(paran.time_zone).get_local_time()));
+        const auto limit_str = vp::hh_mm_ss(date::floor<std::chrono::seconds>(local_times.local_time(*paran.paran_limit)));
         title += fmt::format(FMT_STRING(", absolute limit is {} (dvādaśī end)"), limit_str);
     }
     return title;
 }
+
+struct TithiWithName {
+    vp::DiscreteTithi tithi;
+    const char * name;
+};
+
+// Order matters: index in this array is stored as SpecialTithiDate::kind
+constexpr TithiWithName special_tithis[] = {
+    { vp::DiscreteTithi::Shukla_Panchami(), "Vasanta-pañcamī" },
+    { vp::DiscreteTithi::Shukla_Saptami(), "Ratha-saptamī" },
+    { vp::DiscreteTithi::Shukla_Ashtami(), "Bhīṣmāṣtamī" },
+    { vp::DiscreteTithi::Shukla_Navami(), "Madhva-navamī (cāndra)" },
+    { vp::DiscreteTithi::Purnima(), "Pūrṇimā, End of Māgha-snāna-vrata" },
+};
+}
+
+void vp::insert_ekadashi_paran_etc(vp::NamedDates & dates, const vp::Vrata & vrata) {
+    LocalTimeCache local_times{vrata.paran.time_zone};
+    insert_ekadashi_paran_etc(dates, vrata, local_times);
 }
 
-void insert_ekadashi_paran_etc(vp::NamedDates & dates, const vp::Vrata & vrata) {
+void vp::insert_ekadashi_paran_etc(vp::NamedDates & dates, const vp::Vrata & vrata, LocalTimeCache & local_times) {
     dates.emplace(vrata.date, vp::NamedDate{fmt::format(FMT_STRING("{} Ekādaśī"), vrata.ekadashi_name()), "", "vrata"});
     const auto day1_additional_event_name = vrata.day1_additional_event_name();
     if (!day1_additional_event_name.empty()) {
@@ -38,37 +58,47 @@ void insert_ekadashi_paran_etc(vp::NamedDates & dates, const vp::Vrata & vrata)
         dates.emplace(vrata.date + date::days{1}, vp::NamedDate{day2_additional_event_name, "", "vrata"});
     }
     // 'c' means compact formatting ("*" for standard pAraNam, otherwise something like ">06:45", "<07:45" or "06:45-07.45")
-    const auto paran = fmt::format(FMT_STRING("{:c}"), vrata.paran);
+    const auto paran = vrata.paran.compact_str(local_times);
     const auto paran_with_href = fmt::format(FMT_STRING(R"(<a href="#{}">{}</a>)"), html::escape_attribute(vrata.location_name()), html::escape_attribute(paran));
-    dates.emplace(vrata.local_paran_date(), vp::NamedDate{paran_with_href, paran_title(vrata.paran), ""});
+    dates.emplace(vrata.local_paran_date(), vp::NamedDate{paran_with_href, paran_title(vrata.paran, local_times), ""});
 }
 
-vp::NamedDates vp::nameworthy_dates_for_this_paksha(const vp::Vrata &vrata, CalcFlags flags)
+std::vector<vp::SpecialTithiDate> vp::special_tithi_dates(const vp::Vrata & vrata, CalcFlags flags)
 {
-    vp::NamedDates dates;
-    insert_ekadashi_paran_etc(dates, vrata);
+    std::vector<SpecialTithiDate> special_dates;
     if (vrata.masa == vp::Chandra_Masa::Magha && vrata.paksha == vp::Paksha::Shukla) {
         auto base_time = vrata.sunrise1 - double_days{10};
         auto calc = vp::Calc{Swe{vrata.location, flags}};
 
-        struct TithiWithName {
-            vp::DiscreteTithi tithi;
-            const char * name;
-        };
-        static TithiWithName tithis_with_name[] = {
-            { vp::DiscreteTithi::Shukla_Panchami(), "Vasanta-pañcamī" },
-            { vp::DiscreteTithi::Shukla_Saptami(), "Ratha-saptamī" },
-            { vp::DiscreteTithi::Shukla_Ashtami(), "Bhīṣmāṣtamī" },
-            { vp::DiscreteTithi::Shukla_Navami(), "Madhva-navamī (cāndra)" },
-            { vp::DiscreteTithi::Purnima(), "Pūrṇimā, End of Māgha-snāna-vrata" },
-        };
-
-        for (const auto & tithi_with_name : tithis_with_name) {
-            const auto date = calc.find_exact_tithi_date(base_time, tithi_with_name.tithi, vrata.location.time_zone());
+        for (std::size_t kind = 0; kind < std::size(special_tithis); ++kind) {
+            const auto date = calc.find_exact_tithi_date(base_time, special_tithis[kind].tithi, vrata.location.time_zone());
             if (date) {
-                dates.emplace(*date, NamedDate{tithi_with_name.name, "", "custom"});
+                special_dates.push_back(SpecialTithiDate{static_cast<std::uint8_t>(kind), *date});
             }
         }
     }
+    return special_dates;
+}
+
+bool vp::insert_special_tithi_date(vp::NamedDates & dates, vp::SpecialTithiDate special_date)
+{
+    if (special_date.kind >= std::size(special_tithis)) return false;
+    dates.emplace(special_date.date, NamedDate{special_tithis[special_date.kind].name, "", "custom"});
+    return true;
+}
+
+vp::NamedDates vp::nameworthy_dates_for_this_paksha(const vp::Vrata &vrata, CalcFlags flags, std::pmr::memory_resource * resource)
+{
+    LocalTimeCache local_times{vrata.paran.time_zone};
+    return nameworthy_dates_for_this_paksha(vrata, flags, local_times, resource);
+}
+
+vp::NamedDates vp::nameworthy_dates_for_this_paksha(const vp::Vrata &vrata, CalcFlags flags, LocalTimeCache & local_times, std::pmr::memory_resource * resource)
+{
+    vp::NamedDates dates{resource};
+    insert_ekadashi_paran_etc(dates, vrata, local_times);
+    for (const auto & special_date : special_tithi_dates(vrata, flags)) {
+        insert_special_tithi_date(dates, special_date);
+    }
     return dates;
 }
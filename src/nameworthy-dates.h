@@ -5,8 +5,32 @@
 #include "named-dates.h"
 #include "vrata.h"
 
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
 namespace vp {
-NamedDates nameworthy_dates_for_this_paksha(const Vrata & vrata, CalcFlags flags);
+NamedDates nameworthy_dates_for_this_paksha(const Vrata & vrata, CalcFlags flags, std::pmr::memory_resource * resource = std::pmr::get_default_resource());
+// Same, with local times (pāraṇam titles and the like) from the location's cache, which must be for vrata.paran.time_zone.
+NamedDates nameworthy_dates_for_this_paksha(const Vrata & vrata, CalcFlags flags, LocalTimeCache & local_times,
+                                            std::pmr::memory_resource * resource = std::pmr::get_default_resource());
+
+// Parts of nameworthy_dates_for_this_paksha(), for those who store vratas and need
+// to restore their dates later without calculating them again (see VrataDb).
+
+// Ekādaśī itself, its additional events and pāraṇam: everything that depends on the vrata only.
+void insert_ekadashi_paran_etc(NamedDates & dates, const Vrata & vrata);
+void insert_ekadashi_paran_etc(NamedDates & dates, const Vrata & vrata, LocalTimeCache & local_times);
+
+// Special tithis (like Vasanta-pañcamī) which we name in Māgha śukla pakṣa.
+struct SpecialTithiDate {
+    std::uint8_t kind; // which special tithi it is, only meaningful for insert_special_tithi_date()
+    date::local_days date;
+};
+// Empty for all vratas except the one in Māgha śukla pakṣa. Requires calculations.
+std::vector<SpecialTithiDate> special_tithi_dates(const Vrata & vrata, CalcFlags flags);
+// false if kind is unknown (e.g. comes from a file written by a different version)
+bool insert_special_tithi_date(NamedDates & dates, SpecialTithiDate special_date);
 }
 
 #endif // NAMEWORTHYDATES_H
@@ -1,5 +1,10 @@
 #include "paran.h"
 
+#include "time-format.h"
+
+#include <cassert>
+#include <cstring>
+
 namespace vp {
 
 std::string ParanFormatter::format(const Paran &paran,
@@ -12,18 +17,26 @@ std::string ParanFormatter::format(const Paran &paran,
 {
     fmt::memory_buffer buf;
     fmt::appender out{buf};
+    // default formats don't need date::format() with its iostreams
+    const auto format_zoned = [&](const char * format, const date::zoned_seconds & zoned) {
+        if (std::strcmp(format, "%H:%M:%S") == 0) {
+            format_hh_mm_ss(buf, zoned.get_local_time());
+        } else if (std::strcmp(format, "%H:%M") == 0) {
+            format_hh_mm(buf, zoned.get_local_time());
+        } else {
+            fmt::format_to(out, "{}", date::format(format, zoned));
+        }
+    };
     if (paran.paran_start.has_value()) {
         auto rounded_up = date::ceil<std::chrono::seconds>(paran.paran_start->as_sys_time());
-        auto zoned = date::make_zoned(time_zone, rounded_up);
-        fmt::format_to(out, "{}", date::format(paran_start_format, zoned));
+        format_zoned(paran_start_format, date::make_zoned(time_zone, rounded_up));
     } else {
         fmt::format_to(out, "...");
     }
     fmt::format_to(out, "{}", separator);
     if (paran.paran_end.has_value()) {
         auto rounded_down = date::floor<std::chrono::seconds>(paran.paran_end->as_sys_time());
-        auto zoned = date::make_zoned(time_zone, rounded_down);
-        fmt::format_to(out, "{}", date::format(paran_end_format, zoned));
+        format_zoned(paran_end_format, date::make_zoned(time_zone, rounded_down));
     } else {
         fmt::format_to(out, "...");
     }
@@ -35,11 +48,18 @@ std::string ParanFormatter::format(const Paran &paran,
 
 // we round to minutes unless rounded interval is less than 5 minutes long.
 bool Paran::is_rounded_to_minutes() const
+{
+    LocalTimeCache cache{time_zone};
+    return is_rounded_to_minutes(cache);
+}
+
+bool Paran::is_rounded_to_minutes(LocalTimeCache & cache) const
 {
     using namespace std::chrono_literals;
+    assert(cache.time_zone() == time_zone);
     if (!paran_start || !paran_end) return true;
-    const auto start_rounded_to_minutes = date::ceil<std::chrono::minutes>(paran_start->as_zoned_time(time_zone).get_local_time());
-    const auto end_rounded_to_minutes = date::floor<std::chrono::minutes>(paran_end->as_zoned_time(time_zone).get_local_time());
+    const auto start_rounded_to_minutes = date::ceil<std::chrono::minutes>(cache.local_time(*paran_start));
+    const auto end_rounded_to_minutes = date::floor<std::chrono::minutes>(cache.local_time(*paran_end));
     return end_rounded_to_minutes - start_rounded_to_minutes >= 5min;
 }
 
@@ -68,39 +88,84 @@ Paran::EndType Paran::end_type() const {
 }
 
 std::string Paran::start_str() const
+{
+    LocalTimeCache cache{time_zone};
+    return start_str(cache);
+}
+
+std::string Paran::start_str(LocalTimeCache & cache) const
 {
     if (!paran_start) return "…";
-    const auto local = paran_start->as_zoned_time(time_zone).get_local_time();
-    if (is_rounded_to_minutes()) {
-        return date::format("%H:%M", date::ceil<std::chrono::minutes>(local));
+    const auto local = cache.local_time(*paran_start);
+    if (is_rounded_to_minutes(cache)) {
+        return hh_mm(date::ceil<std::chrono::minutes>(local));
     } else {
-        return date::format("%H:%M:%S", date::ceil<std::chrono::seconds>(local));
+        return hh_mm_ss(date::ceil<std::chrono::seconds>(local));
     }
 }
 
 std::string Paran::start_str_seconds() const
+{
+    LocalTimeCache cache{time_zone};
+    return start_str_seconds(cache);
+}
+
+std::string Paran::start_str_seconds(LocalTimeCache & cache) const
 {
     if (!paran_start) return "…";
-    const auto local = paran_start->as_zoned_time(time_zone).get_local_time();
-    return date::format("%H:%M:%S", date::ceil<std::chrono::seconds>(local));
+    return hh_mm_ss(date::ceil<std::chrono::seconds>(cache.local_time(*paran_start)));
 }
 
 std::string Paran::end_str() const
+{
+    LocalTimeCache cache{time_zone};
+    return end_str(cache);
+}
+
+std::string Paran::end_str(LocalTimeCache & cache) const
 {
     if (!paran_end) return "…";
-    const auto local = paran_end->as_zoned_time(time_zone).get_local_time();
-    if (is_rounded_to_minutes()) {
-        return date::format("%H:%M", date::floor<std::chrono::minutes>(local));
+    const auto local = cache.local_time(*paran_end);
+    if (is_rounded_to_minutes(cache)) {
+        return hh_mm(date::floor<std::chrono::minutes>(local));
     } else {
-        return date::format("%H:%M:%S", date::floor<std::chrono::seconds>(local));
+        return hh_mm_ss(date::floor<std::chrono::seconds>(local));
     }
 }
 
 std::string Paran::end_str_seconds() const
+{
+    LocalTimeCache cache{time_zone};
+    return end_str_seconds(cache);
+}
+
+std::string Paran::end_str_seconds(LocalTimeCache & cache) const
 {
     if (!paran_end) return "…";
-    const auto local = paran_end->as_zoned_time(time_zone).get_local_time();
-    return date::format("%H:%M:%S", date::floor<std::chrono::seconds>(local));
+    return hh_mm_ss(date::floor<std::chrono::seconds>(cache.local_time(*paran_end)));
+}
+
+std::string Paran::compact_str() const
+{
+    LocalTimeCache cache{time_zone};
+    return compact_str(cache);
+}
+
+std::string Paran::compact_str(LocalTimeCache & cache) const
+{
+    assert(time_zone != nullptr);
+    if (type == Type::Standard) {
+        if (!paran_limit) return "*";
+        return fmt::format(FMT_STRING("* (<{})"), hh_mm(date::floor<std::chrono::minutes>(cache.local_time(*paran_limit))));
+    } else if (paran_start && !paran_end) {
+        return ">" + start_str(cache);
+    } else if (!paran_start && paran_end) {
+        return "<" + end_str(cache);
+    } else if (paran_start && paran_end) {
+        return start_str(cache) + "–" + end_str(cache);
+    } else {
+        return fmt::format("{}", *this);
+    }
 }
 
 } // namespace vp
@@ -7,6 +7,7 @@
 #include <optional>
 #include <string_view>
 #include <tuple>
+#include "time-format.h"
 #include "tz-fixed.h"
 
 namespace vp {
@@ -53,11 +54,20 @@ public:
     bool operator!=(Paran const &other) const {
         return !(*this == other);
     }
+    // Local times use the cache when given one (for this->time_zone), otherwise a fresh one per call.
     std::string start_str() const;
+    std::string start_str(LocalTimeCache & cache) const;
     std::string start_str_seconds() const;
+    std::string start_str_seconds(LocalTimeCache & cache) const;
     std::string end_str() const;
+    std::string end_str(LocalTimeCache & cache) const;
     std::string end_str_seconds() const;
+    std::string end_str_seconds(LocalTimeCache & cache) const;
     bool is_rounded_to_minutes() const;
+    bool is_rounded_to_minutes(LocalTimeCache & cache) const;
+    // same as fmt::format("{:c}", paran)
+    std::string compact_str() const;
+    std::string compact_str(LocalTimeCache & cache) const;
     StartType start_type() const;
     EndType end_type() const;
 
@@ -115,23 +125,7 @@ struct fmt::formatter<vp::Paran> : fmt::formatter<std::string_view> {
 
     template<typename FormatCtx>
     auto format_compact(const vp::Paran & p, FormatCtx & ctx) {
-        assert(p.time_zone != nullptr);
-        if (p.type == vp::Paran::Type::Standard) {
-            fmt::format_to(ctx.out(), "*");
-            if (p.paran_limit) {
-                const auto local = p.paran_limit->as_zoned_time(p.time_zone).get_local_time();
-                fmt::format_to(ctx.out(), FMT_STRING(" (<{})"), date::format("%H:%M", date::floor<std::chrono::minutes>(local)));
-            }
-            return ctx.out();
-        } else if (p.paran_start && !p.paran_end) {
-            return fmt::format_to(ctx.out(), ">{}", p.start_str());
-        } else if (!p.paran_start && p.paran_end) {
-            return fmt::format_to(ctx.out(), "<{}", p.end_str());
-        } else if (p.paran_start && p.paran_end) {
-            return fmt::format_to(ctx.out(), "{}–{}", p.start_str(), p.end_str());
-        } else {
-            return format_default(p, ctx);
-        }
+        return fmt::format_to(ctx.out(), "{}", p.compact_str());
     }
 
     template<typename FormatCtx>
@@ -0,0 +1,365 @@
+#include "place-db.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace vp {
+
+namespace {
+constexpr char magic[4] = {'V', 'P', 'P', 'L'};
+constexpr std::uint32_t byte_order_mark = 0x01020304;
+constexpr std::uint64_t section_alignment = 8;
+
+constexpr std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+// Mapped memory has no objects of our types in it, so copy them out instead of casting pointers.
+template<typename T>
+T read_at(const unsigned char * base, std::uint64_t offset, std::size_t index) {
+    T value;
+    std::memcpy(&value, base + offset + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+bool section_fits(std::uint64_t offset, std::uint64_t count, std::uint64_t element_size, std::size_t file_size) {
+    if (offset % section_alignment != 0 || offset > file_size) return false;
+    return count <= (file_size - offset) / element_size;
+}
+
+// FNV-1a
+std::uint32_t name_hash(std::string_view name) {
+    std::uint32_t hash = 2166136261u;
+    for (const char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+unsigned char folded(char c) {
+    const auto u = static_cast<unsigned char>(c);
+    return (u >= 'A' && u <= 'Z') ? static_cast<unsigned char>(u - 'A' + 'a') : u;
+}
+
+// Like std::string_view::compare(), with ASCII letters lowercased
+int compare_folded(std::string_view one, std::string_view other) {
+    const auto length = std::min(one.size(), other.size());
+    for (std::size_t i = 0; i < length; ++i) {
+        const auto a = folded(one[i]);
+        const auto b = folded(other[i]);
+        if (a != b) return a < b ? -1 : 1;
+    }
+    if (one.size() == other.size()) return 0;
+    return one.size() < other.size() ? -1 : 1;
+}
+
+bool starts_with_folded(std::string_view name, std::string_view prefix) {
+    return name.size() >= prefix.size() && compare_folded(name.substr(0, prefix.size()), prefix) == 0;
+}
+
+using Point = std::array<double, 3>;
+
+// Euclidean distance between unit vectors grows with great-circle distance, so k-d tree can use them.
+Point unit_vector(double latitude, double longitude) {
+    constexpr double degrees_to_radians = 3.14159265358979323846 / 180.0;
+    const double lat = latitude * degrees_to_radians;
+    const double lng = longitude * degrees_to_radians;
+    return Point{std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat)};
+}
+
+double squared_distance(const Point & one, const Point & other) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < one.size(); ++i) {
+        sum += (one[i] - other[i]) * (one[i] - other[i]);
+    }
+    return sum;
+}
+} // anonymous namespace
+
+std::optional<PlaceDb> PlaceDb::open(const fs::path & path)
+{
+    auto file = MappedFile::open(path);
+    if (!file || file->size() < sizeof(Header)) return std::nullopt;
+    const auto header = read_at<Header>(file->data(), 0, 0);
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+            || header.version != Version
+            || header.byte_order_mark != byte_order_mark) {
+        return std::nullopt;
+    }
+    const auto size = file->size();
+    if (header.hash_slot_count == 0 || (header.hash_slot_count & (header.hash_slot_count - 1)) != 0
+            || header.hash_slot_count <= header.place_count
+            || !section_fits(header.places_offset, header.place_count, sizeof(PlaceEntry), size)
+            || !section_fits(header.hash_offset, header.hash_slot_count, sizeof(std::uint32_t), size)
+            || !section_fits(header.tree_offset, header.place_count, sizeof(std::uint32_t), size)
+            || !section_fits(header.strings_offset, header.strings_size, 1, size)) {
+        return std::nullopt;
+    }
+    PlaceDb db{std::move(*file)};
+    db.header_ = header;
+    return db;
+}
+
+PlaceDb::PlaceDb(MappedFile file) : file_(std::move(file))
+{}
+
+PlaceDb::PlaceEntry PlaceDb::entry(std::size_t index) const
+{
+    return read_at<PlaceEntry>(file_.data(), header_.places_offset, index);
+}
+
+std::uint32_t PlaceDb::hash_slot(std::size_t index) const
+{
+    return read_at<std::uint32_t>(file_.data(), header_.hash_offset, index);
+}
+
+std::uint32_t PlaceDb::tree_node(std::size_t index) const
+{
+    return read_at<std::uint32_t>(file_.data(), header_.tree_offset, index);
+}
+
+std::string_view PlaceDb::string_at(std::uint32_t offset, std::size_t length) const
+{
+    // Entries are only checked when they are read, so that open() stays O(1). Broken ones read as empty strings.
+    if (std::uint64_t{offset} + length > header_.strings_size) return {};
+    const auto * strings = reinterpret_cast<const char *>(file_.data() + header_.strings_offset);
+    return std::string_view{strings + offset, length};
+}
+
+Location PlaceDb::place(std::size_t index) const
+{
+    const auto e = entry(index);
+    Location location{Latitude{e.latitude}, Longitude{e.longitude}};
+    location.name = string_at(e.name_offset, e.name_length);
+    location.time_zone_name = string_at(e.time_zone_offset, e.time_zone_length);
+    location.country = string_at(e.country_offset, e.country_length);
+    return location;
+}
+
+std::optional<Location> PlaceDb::find(std::string_view name) const
+{
+    const auto mask = header_.hash_slot_count - 1;
+    // A valid file always has an empty slot (hash_slot_count > place_count), the probe limit is for broken ones.
+    auto slot = name_hash(name) & mask;
+    for (std::size_t probes = 0; probes < header_.hash_slot_count; ++probes, slot = (slot + 1) & mask) {
+        const auto value = hash_slot(slot);
+        if (value == 0 || value > header_.place_count) return std::nullopt;
+        const auto e = entry(value - 1);
+        if (string_at(e.name_offset, e.name_length) == name) return place(value - 1);
+    }
+    return std::nullopt;
+}
+
+std::vector<Location> PlaceDb::find_by_prefix(std::string_view prefix, std::size_t max_count) const
+{
+    // lower_bound by folded name
+    std::size_t first = 0;
+    std::size_t count = size();
+    while (count > 0) {
+        const auto step = count / 2;
+        const auto e = entry(first + step);
+        if (compare_folded(string_at(e.name_offset, e.name_length), prefix) < 0) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    std::vector<Location> found;
+    for (auto i = first; i < size() && found.size() < max_count; ++i) {
+        const auto e = entry(i);
+        if (!starts_with_folded(string_at(e.name_offset, e.name_length), prefix)) break;
+        found.push_back(place(i));
+    }
+    return found;
+}
+
+std::optional<Location> PlaceDb::find_nearest(Coord coord) const
+{
+    if (size() == 0) return std::nullopt;
+    const auto target = unit_vector(coord.latitude.latitude, coord.longitude.longitude);
+    std::size_t best = 0;
+    double best_distance = std::numeric_limits<double>::max();
+    // Node of the [lo, hi) range is its middle, left half has smaller coordinates along the axis, right half bigger ones.
+    const auto search = [&](const auto & self, std::size_t lo, std::size_t hi, std::size_t axis) -> void {
+        if (lo >= hi) return;
+        const auto mid = lo + (hi - lo) / 2;
+        const auto index = tree_node(mid);
+        if (index >= size()) return; // broken file
+        const auto e = entry(index);
+        const auto point = unit_vector(e.latitude, e.longitude);
+        if (const auto distance = squared_distance(point, target); distance < best_distance) {
+            best_distance = distance;
+            best = index;
+        }
+        const double diff = target[axis] - point[axis];
+        const auto next_axis = (axis + 1) % 3;
+        if (diff < 0) {
+            self(self, lo, mid, next_axis);
+            if (diff * diff < best_distance) self(self, mid + 1, hi, next_axis);
+        } else {
+            self(self, mid + 1, hi, next_axis);
+            if (diff * diff < best_distance) self(self, lo, mid, next_axis);
+        }
+    };
+    search(search, 0, size(), 0);
+    return place(best);
+}
+
+bool PlaceDbWriter::add(const Location & location)
+{
+    if (location.name.size() > std::numeric_limits<std::uint16_t>::max()
+            || location.time_zone_name.size() > std::numeric_limits<std::uint8_t>::max()
+            || location.country.size() > std::numeric_limits<std::uint8_t>::max()) {
+        return false;
+    }
+    places_.push_back(PendingPlace{std::string{location.name}, std::string{location.time_zone_name}, std::string{location.country},
+                                   location.latitude.latitude, location.longitude.longitude});
+    return true;
+}
+
+std::size_t PlaceDbWriter::add_geonames(std::istream & in)
+{
+    // columns of the GeoNames "geoname" table that we need
+    constexpr std::size_t name_column = 1;
+    constexpr std::size_t latitude_column = 4;
+    constexpr std::size_t longitude_column = 5;
+    constexpr std::size_t country_code_column = 8;
+    constexpr std::size_t time_zone_column = 17;
+
+    std::size_t added = 0;
+    std::string line;
+    std::vector<std::string_view> columns;
+    while (std::getline(in, line)) {
+        columns.clear();
+        std::string_view rest{line};
+        for (auto tab = rest.find('\t'); tab != std::string_view::npos; tab = rest.find('\t')) {
+            columns.push_back(rest.substr(0, tab));
+            rest.remove_prefix(tab + 1);
+        }
+        columns.push_back(rest);
+        if (columns.size() <= time_zone_column) continue;
+
+        const auto parse_degrees = [](std::string_view text) -> std::optional<double> {
+            const std::string s{text};
+            char * end = nullptr;
+            const double value = std::strtod(s.c_str(), &end);
+            if (s.empty() || end != s.c_str() + s.size()) return std::nullopt;
+            return value;
+        };
+        const auto latitude = parse_degrees(columns[latitude_column]);
+        const auto longitude = parse_degrees(columns[longitude_column]);
+        if (!latitude || !longitude || columns[name_column].empty() || columns[time_zone_column].empty()) continue;
+
+        Location location{Latitude{*latitude}, Longitude{*longitude}};
+        location.name = columns[name_column];
+        location.time_zone_name = columns[time_zone_column];
+        location.country = columns[country_code_column];
+        if (add(location)) ++added;
+    }
+    return added;
+}
+
+void PlaceDbWriter::write(const fs::path & path) const
+{
+    std::vector<std::uint32_t> order(places_.size());
+    std::iota(order.begin(), order.end(), std::uint32_t{0});
+    std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        const int folded_order = compare_folded(places_[a].name, places_[b].name);
+        if (folded_order != 0) return folded_order < 0;
+        return places_[a].name < places_[b].name;
+    });
+
+    std::string strings;
+    std::unordered_map<std::string, std::uint32_t> string_offsets;
+    const auto add_string = [&](const std::string & s) {
+        const auto [it, inserted] = string_offsets.emplace(s, static_cast<std::uint32_t>(strings.size()));
+        if (inserted) strings += s;
+        return it->second;
+    };
+    std::vector<PlaceDb::PlaceEntry> entries;
+    entries.reserve(order.size());
+    for (const auto i : order) {
+        const auto & place = places_[i];
+        PlaceDb::PlaceEntry entry{};
+        entry.name_offset = add_string(place.name);
+        entry.time_zone_offset = add_string(place.time_zone);
+        entry.country_offset = add_string(place.country);
+        entry.name_length = static_cast<std::uint16_t>(place.name.size());
+        entry.time_zone_length = static_cast<std::uint8_t>(place.time_zone.size());
+        entry.country_length = static_cast<std::uint8_t>(place.country.size());
+        entry.latitude = place.latitude;
+        entry.longitude = place.longitude;
+        entries.push_back(entry);
+    }
+
+    // at most half full, so that probe sequences stay short
+    std::uint32_t slot_count = 1;
+    while (slot_count < 2 * entries.size() + 1) slot_count *= 2;
+    std::vector<std::uint32_t> slots(slot_count);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const auto & name = places_[order[i]].name;
+        auto slot = name_hash(name) & (slot_count - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = static_cast<std::uint32_t>(i + 1);
+    }
+
+    std::vector<std::uint32_t> tree(entries.size());
+    std::iota(tree.begin(), tree.end(), std::uint32_t{0});
+    std::vector<Point> points;
+    points.reserve(entries.size());
+    for (const auto & entry : entries) {
+        points.push_back(unit_vector(entry.latitude, entry.longitude));
+    }
+    const auto build = [&](const auto & self, std::size_t lo, std::size_t hi, std::size_t axis) -> void {
+        if (hi - lo <= 1) return;
+        const auto mid = lo + (hi - lo) / 2;
+        const auto begin = tree.begin() + static_cast<std::ptrdiff_t>(lo);
+        std::nth_element(begin, tree.begin() + static_cast<std::ptrdiff_t>(mid), tree.begin() + static_cast<std::ptrdiff_t>(hi),
+                         [&](std::uint32_t a, std::uint32_t b) { return points[a][axis] < points[b][axis]; });
+        self(self, lo, mid, (axis + 1) % 3);
+        self(self, mid + 1, hi, (axis + 1) % 3);
+    };
+    build(build, 0, tree.size(), 0);
+
+    PlaceDb::Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = PlaceDb::Version;
+    header.byte_order_mark = byte_order_mark;
+    header.place_count = static_cast<std::uint32_t>(entries.size());
+    header.hash_slot_count = slot_count;
+    header.strings_size = static_cast<std::uint32_t>(strings.size());
+    header.places_offset = align_up(sizeof(header));
+    header.hash_offset = align_up(header.places_offset + entries.size() * sizeof(PlaceDb::PlaceEntry));
+    header.tree_offset = align_up(header.hash_offset + slots.size() * sizeof(std::uint32_t));
+    header.strings_offset = align_up(header.tree_offset + tree.size() * sizeof(std::uint32_t));
+
+    std::ofstream f{path, std::ios::binary | std::ios::trunc};
+    const auto write_section = [&f](std::uint64_t offset, const void * data, std::size_t size) {
+        // zero padding up to the section start
+        static constexpr char zeros[section_alignment] = {};
+        const auto current = static_cast<std::uint64_t>(f.tellp());
+        f.write(zeros, static_cast<std::streamsize>(offset - current));
+        f.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+    write_section(0, &header, sizeof(header));
+    write_section(header.places_offset, entries.data(), entries.size() * sizeof(PlaceDb::PlaceEntry));
+    write_section(header.hash_offset, slots.data(), slots.size() * sizeof(std::uint32_t));
+    write_section(header.tree_offset, tree.data(), tree.size() * sizeof(std::uint32_t));
+    write_section(header.strings_offset, strings.data(), strings.size());
+    if (!f) {
+        throw std::runtime_error("can't write place db file " + path.string());
+    }
+}
+
+} // namespace vp
@@ -0,0 +1,111 @@
+#ifndef VP_PLACE_DB_H
+#define VP_PLACE_DB_H
+
+#include "filesystem-fixed.h"
+#include "location.h"
+#include "mapped-file.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vp {
+
+/* Large set of named places (e.g. from GeoNames) in a memory-mapped file, for
+ * when built-in LocationDb is not enough. open() only checks the header and section bounds,
+ * entries are parsed and bounds-checked as they are looked up, so hundreds of thousands of
+ * places cost nothing until then.
+ *
+ * File layout (native byte order, every section starts at a multiple of 8):
+ *   Header
+ *   PlaceEntry[place_count], sorted by name with ASCII letters lowercased (for prefix search)
+ *   std::uint32_t[hash_slot_count]: open addressing hash table by exact name,
+ *                                  entry index + 1 (0 for empty slots), linear probing
+ *   std::uint32_t[place_count]: entry indexes in implicit k-d tree order (median of each range
+ *                               is the node, split axes x, y, z of the unit vector in turn)
+ *   strings: names, time zones and countries (UTF-8, not zero-terminated, repeated ones stored once)
+ * Bump Version whenever the layout or meaning of any field changes.
+ *
+ * Locations returned point into the mapped file: they are valid as long as the PlaceDb is.
+ */
+class PlaceDb {
+public:
+    static constexpr std::uint32_t Version = 1;
+    // looked up in the data dir (see text_ui::change_to_data_dir())
+    static constexpr const char * DefaultFileName = "places.vpplaces";
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byte_order_mark; // 0x01020304 written in native byte order
+        std::uint32_t place_count;
+        std::uint32_t hash_slot_count; // power of two
+        std::uint32_t strings_size;
+        std::uint64_t places_offset;
+        std::uint64_t hash_offset;
+        std::uint64_t tree_offset;
+        std::uint64_t strings_offset;
+    };
+    struct PlaceEntry {
+        std::uint32_t name_offset; // within strings section
+        std::uint32_t time_zone_offset;
+        std::uint32_t country_offset;
+        std::uint16_t name_length;
+        std::uint8_t time_zone_length;
+        std::uint8_t country_length;
+        double latitude;
+        double longitude;
+    };
+
+    // nullopt if the file is missing, truncated or written by a different version
+    static std::optional<PlaceDb> open(const fs::path & path);
+
+    std::size_t size() const { return header_.place_count; }
+    Location place(std::size_t index) const;
+    // Exact (case-sensitive) name match, O(1). Any one of them if there are several places with that name.
+    std::optional<Location> find(std::string_view name) const;
+    // Up to max_count places with names starting with prefix (ASCII letters are case-insensitive), in name order.
+    std::vector<Location> find_by_prefix(std::string_view prefix, std::size_t max_count) const;
+    // Closest place by great-circle distance, nullopt only for an empty db.
+    std::optional<Location> find_nearest(Coord coord) const;
+
+private:
+    explicit PlaceDb(MappedFile file);
+    PlaceEntry entry(std::size_t index) const;
+    std::uint32_t hash_slot(std::size_t index) const;
+    std::uint32_t tree_node(std::size_t index) const;
+    std::string_view string_at(std::uint32_t offset, std::size_t length) const;
+
+    MappedFile file_;
+    Header header_{};
+};
+
+// Collects places and writes them out in the PlaceDb format.
+class PlaceDbWriter {
+public:
+    // Strings are copied. Names longer than 65535 bytes and time zones and countries longer than 255 are rejected.
+    bool add(const Location & location);
+    // Adds places from GeoNames dump lines (tab-separated "geoname" table, e.g. cities15000.txt),
+    // with country codes as countries. Returns the number of places added; malformed lines are skipped.
+    std::size_t add_geonames(std::istream & in);
+    std::size_t size() const { return places_.size(); }
+    // throws std::runtime_error if the file can't be written
+    void write(const fs::path & path) const;
+
+private:
+    struct PendingPlace {
+        std::string name;
+        std::string time_zone;
+        std::string country;
+        double latitude;
+        double longitude;
+    };
+    std::vector<PendingPlace> places_;
+};
+
+} // namespace vp
+
+#endif // VP_PLACE_DB_H
@@ -0,0 +1,134 @@
+#include "catch-formatters.h"
+
+#include "place-db.h"
+#include "temp-files.h"
+#include "text-interface.h"
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+// a few lines in GeoNames dump format, with a malformed one (no time zone column)
+const char * const geonames_lines =
+        "1254163\tUdupi\tUdupi\t\t13.34083\t74.74214\tP\tPPLA2\tIN\t\t19\t\t\t\t144960\t\t27\tAsia/Kolkata\t2020-06-10\n"
+        "703448\tKyiv\tKyiv\tKiev\t50.45466\t30.5238\tP\tPPLC\tUA\t\t12\t\t\t\t2797553\t\t187\tEurope/Kyiv\t2022-11-18\n"
+        "6167865\tToronto\tToronto\t\t43.70011\t-79.4163\tP\tPPLA\tCA\t\t08\t\t\t\t2600000\t\t175\tAmerica/Toronto\t2021-10-19\n"
+        "6167863\tTorbay\tTorbay\t\t47.66659\t-52.73135\tP\tPPL\tCA\t\t05\t\t\t\t7397\t\t168\tAmerica/St_Johns\t2019-08-21\n"
+        "2172517\tCairns\tCairns\t\t-16.92366\t145.76613\tP\tPPLA2\tAU\t\t04\t\t\t\t154225\t\t6\tAustralia/Brisbane\t2019-07-18\n"
+        "0\tBroken\tBroken\t\tnot-a-number\t1.0\tP\tPPL\tXX\n";
+
+const fs::path & test_db_path() {
+    static const test_files::TempFile file = [] {
+        test_files::TempFile f{"place-db-test", ".vpplaces"};
+        vp::PlaceDbWriter writer;
+        std::istringstream in{geonames_lines};
+        writer.add_geonames(in);
+        writer.add(vp::Location{vp::Latitude{-54.8}, vp::Longitude{-68.3}, "ushuaia", "America/Argentina/Ushuaia", "AR"});
+        writer.write(f.path());
+        return f;
+    }();
+    return file.path();
+}
+}
+
+TEST_CASE("PlaceDb finds places by exact name") {
+    const auto db = vp::PlaceDb::open(test_db_path());
+    REQUIRE(db.has_value());
+    REQUIRE(db->size() == 6);
+
+    const auto kyiv = db->find("Kyiv");
+    REQUIRE(kyiv.has_value());
+    REQUIRE(kyiv->name == "Kyiv");
+    REQUIRE(kyiv->time_zone_name == "Europe/Kyiv");
+    REQUIRE(kyiv->country == "UA");
+    REQUIRE(kyiv->latitude.latitude == 50.45466);
+    REQUIRE(kyiv->longitude.longitude == 30.5238);
+
+    REQUIRE_FALSE(db->find("kyiv").has_value());
+    REQUIRE_FALSE(db->find("Broken").has_value());
+    REQUIRE_FALSE(db->find("").has_value());
+}
+
+TEST_CASE("PlaceDb finds places by case-insensitive name prefix, in name order") {
+    const auto db = vp::PlaceDb::open(test_db_path());
+    REQUIRE(db.has_value());
+
+    const auto found = db->find_by_prefix("tOR", 10);
+    REQUIRE(found.size() == 2);
+    REQUIRE(found[0].name == "Torbay");
+    REQUIRE(found[1].name == "Toronto");
+    REQUIRE(db->find_by_prefix("tor", 1).size() == 1);
+    REQUIRE(db->find_by_prefix("U", 10).size() == 2);
+    REQUIRE(db->find_by_prefix("", 100).size() == db->size());
+    REQUIRE(db->find_by_prefix("Zz", 10).empty());
+}
+
+TEST_CASE("PlaceDb finds the nearest place") {
+    const auto db = vp::PlaceDb::open(test_db_path());
+    REQUIRE(db.has_value());
+
+    const auto near = [&](double latitude, double longitude) {
+        const auto place = db->find_nearest(vp::Coord{vp::Latitude{latitude}, vp::Longitude{longitude}});
+        REQUIRE(place.has_value());
+        return std::string{place->name};
+    };
+    REQUIRE(near(13.0, 75.0) == "Udupi");
+    REQUIRE(near(49.0, 31.0) == "Kyiv");
+    REQUIRE(near(44.0, -79.0) == "Toronto");
+    REQUIRE(near(47.0, -53.0) == "Torbay");
+    // across the antimeridian
+    REQUIRE(near(-17.0, -179.0) == "Cairns");
+    REQUIRE(near(-89.0, 0.0) == "ushuaia");
+}
+
+TEST_CASE("PlaceDb::open() rejects missing and foreign files") {
+    REQUIRE_FALSE(vp::PlaceDb::open(test_files::unique_temp_path("no-such-file", ".vpplaces")).has_value());
+
+    const test_files::TempFile not_a_db{"place-db-test-not-a-db", ".vpplaces"};
+    test_files::write_not_a_db(not_a_db.path());
+    REQUIRE_FALSE(vp::PlaceDb::open(not_a_db.path()).has_value());
+}
+
+TEST_CASE("PlaceDb reads entries pointing outside the file as empty") {
+    const test_files::TempFile broken{"place-db-test-broken", ".vpplaces"};
+    const auto & path = broken.path();
+    fs::copy_file(test_db_path(), path);
+    {
+        vp::PlaceDb::Header header;
+        std::fstream f{path, std::ios::binary | std::ios::in | std::ios::out};
+        f.read(reinterpret_cast<char *>(&header), sizeof(header));
+        // first entry's name far past the strings section
+        const std::uint32_t broken_offset = 0xFFFFFF00u;
+        f.seekp(static_cast<std::streamoff>(header.places_offset + offsetof(vp::PlaceDb::PlaceEntry, name_offset)));
+        f.write(reinterpret_cast<const char *>(&broken_offset), sizeof(broken_offset));
+    }
+    {
+        const auto db = vp::PlaceDb::open(path);
+        REQUIRE(db.has_value());
+        REQUIRE(db->place(0).name.empty());
+        REQUIRE(db->find("Kyiv").has_value());
+        REQUIRE(db->find_by_prefix("", 100).size() == db->size());
+    }
+}
+
+TEST_CASE("LocationDb looks up places missing from built-in locations in the place db") {
+    REQUIRE_FALSE(vp::text_ui::LocationDb::find_coord("Cairns").has_value());
+    const test_files::UseDbGuard guard{vp::text_ui::use_place_db};
+    REQUIRE(vp::text_ui::use_place_db(test_db_path()));
+
+    const auto cairns = vp::text_ui::LocationDb::find_coord("Cairns");
+    REQUIRE(cairns.has_value());
+    REQUIRE(cairns->time_zone_name == "Australia/Brisbane");
+    // built-in ones take precedence
+    REQUIRE(vp::text_ui::LocationDb::find_coord("Udupi")->latitude == vp::udupi_coord.latitude);
+    const auto found = vp::text_ui::LocationDb::find_by_prefix("udu", 10);
+    REQUIRE(found.size() == 2);
+    REQUIRE(found[0] == vp::udupi_coord);
+    REQUIRE(vp::text_ui::LocationDb::find_nearest(vp::Coord{vp::Latitude{-16.0}, vp::Longitude{146.0}}).name == "Cairns");
+    REQUIRE(vp::text_ui::LocationDb::find_nearest(vp::Coord{vp::Latitude{13.35}, vp::Longitude{74.76}}) == vp::udupi_coord);
+
+    vp::text_ui::use_place_db({});
+    REQUIRE_FALSE(vp::text_ui::LocationDb::find_coord("Cairns").has_value());
+}
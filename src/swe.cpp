@@ -3,7 +3,11 @@
 #include "location.h"
 
 #include <array>
+#include <atomic>
+#include <cmath>
 #include <exception>
+#include <optional>
+#include <string>
 #include "swephexp.h"
 
 namespace vp {
@@ -13,24 +17,46 @@ constexpr int32 ayanamsha = SE_SIDM_LAHIRI;
 
 constexpr double atmospheric_pressure = 1013.25;
 constexpr double atmospheric_temperature = 15;
+
+std::string & ephemeris_path() {
+    static std::string path{"eph"};
+    return path;
+}
+
+std::atomic<bool> & embedded_ephemeris_enabled() {
+    static std::atomic<bool> enabled{true};
+    return enabled;
+}
+
+// sweph state is per thread. It's kept between Swe objects, so that the next one
+// doesn't have to reopen ephemeris files and parse their headers again
+// (swe_set_ephe_path() and swe_close() both drop them).
+struct SwephThreadState {
+    std::optional<std::string> ephemeris_path;
+    ~SwephThreadState() {
+        if (ephemeris_path) swe_close();
+    }
+};
+thread_local SwephThreadState sweph_thread_state;
 }
 
 tl::expected<JulDays_UT, CalcError> Swe::do_rise_trans(int rise_or_set, JulDays_UT after) const {
     int32 rsmi = rise_or_set | rise_flags;
+    const int32 ephemeris = rise_ephemeris_flags(after);
     std::array<double, 3> geopos{location.longitude.longitude, location.latitude.latitude, 0.0};
     double trise;
     std::array<char, AS_MAXCH> serr;
     int res_flag = swe_rise_trans(after.raw_julian_days_ut().count(),
                                   SE_SUN,
                                   nullptr,
-                                  ephemeris_flags,
+                                  ephemeris,
                                   rsmi,
                                   geopos.data(),
                                   detail::atmospheric_pressure,
                                   detail::atmospheric_temperature,
                                   &trise, serr.data());
     if (res_flag == -1) {
-        throw_on_wrong_flags(-1, ephemeris_flags, serr.data());
+        throw_on_wrong_flags(-1, ephemeris, serr.data());
     }
 
     if (res_flag == -2) {
@@ -73,10 +99,14 @@ Swe::Swe(const Location & coord_, CalcFlags flags):location(coord_), calc_flags(
 {
     rise_flags = get_rise_flags(flags);
     ephemeris_flags = calc_ephemeris_flags(flags);
+    if (ephemeris_flags == SEFLG_SWIEPH && detail::embedded_ephemeris_enabled()) embedded = EmbeddedEphemeris::get();
 
-    // have to use (non-const) char array due to swe_set_ephe_path() strang signature: char * instead of const char *.
-    char ephepath[] = "eph";
-    swe_set_ephe_path(ephepath);
+    auto & thread_ephemeris_path = detail::sweph_thread_state.ephemeris_path;
+    if (thread_ephemeris_path != detail::ephemeris_path()) {
+        // have to use (non-const) char array due to swe_set_ephe_path() strang signature: char * instead of const char *.
+        swe_set_ephe_path(detail::ephemeris_path().data());
+        thread_ephemeris_path = detail::ephemeris_path();
+    }
     swe_set_topo(location.longitude.longitude, location.latitude.latitude, 0);
 
     swe_set_sid_mode(
@@ -85,21 +115,36 @@ Swe::Swe(const Location & coord_, CalcFlags flags):location(coord_), calc_flags(
         0/*ayan_t0, unused since predefined mode is given as first argument*/);
 }
 
-Swe::~Swe()
+void Swe::set_ephemeris_path(std::string path)
 {
-    if (need_to_close) {
-        swe_close();
-    }
+    detail::ephemeris_path() = std::move(path);
+}
+
+void Swe::use_embedded_ephemeris(bool use)
+{
+    detail::embedded_ephemeris_enabled() = use;
 }
 
+// sweph is closed when the thread ends, see SwephThreadState
+Swe::~Swe() = default;
+
 Swe::Swe(Swe && other) noexcept
 {
-    need_to_close = false;
-    std::swap(need_to_close, other.need_to_close);
     std::swap(location, other.location);
     std::swap(calc_flags, other.calc_flags);
     std::swap(rise_flags, other.rise_flags);
     std::swap(ephemeris_flags, other.ephemeris_flags);
+    std::swap(embedded, other.embedded);
+}
+
+const EmbeddedEphemeris * Swe::embedded_for(JulDays_UT time) const
+{
+    return (embedded && embedded->covers(time)) ? embedded : nullptr;
+}
+
+int32_t Swe::rise_ephemeris_flags(JulDays_UT time) const
+{
+    return embedded_for(time) ? SEFLG_MOSEPH : ephemeris_flags;
 }
 
 tl::expected<JulDays_UT, CalcError> Swe::find_sunrise(JulDays_UT after) const
@@ -203,8 +248,52 @@ void Swe::do_calc_ut(double jd, int planet, int flags, double *res) const {
     throw_on_wrong_flags(res_flags, flags, serr);
 }
 
+namespace {
+Tithi tithi_from_longitudes(double sun, double moon) {
+    double diff = moon - sun;
+    if (diff < 0) diff += 360.0;
+    return Tithi{diff / (360.0/30)};
+}
+
+Nakshatra nakshatra_from_moon_longitude(Nirayana_Longitude moon_longitude_sidereal) {
+    return Nakshatra{moon_longitude_sidereal.longitude * (27.0/360.0)};
+}
+
+// Without SEFLG_NONUT this is the "true" ayanāṃśa (with nutation), matching the true equinox
+// of date of tropical positions. Sidereal positions from swe_calc_ut() with SEFLG_SIDEREAL use
+// mean equinox and mean ayanāṃśa instead: nutation cancels out, but not quite to the last bit,
+// so all sidereal longitudes are tropical ones minus this, for evaluate() and the rest to agree.
+double true_ayanamsha(double jd, int32_t ephemeris_flags) {
+    double ayanamsha;
+    std::array<char, AS_MAXCH> serr;
+    if (swe_get_ayanamsa_ex_ut(jd, ephemeris_flags, &ayanamsha, serr.data()) == ERR) {
+        throw std::runtime_error(serr.data());
+    }
+    return ayanamsha;
+}
+
+Nirayana_Longitude sidereal_from_tropical(double longitude, double ayanamsha) {
+    double sidereal = std::fmod(longitude - ayanamsha, 360.0);
+    if (sidereal < 0) sidereal += 360.0;
+    // adding 360 to tiny negative values gives exactly 360.0
+    if (sidereal >= 360.0) sidereal -= 360.0;
+    return Nirayana_Longitude{sidereal};
+}
+
+double tropical_from_sidereal(double longitude, double ayanamsha) {
+    return std::fmod(longitude + ayanamsha, 360.0);
+}
+
+// Embedded tables are sidereal, so the other way around: tropical is sidereal plus the "true" ayanāṃśa.
+// One body and the ayanāṃśa, which is all get_sun_longitude() and get_moon_longitude() need.
+double embedded_tropical_longitude(const EmbeddedEphemeris::Series & body, JulDays_UT time) {
+    return tropical_from_sidereal(body.longitude(time), true_ayanamsha(time.raw_julian_days_ut().count(), SEFLG_MOSEPH));
+}
+}
+
 double Swe::get_sun_longitude(JulDays_UT time) const
 {
+    if (const auto * e = embedded_for(time)) return embedded_tropical_longitude(e->sun, time);
     double res[6];
     do_calc_ut(time.raw_julian_days_ut().count(), SE_SUN, ephemeris_flags, res);
     return res[0];
@@ -212,6 +301,7 @@ double Swe::get_sun_longitude(JulDays_UT time) const
 
 double Swe::get_moon_longitude(JulDays_UT time) const
 {
+    if (const auto * e = embedded_for(time)) return embedded_tropical_longitude(e->moon, time);
     double res[6];
     do_calc_ut(time.raw_julian_days_ut().count(), SE_MOON, ephemeris_flags, res);
     return res[0];
@@ -220,31 +310,71 @@ double Swe::get_moon_longitude(JulDays_UT time) const
 /** Get tithi as double [0..30) */
 Tithi Swe::get_tithi(JulDays_UT time) const
 {
-    double sun = get_sun_longitude(time);
-    double moon = get_moon_longitude(time);
-    double diff = moon - sun;
-    if (diff < 0) diff += 360.0;
-    return Tithi{diff / (360.0/30)};
+    // ayanāṃśa cancels out
+    if (const auto * e = embedded_for(time)) return tithi_from_longitudes(e->sun.longitude(time), e->moon.longitude(time));
+    return tithi_from_longitudes(get_sun_longitude(time), get_moon_longitude(time));
 }
 
-Nirayana_Longitude Swe::get_moon_longitude_sidereal(JulDays_UT time) const
+Nirayana_Longitude Swe::sweph_sidereal_longitude(JulDays_UT time, int planet) const
 {
+    const double jd = time.raw_julian_days_ut().count();
     double res[6];
-    do_calc_ut(time.raw_julian_days_ut().count(), SE_MOON, ephemeris_flags | SEFLG_SIDEREAL, res);
-    return Nirayana_Longitude{res[0]};
+    do_calc_ut(jd, planet, ephemeris_flags, res);
+    return sidereal_from_tropical(res[0], true_ayanamsha(jd, ephemeris_flags));
+}
+
+Nirayana_Longitude Swe::get_moon_longitude_sidereal(JulDays_UT time) const
+{
+    if (const auto * e = embedded_for(time)) return Nirayana_Longitude{e->moon.longitude(time)};
+    return sweph_sidereal_longitude(time, SE_MOON);
 }
 
 Nakshatra Swe::get_nakshatra(JulDays_UT time) const
 {
-    const auto moon_longitude_sidereal = get_moon_longitude_sidereal(time);
-    return Nakshatra{moon_longitude_sidereal.longitude * (27.0/360.0)};
+    return nakshatra_from_moon_longitude(get_moon_longitude_sidereal(time));
 }
 
 Nirayana_Longitude Swe::surya_nirayana_longitude(JulDays_UT time) const
 {
-    double res[6];
-    do_calc_ut(time.raw_julian_days_ut().count(), SE_SUN, ephemeris_flags | SEFLG_SIDEREAL, res);
-    return Nirayana_Longitude{res[0]};
+    if (const auto * e = embedded_for(time)) return Nirayana_Longitude{e->sun.longitude(time)};
+    return sweph_sidereal_longitude(time, SE_SUN);
+}
+
+SkyState Swe::evaluate(JulDays_UT time) const
+{
+    const double jd = time.raw_julian_days_ut().count();
+    if (const auto * e = embedded_for(time)) {
+        // the other way around: tropical ones are sidereal plus the "true" ayanāṃśa
+        const double ayanamsha = true_ayanamsha(jd, SEFLG_MOSEPH);
+        const Nirayana_Longitude sun_sidereal{e->sun.longitude(time)};
+        const Nirayana_Longitude moon_sidereal{e->moon.longitude(time)};
+        const double sun = tropical_from_sidereal(sun_sidereal.longitude, ayanamsha);
+        const double moon = tropical_from_sidereal(moon_sidereal.longitude, ayanamsha);
+        return SkyState{
+            sun,
+            moon,
+            sun_sidereal,
+            moon_sidereal,
+            tithi_from_longitudes(sun_sidereal.longitude, moon_sidereal.longitude),
+            nakshatra_from_moon_longitude(moon_sidereal),
+        };
+    }
+    double sun[6];
+    do_calc_ut(jd, SE_SUN, ephemeris_flags, sun);
+    double moon[6];
+    do_calc_ut(jd, SE_MOON, ephemeris_flags, moon);
+    const double ayanamsha = true_ayanamsha(jd, ephemeris_flags);
+
+    const auto sun_sidereal = sidereal_from_tropical(sun[0], ayanamsha);
+    const auto moon_sidereal = sidereal_from_tropical(moon[0], ayanamsha);
+    return SkyState{
+        sun[0],
+        moon[0],
+        sun_sidereal,
+        moon_sidereal,
+        tithi_from_longitudes(sun[0], moon[0]),
+        nakshatra_from_moon_longitude(moon_sidereal),
+    };
 }
 
 } // namespace vp
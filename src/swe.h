@@ -3,16 +3,28 @@
 
 #include "calc-error.h"
 #include "calc-flags.h"
+#include "embedded-ephemeris.h"
 #include "juldays_ut.h"
 #include "location.h"
 #include "nakshatra.h"
 #include "tithi.h"
 
 #include <cstdint> // for int32_t
+#include <string>
 #include <tl/expected.hpp>
 
 namespace vp {
 
+// Sun and Moon at one moment: everything tithi, nakṣatra and saṅkrānti checks need.
+struct SkyState {
+    double sun_longitude;
+    double moon_longitude;
+    Nirayana_Longitude sun_longitude_sidereal;
+    Nirayana_Longitude moon_longitude_sidereal;
+    Tithi tithi;
+    Nakshatra nakshatra;
+};
+
 class Swe
 {
 public:
@@ -21,8 +33,8 @@ public:
 
     Swe(const Location & coord_, CalcFlags flags=CalcFlags::Default);
     ~Swe();
-    // Swe is kind of hanlde for sweph and thus we can't really copy it.
-    // Copying it would allow for muiltiple swe_close() calls.
+    // Swe is kind of hanlde for sweph (set up for its location by the constructor)
+    // and thus we can't really copy it.
     Swe(const Swe &) = delete;
     Swe& operator=(const Swe &) = delete;
     Swe(Swe &&) noexcept;
@@ -39,13 +51,32 @@ public:
     Nirayana_Longitude get_moon_longitude_sidereal(JulDays_UT time) const;
     Nakshatra get_nakshatra(JulDays_UT time) const;
     Nirayana_Longitude surya_nirayana_longitude(JulDays_UT time) const;
+    /** All of the above at once, cheaper than calling them one by one:
+     * Sun and Moon are calculated once (tropical), and sidereal longitudes
+     * are derived from them by subtracting ayanāṃśa, the same way as
+     * get_moon_longitude_sidereal() and surya_nirayana_longitude() do it.
+     */
+    SkyState evaluate(JulDays_UT time) const;
+    // Directory with sweph data files for all Swe objects created afterwards, "eph" (relative to the current dir) by default.
+    static void set_ephemeris_path(std::string path);
+    // Whether Swe objects created afterwards use EmbeddedEphemeris (if compiled in), true by default.
+    // Off means sweph for everything, e.g. for reference results to compare with.
+    static void use_embedded_ephemeris(bool use);
 private:
     // remember to update move-contructor and and move-assigment when adding/changing fields
-    bool need_to_close = true;
     int32_t rise_flags;
     int32_t ephemeris_flags;
+    // Built-in Sun and Moon for Swiss ephemeris (see EmbeddedEphemeris), if any.
+    const EmbeddedEphemeris * embedded = nullptr;
+    const EmbeddedEphemeris * embedded_for(JulDays_UT time) const;
+    // Sunrises and sunsets within the range covered by embedded ephemeris use Moshier ephemeris,
+    // to need no files at all there (swe_rise_trans() can't use the embedded tables). Outside of
+    // it, and without embedded ephemeris, they use the same ephemeris as everything else.
+    int32_t rise_ephemeris_flags(JulDays_UT time) const;
     [[noreturn]] void throw_on_wrong_flags(int out_flags, int in_flags, char *serr) const;
     void do_calc_ut(double jd, int planet, int flags, double *res) const;
+    // tropical longitude from sweph minus the true ayanāṃśa, the same as in evaluate()
+    Nirayana_Longitude sweph_sidereal_longitude(JulDays_UT time, int planet) const;
     tl::expected<JulDays_UT, CalcError> do_rise_trans(int rise_or_set, JulDays_UT after) const;
     int32_t get_rise_flags(CalcFlags flags) const noexcept;
     int32_t calc_ephemeris_flags(CalcFlags flags) const noexcept;
@@ -158,3 +158,17 @@ TEST_CASE("Swe keeps both default and non-default flags after move") {
         REQUIRE(swe2_nondefault.calc_flags == CalcFlags::ShravanaDvadashi14ghPlus);
     }
 }
+
+TEST_CASE("evaluate() agrees with separate calculations") {
+    const auto flags = GENERATE(CalcFlags::Default, CalcFlags::EphemerisMoshier);
+    const auto time = GENERATE(JulDays_UT{2019_y/March/10}, JulDays_UT{2019_y/March/21, double_hours{1.716666}}, JulDays_UT{2021_y/January/25, double_hours{6.5}});
+    CAPTURE(time);
+    const Swe swe{arbitrary_coord, flags};
+    const auto sky = swe.evaluate(time);
+    REQUIRE(sky.sun_longitude == swe.get_sun_longitude(time));
+    REQUIRE(sky.moon_longitude == swe.get_moon_longitude(time));
+    REQUIRE(sky.tithi.tithi == swe.get_tithi(time).tithi);
+    REQUIRE(sky.sun_longitude_sidereal.longitude == swe.surya_nirayana_longitude(time).longitude);
+    REQUIRE(sky.moon_longitude_sidereal.longitude == swe.get_moon_longitude_sidereal(time).longitude);
+    REQUIRE(sky.nakshatra.nakshatra == swe.get_nakshatra(time).nakshatra);
+}
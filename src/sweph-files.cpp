@@ -0,0 +1,50 @@
+#include "sweph-files.h"
+
+#include "mapped-file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifndef _WIN32
+namespace vp {
+
+namespace {
+// never unmapped: sweph may keep streams over them open until the very exit
+std::map<std::string, MappedFile> & mapped_files() {
+    static auto * files = new std::map<std::string, MappedFile>;
+    return *files;
+}
+
+const MappedFile * mapped_file(const char * path) {
+    static std::mutex mutex;
+    std::lock_guard lock{mutex};
+    auto & files = mapped_files();
+    if (auto it = files.find(path); it != files.end()) return &it->second;
+    // missing files are not remembered: sweph probes several names and dirs, and they may appear later
+    auto file = MappedFile::open(path);
+    if (!file) return nullptr;
+    return &files.emplace(path, std::move(*file)).first->second;
+}
+}
+
+} // namespace vp
+#endif
+
+extern "C" FILE * vp_sweph_fopen(const char * path, const char * mode)
+{
+#ifndef _WIN32
+    if (std::strchr(mode, 'r') && !std::strchr(mode, '+')) {
+        if (const auto * file = vp::mapped_file(path)) {
+            // fmemopen() doesn't write to read-only streams, const_cast is safe
+            FILE * stream = fmemopen(const_cast<unsigned char *>(file->data()), file->size(), "r");
+            // the mapping is the buffer already
+            if (stream) setvbuf(stream, nullptr, _IONBF, 0);
+            return stream;
+        }
+    }
+#endif
+    return std::fopen(path, mode);
+}
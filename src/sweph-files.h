@@ -0,0 +1,31 @@
+#ifndef VP_SWEPH_FILES_H
+#define VP_SWEPH_FILES_H
+
+/* Ephemeris files for sweph, mapped into memory once per process.
+ *
+ * sweph sources get this header force-included (see sweph target in CMakeLists.txt),
+ * so all of their fopen() calls go to vp_sweph_fopen(). Files opened for reading
+ * are mapped on the first open and never unmapped: every later open in any
+ * thread is an in-memory stream over the same pages, no disk access at all.
+ * Must stay valid C, sweph is compiled as C.
+ */
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Same as fopen(), except read-only files come from the shared mapping
+// (where the platform has fmemopen(), i.e. not on Windows).
+FILE * vp_sweph_fopen(const char * path, const char * mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef VP_SWEPH_FOPEN_HOOK
+#define fopen vp_sweph_fopen
+#endif
+
+#endif // VP_SWEPH_FILES_H
@@ -0,0 +1,88 @@
+#include "catch-formatters.h"
+
+#include "sweph-files.h"
+#include "filesystem-fixed.h"
+#include "swe.h"
+#include "temp-files.h"
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace date;
+
+namespace {
+std::vector<char> read_all(FILE * stream) {
+    std::vector<char> content;
+    std::array<char, 1000> buf;
+    std::size_t count;
+    while ((count = std::fread(buf.data(), 1, buf.size(), stream)) > 0) {
+        content.insert(content.end(), buf.data(), buf.data() + count);
+    }
+    return content;
+}
+
+const fs::path & test_file_path() {
+    static const test_files::TempFile file = [] {
+        test_files::TempFile f{"sweph-files-test", ".se1"};
+        std::ofstream out{f.path(), std::ios::binary | std::ios::trunc};
+        for (int i = 0; i < 10000; ++i) out << i << '\n';
+        return f;
+    }();
+    return file.path();
+}
+}
+
+TEST_CASE("vp_sweph_fopen() reads the same bytes as the file has, every time it's opened") {
+    const auto path = test_file_path();
+    std::ifstream in{path, std::ios::binary};
+    const std::vector<char> expected{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    for (int i = 0; i < 2; ++i) {
+        FILE * stream = vp_sweph_fopen(path.string().c_str(), "rb");
+        REQUIRE(stream != nullptr);
+        REQUIRE(read_all(stream) == expected);
+
+        // sweph seeks around a lot
+        REQUIRE(std::fseek(stream, 0, SEEK_END) == 0);
+        REQUIRE(std::ftell(stream) == static_cast<long>(expected.size()));
+        REQUIRE(std::fseek(stream, 10, SEEK_SET) == 0);
+        REQUIRE(std::fgetc(stream) == expected[10]);
+        std::fclose(stream);
+    }
+}
+
+TEST_CASE("vp_sweph_fopen() gives nullptr for missing files") {
+    REQUIRE(vp_sweph_fopen(test_files::unique_temp_path("no-such-file", ".se1").string().c_str(), "rb") == nullptr);
+}
+
+TEST_CASE("vp_sweph_fopen() writes files for real") {
+    const test_files::TempFile written{"sweph-files-test-written", ".txt"};
+    const auto & path = written.path();
+    FILE * stream = vp_sweph_fopen(path.string().c_str(), "w");
+    REQUIRE(stream != nullptr);
+    std::fputs("written", stream);
+    std::fclose(stream);
+    std::ifstream in{path};
+    std::string content;
+    in >> content;
+    REQUIRE(content == "written");
+}
+
+TEST_CASE("Swe objects in a row and in other threads give the same longitudes") {
+    const vp::JulDays_UT time{2021_y/February/9};
+    const double sun = vp::Swe{vp::udupi_coord}.get_sun_longitude(time);
+    const double moon = vp::Swe{vp::kiev_coord}.get_moon_longitude(time);
+    REQUIRE(vp::Swe{vp::kiev_coord}.get_sun_longitude(time) == sun);
+    REQUIRE(vp::Swe{vp::udupi_coord}.get_moon_longitude(time) == moon);
+    double thread_sun = 0.0, thread_moon = 0.0;
+    std::thread{[&] {
+        thread_sun = vp::Swe{vp::udupi_coord}.get_sun_longitude(time);
+        thread_moon = vp::Swe{vp::udupi_coord}.get_moon_longitude(time);
+    }}.join();
+    REQUIRE(thread_sun == sun);
+    REQUIRE(thread_moon == moon);
+}
@@ -1,14 +1,18 @@
 #include "table-calendar-generator.h"
 
 #include "html-util.h"
+#include "time-format.h"
 
+#include <optional>
 #include <set>
 #include <utility>
 
 namespace {
 
-std::set<date::local_days> get_vrata_dates(const vp::VratasForDate & vratas, const vp::Custom_Dates & custom_dates) {
-    std::set<date::local_days> dates;
+using Dates = std::pmr::set<date::local_days>;
+
+Dates get_vrata_dates(const vp::VratasForDate & vratas, const vp::Custom_Dates & custom_dates, std::pmr::memory_resource * resource) {
+    Dates dates{resource};
     for (const auto & vrata : vratas) {
         if (vrata) {
             dates.insert(date::local_days{vrata->date});
@@ -28,7 +32,8 @@ std::set<date::local_days> get_vrata_dates(const vp::VratasForDate & vratas, con
     return dates;
 }
 
-void add_header(vp::Table & table, const std::set<date::local_days> & vrata_dates, date::year default_year, const std::string & text) {
+template<class TableT>
+void add_header(TableT & table, const Dates & vrata_dates, date::year default_year, const std::string & text) {
     table.start_new_row();
     table.add_header_cell(text);
     table.add_header_cell(text);
@@ -44,31 +49,37 @@ void add_header(vp::Table & table, const std::set<date::local_days> & vrata_date
     }
 }
 
-std::string get_timezone_text(const vp::MaybeVrata & vrata) {
-    if (!vrata) return "-";
-    if (!vrata->paran.paran_start) return "-";
-    auto paran_start_sys = vrata->paran.paran_start->as_sys_time();
-    auto timezone = vrata->location.time_zone();
-    auto info = timezone->get_info(paran_start_sys);
-
-    long long seconds = info.offset.count();
-    char sign = seconds < 0 ? '-' : '+';
-    seconds = std::abs(seconds);
-    auto hours = seconds / 3600;
-    seconds -= hours * 3600;
-    auto minutes = seconds / 60;
-    seconds -= minutes * 60;
-    std::string dst = info.save != std::chrono::seconds{0} ? " (DST)" : "";
-
-    if (seconds != 0) {
-        return fmt::format(FMT_STRING("{}{}:{:02}:{:02}{}"), sign, hours, minutes, seconds, dst);
+// Time zone info for a location's row at its pāraṇam start. Looked up once per row
+// (time_zone()->get_info() is the slowest part of the table generation after the calculation itself)
+// and then used for both the time zone column and the separator rows.
+struct RowTimeZone {
+    std::chrono::seconds utc_offset{};
+    bool dst = false;
+};
+
+std::optional<RowTimeZone> get_row_time_zone(const vp::MaybeVrata & vrata) {
+    if (!vrata) return std::nullopt;
+    if (!vrata->paran.paran_start) return std::nullopt;
+    const auto info = vrata->location.time_zone()->get_info(vrata->paran.paran_start->as_sys_time());
+    return RowTimeZone{info.offset, info.save != std::chrono::minutes{0}};
+}
+
+std::string get_timezone_text(const std::optional<RowTimeZone> & time_zone) {
+    if (!time_zone) return "-";
+
+    fmt::memory_buffer buf;
+    vp::format_utc_offset(buf, time_zone->utc_offset);
+    if (time_zone->dst) {
+        constexpr std::string_view dst = " (DST)";
+        buf.append(dst.data(), dst.data() + dst.size());
     }
-    return fmt::format(FMT_STRING("{}{}:{:02}{}"), sign, hours, minutes, dst);
+    return fmt::to_string(buf);
 }
 
-void add_vrata(vp::Table & table, const vp::MaybeVrata & vrata, const std::set<date::local_days> & vrata_dates, std::string tr_classes, const vp::Custom_Dates & custom_dates) {
+template<class TableT>
+void add_vrata(TableT & table, const vp::MaybeVrata & vrata, const std::optional<RowTimeZone> & time_zone, const Dates & vrata_dates, std::string tr_classes, const vp::Custom_Dates & custom_dates) {
     table.start_new_row(std::move(tr_classes));
-    table.add_cell(get_timezone_text(vrata));
+    table.add_cell(get_timezone_text(time_zone));
     table.add_cell(vrata->location.country);
     {
         auto location_with_href = fmt::format(FMT_STRING(R"(<a href="#{}">{}</a>)"), html::escape_attribute(vrata->location_name()), vrata->location_name());
@@ -100,7 +111,8 @@ void add_vrata(vp::Table & table, const vp::MaybeVrata & vrata, const std::set<d
     }
 }
 
-std::vector<double> calc_column_widths(const vp::Table & table) {
+template<class TableT>
+std::vector<double> calc_column_widths(const TableT & table) {
     size_t width = table.width();
 
     constexpr double timezone_col_width = 8.0;
@@ -116,21 +128,19 @@ std::vector<double> calc_column_widths(const vp::Table & table) {
     return col_widths;
 }
 
-std::chrono::seconds utc_offset_for_vrata(const vp::Vrata & vrata) {
-    if (!vrata.paran.paran_start) return {};
-    auto paran_start_sys = vrata.paran.paran_start->as_sys_time();
-    auto timezone = vrata.location.time_zone();
-    auto info = timezone->get_info(paran_start_sys);
-
-    return info.offset;
+void merge_cells(vp::Table & table) {
+    table.merge_cells_into_rowspans();
+    table.merge_cells_into_colspans();
 }
 
-} // anonymous namespace
+void merge_cells(vp::Compact_Table & table) {
+    table.merge_cells();
+}
 
-vp::Table vp::Table_Calendar_Generator::generate(const vp::VratasForDate & vratas, date::year default_year, const Custom_Dates & custom_dates)
+template<class TableT>
+void fill_table(TableT & table, const vp::VratasForDate & vratas, date::year default_year, const vp::Custom_Dates & custom_dates, std::pmr::memory_resource * resource)
 {
-    vp::Table table;
-    auto vrata_dates = get_vrata_dates(vratas, custom_dates);
+    auto vrata_dates = get_vrata_dates(vratas, custom_dates, resource);
     add_header(table, vrata_dates, default_year, "॥ श्रीः ॥");
     int row = 1;
     const vp::MaybeVrata * prev_vrata{};
@@ -138,8 +148,9 @@ vp::Table vp::Table_Calendar_Generator::generate(const vp::VratasForDate & vrata
     using namespace std::chrono_literals;
     constexpr std::chrono::seconds min_utc_offset_for_separator = 7h;
     for (const auto & vrata : vratas) {
+        const auto time_zone = get_row_time_zone(vrata);
         if (vrata) {
-            auto vrata_utc_offset = utc_offset_for_vrata(*vrata);
+            auto vrata_utc_offset = time_zone ? time_zone->utc_offset : std::chrono::seconds{};
             if (prev_vrata) {
                 if (abs(vrata_utc_offset - prev_vrata_utc_offset) >= min_utc_offset_for_separator) {
                     table.start_new_row("separator");
@@ -148,13 +159,27 @@ vp::Table vp::Table_Calendar_Generator::generate(const vp::VratasForDate & vrata
             prev_vrata = &vrata;
             prev_vrata_utc_offset = vrata_utc_offset;
         }
-        add_vrata(table, vrata, vrata_dates, ++row % 2 ? "odd" : "even", custom_dates);
+        add_vrata(table, vrata, time_zone, vrata_dates, ++row % 2 ? "odd" : "even", custom_dates);
     }
     add_header(table, vrata_dates, default_year, "॥ ॐ तत्सत् ॥");
-    table.merge_cells_into_rowspans();
-    table.merge_cells_into_colspans();
+    merge_cells(table);
     table.set_column_widths(calc_column_widths(table));
     table.add_even_odd_classes_for_col(0);
-    table.add_even_odd_classes_for_col(1, Table::StartFrom::Even);
+    table.add_even_odd_classes_for_col(1, vp::Table::StartFrom::Even);
+}
+
+} // anonymous namespace
+
+vp::Table vp::Table_Calendar_Generator::generate(const vp::VratasForDate & vratas, date::year default_year, const Custom_Dates & custom_dates)
+{
+    vp::Table table;
+    fill_table(table, vratas, default_year, custom_dates, std::pmr::get_default_resource());
+    return table;
+}
+
+vp::Compact_Table vp::Table_Calendar_Generator::generate_compact(const vp::VratasForDate & vratas, date::year default_year, const Custom_Dates & custom_dates, std::pmr::memory_resource * resource)
+{
+    vp::Compact_Table table{resource};
+    fill_table(table, vratas, default_year, custom_dates, resource);
     return table;
 }
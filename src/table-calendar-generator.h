@@ -2,9 +2,11 @@
 #define TABLE_CALENDAR_GENERATOR_H
 
 #include "calc-error.h"
+#include "compact-table.h"
 #include "table.h"
 #include "vrata.h"
 
+#include <memory_resource>
 #include <ostream>
 #include <unordered_map>
 
@@ -16,6 +18,9 @@ class Table_Calendar_Generator
 {
 public:
     static vp::Table generate(const VratasForDate & vratas, date::year default_year=date::year::min(), const Custom_Dates & custom_dates={});
+    // Same table with interned strings, for writing out directly with write_html_table().
+    // Table contents are allocated from the given memory resource.
+    static vp::Compact_Table generate_compact(const VratasForDate & vratas, date::year default_year=date::year::min(), const Custom_Dates & custom_dates={}, std::pmr::memory_resource * resource = std::pmr::get_default_resource());
 };
 
 } // namespace vp
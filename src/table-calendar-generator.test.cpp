@@ -1,5 +1,6 @@
 #include "catch-formatters.h"
 
+#include "html-table-writer.h"
 #include "table-calendar-generator.h"
 #include "text-interface.h"
 
@@ -213,3 +214,15 @@ TEST_CASE("table for Vrata with multiple nameworthy dates on the same day lists
     const auto table = vp::Table_Calendar_Generator::generate(vratas);
     REQUIRE_THAT(table.at(1, 5).text, Contains("event1. event2"));
 }
+
+TEST_CASE("generate_compact() gives exactly the same HTML as generate()") {
+    const auto vratas = some_vratas(2018_y/8/15);
+    const vp::Custom_Dates custom_dates{{date::local_days{2018_y/8/22}, "custom"}};
+
+    std::stringstream s;
+    s << vp::Html_Table_Writer{vp::Table_Calendar_Generator::generate(vratas, 2018_y, custom_dates)};
+    fmt::memory_buffer buf;
+    vp::write_html_table(buf, vp::Table_Calendar_Generator::generate_compact(vratas, 2018_y, custom_dates));
+
+    REQUIRE(fmt::to_string(buf) == s.str());
+}
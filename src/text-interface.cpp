@@ -2,10 +2,21 @@
 
 #include "calc.h"
 #include "nameworthy-dates.h"
+#include "place-db.h"
+#include "time-format.h"
+#include "time-zone-db.h"
+#include "vrata-db.h"
+#include "vrata-grid.h"
 #include "vrata_detail_printer.h"
 
+#include <algorithm>
 #include <charconv>
+#include <cmath>
 #include <cstring>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <thread>
 
 using namespace vp;
 
@@ -14,6 +25,9 @@ namespace vp::text_ui {
 namespace {
 constexpr int len(const char * s) { return std::char_traits<char>::length(s); }
 static_assert (len("123") == 3);
+
+std::optional<PlaceDb> place_db;
+std::optional<TimeZoneDb> time_zone_db;
 }
 
 date::year_month_day parse_ymd(const std::string_view s) {
@@ -129,18 +143,58 @@ std::optional<Location> LocationDb::find_coord(const char *location_name) {
             return named_coord.name == location_name;
         }
     );
-    if (found == std::end(locations())) return std::nullopt;
-    return *found;
+    if (found != std::end(locations())) return *found;
+    if (place_db) return place_db->find(location_name);
+    return std::nullopt;
+}
+
+std::vector<Location> LocationDb::find_by_prefix(std::string_view prefix, std::size_t max_count) {
+    const auto starts_with = [prefix](std::string_view name) {
+        const auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; };
+        return name.size() >= prefix.size()
+                && std::equal(prefix.begin(), prefix.end(), name.begin(), [&](char a, char b) { return lower(a) == lower(b); });
+    };
+    std::vector<Location> found;
+    for (const auto & location : locations()) {
+        if (found.size() >= max_count) return found;
+        if (starts_with(location.name)) found.push_back(location);
+    }
+    if (place_db) {
+        for (auto & location : place_db->find_by_prefix(prefix, max_count - found.size())) {
+            found.push_back(std::move(location));
+        }
+    }
+    return found;
+}
+
+Location LocationDb::find_nearest(Coord coord) {
+    const auto distance = [coord](const Location & location) {
+        // haversine
+        constexpr double degrees_to_radians = 3.14159265358979323846 / 180.0;
+        const double lat1 = coord.latitude.latitude * degrees_to_radians;
+        const double lat2 = location.latitude.latitude * degrees_to_radians;
+        const double sin_dlat = std::sin((lat2 - lat1) / 2);
+        const double sin_dlng = std::sin((location.longitude.longitude - coord.longitude.longitude) * degrees_to_radians / 2);
+        return sin_dlat * sin_dlat + std::cos(lat1) * std::cos(lat2) * sin_dlng * sin_dlng;
+    };
+    const auto nearest = std::min_element(locations().begin(), locations().end(), [&](const Location & a, const Location & b) {
+        return distance(a) < distance(b);
+    });
+    if (place_db) {
+        if (auto place = place_db->find_nearest(coord); place && distance(*place) < distance(*nearest)) return *place;
+    }
+    return *nearest;
 }
 
 namespace {
 // try decreasing latitude until we get all necessary sunrises/sunsets
-tl::expected<vp::Vrata, vp::CalcError> decrease_latitude_and_find_vrata(date::local_days base_date, const Location & location) {
+tl::expected<vp::Vrata, vp::CalcError> decrease_latitude_and_find_vrata(date::local_days base_date, const Location & location, VrataParts parts,
+                                                                        const CancellationToken & cancellation) {
     auto l = location;
     l.latitude_adjusted = true;
     while (1) {
         l.latitude.latitude -= 1.0;
-        auto vrata = Calc{l}.find_next_vrata(base_date);
+        auto vrata = Calc{Swe{l}, nullptr, cancellation}.find_next_vrata(base_date, parts);
         // Return if have actually found vrata.
         // Also return if we ran down to low enough latitudes so that it doesn't
         // make sense to decrease it further; just report whatever error we got in that case.
@@ -148,36 +202,108 @@ tl::expected<vp::Vrata, vp::CalcError> decrease_latitude_and_find_vrata(date::lo
     }
 }
 
-tl::expected<vp::Vrata, vp::CalcError> calc_one(date::local_days base_date, const Location & location, CalcFlags flags = CalcFlags::Default) {
-    // Use immediately-called lambda to ensure Calc is destroyed before more
-    // will be created in decrease_latitude_and_find_vrata()
-    auto vrata = [&](){
-        return Calc{Swe{location, flags}}.find_next_vrata(base_date);
-    }();
-    if (vrata) return vrata;
+std::optional<VrataDb> vrata_db;
 
-    auto e = vrata.error();
-    // if we are in the northern areas and the error is that we can't find sunrise or sunset, then try decreasing latitude until it's OK.
-    if ((std::holds_alternative<CantFindSunriseAfter>(e) || std::holds_alternative<CantFindSunsetAfter>(e)) && location.latitude.latitude > 60.0) {
-        return decrease_latitude_and_find_vrata(base_date, location);
+// vrata db, but only if it was calculated with the same flags
+const VrataDb * vrata_db_for(CalcFlags flags) {
+    if (vrata_db && vrata_db->flags() == flags) return &*vrata_db;
+    return nullptr;
+}
+
+// Cache for tithi and nakṣatra starts found while answering one request (they don't depend on location
+// or sunrise/sunset flags, so all locations and dates of the request share them).
+std::shared_ptr<BoundaryCache> make_boundary_cache(CalcFlags flags) {
+    return std::make_shared<BoundaryCache>(flags & CalcFlags::EphemerisMask);
+}
+
+// Take vrata from the vrata db when it's there, calculate otherwise.
+tl::expected<vp::Vrata, vp::CalcError> find_one(date::local_days base_date, const Location & location, CalcFlags flags = CalcFlags::Default,
+                                                std::shared_ptr<BoundaryCache> boundary_cache = nullptr, VrataParts parts = VrataParts::All,
+                                                const CancellationToken & cancellation = {}) {
+    if (const auto * db = vrata_db_for(flags)) {
+        if (auto vrata = db->find_next(location, base_date)) return std::move(*vrata);
     }
-    // Otherwise return whatever error we've got.
-    return vrata;
+    return calc_one(base_date, location, flags, std::move(boundary_cache), parts, cancellation);
+}
+
+// see set_calc_threads()
+unsigned calc_threads = 1;
+
+// find_one() for every LocationDb location, split between calc_threads threads (every n-th location
+// for each, so that slow high-latitude ones get spread between them). sweph keeps its state
+// in thread-local storage, but the shared boundary caches aren't thread-safe: each thread gets its own.
+void find_all_in_threads(date::local_days base_date, vp::VratasForDate & vratas, CalcFlags flags, std::size_t threads,
+                         const CancellationToken & cancellation) {
+    const auto locations = LocationDb().begin();
+    const std::size_t count = LocationDb::size();
+    std::vector<std::optional<vp::MaybeVrata>> found(count);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t first = 0; first < threads; ++first) {
+        workers.emplace_back([&, first] {
+            try {
+                const auto boundary_cache = make_boundary_cache(flags);
+                const auto * db = vrata_db_for(flags);
+                for (std::size_t i = first; i < count; i += threads) {
+                    const auto & location = locations[static_cast<std::ptrdiff_t>(i)];
+                    if (db) {
+                        if (auto vrata = db->find_next(location, base_date)) {
+                            found[i] = std::move(*vrata);
+                            continue;
+                        }
+                    }
+                    found[i] = calc_one(base_date, location, flags, boundary_cache, VrataParts::All, cancellation);
+                }
+            } catch (...) {
+                errors[first] = std::current_exception();
+            }
+        });
+    }
+    for (auto & worker : workers) worker.join();
+    for (const auto & error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    for (auto & vrata : found) vratas.push_back(std::move(*vrata));
 }
 
 // Try calculating, return true if resulting date range is small enough (suggesting that it's the same ekAdashI for all locations),
 // false otherwise (suggesting that we should repeat calculation with adjusted base_date
-bool try_calc_all(date::local_days base_date, vp::VratasForDate & vratas, CalcFlags flags) {
+bool try_calc_all(date::local_days base_date, vp::VratasForDate & vratas, CalcFlags flags, const std::shared_ptr<BoundaryCache> & boundary_cache,
+                  const CancellationToken & cancellation) {
+    if (const std::size_t threads = std::min<std::size_t>(calc_threads, LocationDb::size()); threads > 1) {
+        find_all_in_threads(base_date, vratas, flags, threads, cancellation);
+        return vratas.all_from_same_ekadashi();
+    }
     std::transform(
         LocationDb().begin(),
         LocationDb().end(),
         std::back_inserter(vratas),
-        [base_date, flags](const vp::Location & location) {
-            return calc_one(base_date, location, flags);
+        [&](const vp::Location & location) {
+            return find_one(base_date, location, flags, boundary_cache, VrataParts::All, cancellation);
         });
     return vratas.all_from_same_ekadashi();
 }
 
+// Same result as calculating all locations again from adjusted_base_date (the day before), but cheaper.
+// Only the locations which got next pakṣa's vrata (more than 2 days after the earliest one) or an error
+// can get something else from the day before: for the rest that would require another vrata just 1-3
+// days before theirs. So only recalculate those, usually just a few far-eastern or far-western ones.
+void recalc_outliers(date::local_days adjusted_base_date, vp::VratasForDate & vratas, CalcFlags flags, const std::shared_ptr<BoundaryCache> & boundary_cache,
+                     const CancellationToken & cancellation) {
+    std::optional<date::local_days> min_date;
+    for (const auto & vrata : vratas) {
+        if (vrata && (!min_date || vrata->date < *min_date)) min_date = vrata->date;
+    }
+    auto location = LocationDb().begin();
+    for (auto & vrata : vratas) {
+        if (!vrata || vrata->date - *min_date > date::days{2}) {
+            vrata = find_one(adjusted_base_date, *location, flags, boundary_cache, VrataParts::All, cancellation);
+        }
+        ++location;
+    }
+}
+
 struct CalcSettings {
     date::local_days date;
     vp::CalcFlags flags;
@@ -202,58 +328,216 @@ struct MyHash {
     }
 };
 
-std::unordered_map<CalcSettings, vp::VratasForDate, MyHash> cache;
+// calc_all() results; guarded by cache_mutex, since calc() may be called from several threads.
+// Shared and immutable, so that callers copy them only once, wherever they need them.
+std::unordered_map<CalcSettings, std::shared_ptr<const vp::VratasForDate>, MyHash> cache;
+std::mutex cache_mutex;
 
 bool operator==(const CalcSettings & left, const CalcSettings & right)
 {
     return (left.date == right.date) && (left.flags == right.flags);
 }
 
-vp::VratasForDate calc_all(date::local_days base_date, CalcFlags flags)
+std::shared_ptr<const vp::VratasForDate> calc_all(date::local_days base_date, CalcFlags flags, const std::shared_ptr<BoundaryCache> & boundary_cache,
+                                                  const CancellationToken & cancellation)
 {
     const auto key = CalcSettings{base_date, flags};
-    if (auto found = cache.find(key); found != cache.end()) {
-        return found->second;
+    {
+        std::lock_guard<std::mutex> lock{cache_mutex};
+        if (auto found = cache.find(key); found != cache.end()) {
+            return found->second;
+        }
     }
-    vp::VratasForDate vratas;
+    // not under the lock: other threads may calculate meanwhile (even the same thing, then the last one stays)
+    auto vratas = std::make_shared<vp::VratasForDate>();
 
-    if (!try_calc_all(base_date, vratas, flags)) {
-        vratas.clear();
+    if (!try_calc_all(base_date, *vratas, flags, boundary_cache, cancellation)) {
         date::local_days adjusted_base_date = base_date - date::days{1};
-        try_calc_all(adjusted_base_date, vratas, flags);
+        recalc_outliers(adjusted_base_date, *vratas, flags, boundary_cache, cancellation);
     }
+    std::lock_guard<std::mutex> lock{cache_mutex};
     cache[key] = vratas;
     return vratas;
 }
 
 // Add other interesting dates to the
 void add_nameworthy_dates_for_this_paksha(VratasForDate & vratas, CalcFlags flags) {
+    const auto * db = vrata_db_for(flags);
     for (auto & vrata : vratas) {
         if (vrata) {
-            vrata->dates_for_this_paksha = vp::nameworthy_dates_for_this_paksha(vrata.value(), flags);
+            if (db) {
+                if (auto dates = db->nameworthy_dates(*vrata, vratas.resource())) {
+                    vrata->dates_for_this_paksha = std::move(*dates);
+                    continue;
+                }
+            }
+            // one time zone lookup for all local times of this location's pāraṇam
+            LocalTimeCache local_times{vrata->paran.time_zone};
+            vrata->dates_for_this_paksha = vp::nameworthy_dates_for_this_paksha(vrata.value(), flags, local_times, vratas.resource());
         }
     }
 }
 
 }
 
-vp::VratasForDate calc(date::year_month_day base_date, std::string location_name, CalcFlags flags)
+vp::VratasForDate calc(date::year_month_day base_date, std::string location_name, CalcFlags flags, std::pmr::memory_resource * resource,
+                       std::shared_ptr<BoundaryCache> boundary_cache, const CancellationToken & cancellation, VrataParts parts)
 {
-    vp::VratasForDate vratas;
+    if (!boundary_cache) boundary_cache = make_boundary_cache(flags);
+    vp::VratasForDate vratas{resource};
     if (location_name == "all") {
-        vratas = calc_all(date::local_days{base_date}, flags);
+        // copy one by one (instead of assigning) to get them allocated from our resource:
+        // the only copy of cached vratas
+        const auto all = calc_all(date::local_days{base_date}, flags, boundary_cache, cancellation);
+        for (const auto & vrata : *all) {
+            vratas.push_back(vrata);
+        }
     } else {
         auto location = LocationDb::find_coord(location_name.c_str());
         if (!location) {
             vratas.push_back(tl::make_unexpected(CantFindLocation{std::move(location_name)}));
         } else {
-            vratas.push_back(calc_one(date::local_days{base_date}, *location, flags));
+            vratas.push_back(find_one(date::local_days{base_date}, *location, flags, boundary_cache, parts, cancellation));
         }
     }
-    add_nameworthy_dates_for_this_paksha(vratas, flags);
+    cancellation.throw_if_cancelled();
+    if (wants(parts, VrataParts::NameworthyDates)) {
+        add_nameworthy_dates_for_this_paksha(vratas, flags);
+    }
     return vratas;
 }
 
+tl::expected<vp::Vrata, vp::CalcError> find_next(date::local_days base_date, const Location & location, CalcFlags flags,
+                                                 std::shared_ptr<BoundaryCache> boundary_cache, VrataParts parts,
+                                                 const CancellationToken & cancellation) {
+    return find_one(base_date, location, flags, std::move(boundary_cache), parts, cancellation);
+}
+
+tl::expected<vp::Vrata, vp::CalcError> calc_one(date::local_days base_date, const Location & location, CalcFlags flags,
+                                                std::shared_ptr<BoundaryCache> boundary_cache, VrataParts parts,
+                                                const CancellationToken & cancellation) {
+    // Use immediately-called lambda to ensure Calc is destroyed before more
+    // will be created in decrease_latitude_and_find_vrata()
+    auto vrata = [&](){
+        return Calc{Swe{location, flags}, std::move(boundary_cache), cancellation}.find_next_vrata(base_date, parts);
+    }();
+    if (vrata) return vrata;
+
+    auto e = vrata.error();
+    // if we are in the northern areas and the error is that we can't find sunrise or sunset, then try decreasing latitude until it's OK.
+    if ((std::holds_alternative<CantFindSunriseAfter>(e) || std::holds_alternative<CantFindSunsetAfter>(e)) && location.latitude.latitude > 60.0) {
+        return decrease_latitude_and_find_vrata(base_date, location, parts, cancellation);
+    }
+    // Otherwise return whatever error we've got.
+    return vrata;
+}
+
+std::vector<VrataPreview> preview(date::year_month_day base_date, const std::string & location_name, CalcFlags flags)
+{
+    std::vector<VrataPreview> previews;
+    const auto add = [&](const Location & location) {
+        auto preview = preview_next_vrata(date::local_days{base_date}, location, flags);
+        if (preview) {
+            previews.push_back(std::move(*preview));
+        } else {
+            // the exact calculation might still find it (e.g. by adjusting latitude)
+            Vrata vrata;
+            vrata.location = location;
+            previews.push_back(VrataPreview{std::move(vrata), true});
+        }
+    };
+    if (location_name == "all") {
+        for (const auto & location : LocationDb()) {
+            add(location);
+        }
+    } else if (auto location = LocationDb::find_coord(location_name.c_str())) {
+        add(*location);
+    }
+    return previews;
+}
+
+std::vector<MaybeVrata> refine_previews(date::year_month_day base_date, const std::vector<VrataPreview> & previews, CalcFlags flags)
+{
+    std::vector<MaybeVrata> vratas;
+    vratas.reserve(previews.size());
+    const auto boundary_cache = make_boundary_cache(flags);
+    for (const auto & preview : previews) {
+        if (preview.uncertain) {
+            vratas.push_back(find_one(date::local_days{base_date}, preview.vrata.location, flags, boundary_cache));
+        } else {
+            vratas.push_back(preview.vrata);
+        }
+    }
+    return vratas;
+}
+
+bool use_vrata_db(const fs::path & path)
+{
+    vrata_db = VrataDb::open(path);
+    // cached results might have been calculated without the db (or with another one)
+    std::lock_guard<std::mutex> lock{cache_mutex};
+    cache.clear();
+    return vrata_db.has_value();
+}
+
+bool use_place_db(const fs::path & path)
+{
+    place_db = PlaceDb::open(path);
+    return place_db.has_value();
+}
+
+bool use_time_zone_db(const fs::path & path)
+{
+    time_zone_db = TimeZoneDb::open(path);
+    return time_zone_db.has_value();
+}
+
+std::string_view time_zone_for(Coord coord)
+{
+    if (time_zone_db) {
+        if (const auto name = time_zone_db->find(coord); !name.empty()) return name;
+    }
+    return approximate_time_zone(coord.longitude);
+}
+
+Location custom_location(Coord coord)
+{
+    Location location{coord.latitude, coord.longitude};
+    location.time_zone_name = time_zone_for(coord);
+    return location;
+}
+
+void set_calc_threads(unsigned count)
+{
+    calc_threads = count != 0 ? count : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void generate_vrata_db(const fs::path & path, date::local_days from, date::local_days to, CalcFlags flags,
+                       const std::function<void(std::size_t done, std::size_t total)> & progress)
+{
+    VrataDbWriter writer{flags, from, to};
+    std::size_t done = 0;
+    for (const auto & location : LocationDb()) {
+        writer.start_location(location);
+        bool after_gap = false;
+        // Each vrata is the answer for all base dates from the day after the previous vrata up to its own date.
+        for (auto base_date = from; base_date <= to;) {
+            auto vrata = calc_one(base_date, location, flags);
+            if (!vrata) {
+                after_gap = true;
+                base_date += date::days{1};
+                continue;
+            }
+            writer.add_vrata(*vrata, after_gap, special_tithi_dates(*vrata, flags));
+            after_gap = false;
+            // max() just in case, to make sure we never loop forever
+            base_date = std::max(base_date, vrata->date) + date::days{1};
+        }
+        if (progress) progress(++done, LocationDb::size());
+    }
+    writer.write(path);
+}
+
 namespace {
 void report_details(const vp::MaybeVrata & vrata, const fmt::appender & out) {
     if (!vrata.has_value()) {
@@ -272,19 +556,19 @@ void report_details(const vp::MaybeVrata & vrata, const fmt::appender & out) {
 }
 
 // Find next ekAdashI vrata for the named location, report details to the output buffer.
-tl::expected<vp::Vrata, vp::CalcError> calc_and_report_one(date::year_month_day base_date, const Location & location, const fmt::appender & out) {
-    auto vrata = calc_one(date::local_days{base_date}, location);
+tl::expected<vp::Vrata, vp::CalcError> calc_and_report_one(date::year_month_day base_date, const Location & location, const fmt::appender & out, CalcFlags flags) {
+    auto vrata = find_one(date::local_days{base_date}, location, flags);
     report_details(vrata, out);
     return vrata;
 }
 
-tl::expected<vp::Vrata, vp::CalcError> find_calc_and_report_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out) {
+tl::expected<vp::Vrata, vp::CalcError> find_calc_and_report_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out, CalcFlags flags) {
     std::optional<Location> coord = LocationDb::find_coord(location_name);
     if (!coord) {
         fmt::format_to(out, "Location not found: '{}'\n", location_name);
         return tl::make_unexpected(CantFindLocation{location_name});
     }
-    return calc_and_report_one(base_date, *coord, out);
+    return calc_and_report_one(base_date, *coord, out, flags);
 }
 
 namespace {
@@ -312,7 +596,7 @@ void daybyday_print_header(date::year_month_day base_date, const Location & coor
             fmt::format_to(out,
                            FMT_STRING("{} until {}{}\n"),
                            info.tithi,
-                           date::format("%H:%M", tithi_until),
+                           hh_mm(tithi_until.get_local_time()),
                            tithi_until_date == sunrise_date ? "" : " next day");
         }
         if (info.tithi2_until) {
@@ -321,7 +605,7 @@ void daybyday_print_header(date::year_month_day base_date, const Location & coor
             fmt::format_to(out,
                            FMT_STRING("{} until {}{}\n"),
                            info.tithi2,
-                           date::format("%H:%M", tithi2_until),
+                           hh_mm(tithi2_until.get_local_time()),
                            tithi2_until_date == sunrise_date ? "" : " next day");
         }
 
@@ -331,7 +615,7 @@ void daybyday_print_header(date::year_month_day base_date, const Location & coor
             fmt::format_to(out,
                            FMT_STRING("{} until {}{}\n"),
                            info.nakshatra,
-                           date::format("%H:%M", until),
+                           hh_mm(until.get_local_time()),
                            date == sunrise_date ? "" : " next day");
         }
         if (info.nakshatra2_until) {
@@ -340,7 +624,7 @@ void daybyday_print_header(date::year_month_day base_date, const Location & coor
             fmt::format_to(out,
                            FMT_STRING("{} until {}{}\n"),
                            info.nakshatra2,
-                           date::format("%H:%M", until),
+                           hh_mm(until.get_local_time()),
                            date == sunrise_date ? "" : " next day");
         }
     }
@@ -405,21 +689,58 @@ void daybyday_add_nakshatra_events(vp::JulDays_UT from, vp::JulDays_UT to, const
 }
 
 
-DayByDayInfo daybyday_events(date::year_month_day base_date, const vp::Calc & calc) {
+// What the next day of daybyday_calc_range() can take from the previous one instead of calculating it again.
+struct DayByDayCarry {
+    std::optional<JulDays_UT> sunset0; // before sunrise1, for arunodaya
+    std::optional<JulDays_UT> sunrise1;
+    std::optional<JulDays_UT> sunset1;
+    std::optional<JulDays_UT> sunrise2;
+    Saura_Masa next_saura_masa = Saura_Masa::Unknown;
+    std::optional<JulDays_UT> next_saura_masa_start;
+};
+
+// Rise and set events strictly alternate, so the day's sunrise is the previous sunrise2 when
+// the previous sunset1 is before midnight and sunrise2 is after it.
+tl::expected<JulDays_UT, CalcError> daybyday_sunrise(JulDays_UT local_astronomical_midnight, const vp::Calc & calc, const DayByDayCarry & carry) {
+    if (carry.sunset1 && carry.sunrise2 && *carry.sunset1 <= local_astronomical_midnight && *carry.sunrise2 >= local_astronomical_midnight) {
+        return *carry.sunrise2;
+    }
+    return calc.swe.find_sunrise(local_astronomical_midnight);
+}
+
+// Sunset before sunrise is the first sunset after (sunrise - 24 hours), see Calc::sunset_before_sunrise().
+// It's the previous sunset1 when that is after (sunrise - 24 hours) and there is no other sunset between
+// them: either the previous sunrise1 is before (sunrise - 24 hours) or so is the previous sunset0.
+tl::expected<JulDays_UT, CalcError> daybyday_sunset_before(JulDays_UT sunrise, const vp::Calc & calc, const DayByDayCarry & carry) {
+    const auto back_24hrs = sunrise - double_days{1.0};
+    if (carry.sunrise2 == sunrise && carry.sunset1 && *carry.sunset1 > back_24hrs
+            && ((carry.sunrise1 && *carry.sunrise1 <= back_24hrs) || (carry.sunset0 && *carry.sunset0 <= back_24hrs))) {
+        return *carry.sunset1;
+    }
+    return calc.sunset_before_sunrise(sunrise);
+}
+
+DayByDayInfo daybyday_events(date::year_month_day base_date, const vp::Calc & calc, DayByDayCarry & carry) {
     DayByDayInfo info;
     const auto local_astronomical_midnight = calc.calc_astronomical_midnight(date::local_days{base_date});
-    const auto sunrise = calc.swe.find_sunrise(local_astronomical_midnight);
+    const auto sunrise = daybyday_sunrise(local_astronomical_midnight, calc, carry);
+    DayByDayCarry next_carry;
     if (sunrise) {
         info.sunrise1 = *sunrise;
+        next_carry.sunrise1 = *sunrise;
         info.events.push_back(NamedTimePoint{"sunrise (prātaḥ-kāla begins)", *sunrise});
-        const auto arunodaya = calc.arunodaya_for_sunrise(*sunrise);
-        if (arunodaya) {
+        const auto sunset0 = daybyday_sunset_before(*sunrise, calc, carry);
+        std::optional<JulDays_UT> arunodaya;
+        if (sunset0) {
+            next_carry.sunset0 = *sunset0;
+            arunodaya = calc.arunodaya_for_sunrise(*sunrise, *sunset0);
             info.events.push_back(NamedTimePoint{"arunodaya", *arunodaya});
         }
 
         const auto sunset = calc.swe.find_sunset(*sunrise);
         if (sunset) {
             info.sunset1 = *sunset;
+            next_carry.sunset1 = *sunset;
             info.events.push_back(NamedTimePoint{"sunset", *sunset});
             info.events.push_back(NamedTimePoint{"1/5 of daytime (saṅgava-kāla begins)", calc.proportional_time(*sunrise, *sunset, 0.2)});
             info.events.push_back(NamedTimePoint{"2/5 of daytime (madhyāhna-kāla begins)", calc.proportional_time(*sunrise, *sunset, 0.4)});
@@ -432,6 +753,7 @@ DayByDayInfo daybyday_events(date::year_month_day base_date, const vp::Calc & ca
             const auto sunrise2 = calc.swe.find_sunrise(*sunset);
             if (sunrise2) {
                 info.sunrise2 = *sunrise2;
+                next_carry.sunrise2 = *sunrise2;
                 const auto middle_of_night = calc.proportional_time(*sunset, *sunrise2, 0.5);
                 info.events.push_back(NamedTimePoint{"middle of the night", middle_of_night});
                 info.events.push_back(NamedTimePoint{"next sunrise", *sunrise2});
@@ -442,6 +764,9 @@ DayByDayInfo daybyday_events(date::year_month_day base_date, const vp::Calc & ca
             }
         }
     }
+    next_carry.next_saura_masa = carry.next_saura_masa;
+    next_carry.next_saura_masa_start = carry.next_saura_masa_start;
+    carry = next_carry;
     return info;
 }
 
@@ -458,7 +783,7 @@ void add_to_sorted(NamedTimePoints & points, NamedTimePoint point) {
         point);
 }
 
-void daybyday_add_sauramasa_info(DayByDayInfo & info, const vp::Calc & calc) {
+void daybyday_add_sauramasa_info(DayByDayInfo & info, const vp::Calc & calc, DayByDayCarry & carry) {
     if (info.events.empty()) {
         return;
     }
@@ -472,7 +797,12 @@ void daybyday_add_sauramasa_info(DayByDayInfo & info, const vp::Calc & calc) {
     const auto last_time = info.events.back().time_point;
 
     const auto next_masa = initial_masa + 1;
-    const auto next_masa_start = calc.find_sankranti(initial_time, next_masa);
+    // sun's longitude only grows, so sankranti found from an earlier time is still the first one if it's later than initial_time
+    const auto next_masa_start = (carry.next_saura_masa == next_masa && carry.next_saura_masa_start > initial_time)
+            ? *carry.next_saura_masa_start
+            : calc.find_sankranti(initial_time, next_masa);
+    carry.next_saura_masa = next_masa;
+    carry.next_saura_masa_start = next_masa_start;
     info.saura_masa_until = next_masa_start;
     if (next_masa_start <= last_time) {
         auto event_name = fmt::format(FMT_STRING("{} sankranti"), next_masa);
@@ -487,26 +817,43 @@ void daybyday_add_chandramasa_info(DayByDayInfo & info, const vp::Calc & calc) {
     const auto initial_time = *info.sunrise1;
     info.chandra_masa = calc.chandra_masa_amanta(initial_time, &info.chandra_masa_until);
 }
-} // anonymous namespace
 
-DayByDayInfo daybyday_calc_one(date::year_month_day base_date, const Location & coord, CalcFlags flags)
+DayByDayInfo daybyday_calc(date::year_month_day base_date, const Location & coord, const vp::Calc & calc, DayByDayCarry & carry)
 {
-    Calc calc{Swe{coord, flags}};
-    DayByDayInfo info = daybyday_events(base_date, calc);
+    DayByDayInfo info = daybyday_events(base_date, calc, carry);
     info.location = coord;
     info.date = base_date;
     std::stable_sort(info.events.begin(), info.events.end(), NamedPointComparator);
-    daybyday_add_sauramasa_info(info, calc);
+    daybyday_add_sauramasa_info(info, calc, carry);
     daybyday_add_chandramasa_info(info, calc);
     return info;
 }
+} // anonymous namespace
+
+DayByDayInfo daybyday_calc_one(date::year_month_day base_date, const Location & coord, CalcFlags flags)
+{
+    Calc calc{Swe{coord, flags}};
+    DayByDayCarry carry;
+    return daybyday_calc(base_date, coord, calc, carry);
+}
+
+std::vector<DayByDayInfo> daybyday_calc_range(date::year_month_day from, date::year_month_day to, const Location & coord, CalcFlags flags)
+{
+    // Neighbouring days look for the same tithis and nakṣatras (and days
+    // overlap by 36 hours for that), so the boundary cache saves most of those.
+    Calc calc{Swe{coord, flags}, make_boundary_cache(flags)};
+    DayByDayCarry carry;
+    std::vector<DayByDayInfo> infos;
+    for (auto day = date::local_days{from}; day <= date::local_days{to}; day += date::days{1}) {
+        infos.push_back(daybyday_calc(date::year_month_day{day}, coord, calc, carry));
+    }
+    return infos;
+}
 
 namespace {
 /* print day-by-day report (-d mode) for a single date and single location */
-void daybyday_print_one(date::year_month_day base_date, const Location & coord, const fmt::appender & out, vp::CalcFlags flags) {
-    auto info = daybyday_calc_one(base_date, coord, flags);
-
-    daybyday_print_header(base_date, coord, info, out);
+void daybyday_print_info(const DayByDayInfo & info, const Location & coord, const fmt::appender & out) {
+    daybyday_print_header(info.date, coord, info, out);
 
     for (const auto & e : info.events) {
         // add separator before sunrises to mark current day better
@@ -516,6 +863,11 @@ void daybyday_print_one(date::year_month_day base_date, const Location & coord,
         fmt::format_to(out, "{} {}\n", vp::JulDays_Zoned{coord.time_zone(), e.time_point}, e.name);
     }
 }
+
+/* print day-by-day report (-d mode) for a single date and single location */
+void daybyday_print_one(date::year_month_day base_date, const Location & coord, const fmt::appender & out, vp::CalcFlags flags) {
+    daybyday_print_info(daybyday_calc_one(base_date, coord, flags), coord, out);
+}
 }
 
 void daybyday_print_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out, vp::CalcFlags flags) {
@@ -527,6 +879,22 @@ void daybyday_print_one(date::year_month_day base_date, const char * location_na
     daybyday_print_one(base_date, *coord, out, flags);
 }
 
+void daybyday_print_range(date::year_month_day from, date::year_month_day to, const char * location_name, const fmt::appender & out, vp::CalcFlags flags) {
+    const std::optional<Location> coord = LocationDb::find_coord(location_name);
+    if (!coord) {
+        fmt::format_to(out, "Location not found: '{}'\n", location_name);
+        return;
+    }
+    bool first = true;
+    for (const auto & info : daybyday_calc_range(from, to, *coord, flags)) {
+        if (!first) {
+            fmt::format_to(out, FMT_STRING("\n"));
+        }
+        first = false;
+        daybyday_print_info(info, *coord, out);
+    }
+}
+
 void calc_and_report_all(date::year_month_day d) {
     for (auto &l : LocationDb()) {
         fmt::memory_buffer buf;
@@ -535,6 +903,20 @@ void calc_and_report_all(date::year_month_day d) {
     }
 }
 
+void grid_calc_and_report(date::year_month_day base_date, const char * time_zone_name, std::istream & in, const fmt::appender & out) {
+    VrataGrid grid{date::local_days{base_date}, time_zone_name};
+    double latitude{};
+    double longitude{};
+    while (in >> latitude >> longitude) {
+        const auto vrata = grid.find(Location{Latitude{latitude}, Longitude{longitude}, "Custom Location", time_zone_name});
+        if (vrata) {
+            fmt::format_to(out, FMT_STRING("{} {} {}\n"), latitude, longitude, *vrata);
+        } else {
+            fmt::format_to(out, FMT_STRING("{} {} error: {}\n"), latitude, longitude, vrata.error());
+        }
+    }
+}
+
 namespace detail {
     fs::path determine_exe_dir(const char* argv0) {
         return fs::absolute(fs::path{argv0}).parent_path();
@@ -1,17 +1,26 @@
 #ifndef VP_SRC_TEXT_INTERFACE_H
 #define VP_SRC_TEXT_INTERFACE_H
 
+#include "boundary-cache.h"
 #include "calc-flags.h"
+#include "cancellation.h"
 #include "location.h"
 #include "nakshatra.h"
 #include "tz-fixed.h"
 #include "vrata.h"
+#include "vrata-parts.h"
+#include "vrata-preview.h"
 
 #include <chrono>
 #include "filesystem-fixed.h"
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <tl/expected.hpp>
 #include <unordered_map>
+#include <vector>
 
 namespace vp::text_ui {
 
@@ -48,14 +57,76 @@ void change_to_data_dir(const char* argv0);
 
 date::year_month_day parse_ymd(const std::string_view s);
 
-tl::expected<vp::Vrata, vp::CalcError> calc_and_report_one(date::year_month_day base_date, const Location & coord, const fmt::appender & out);
+tl::expected<vp::Vrata, vp::CalcError> calc_and_report_one(date::year_month_day base_date, const Location & coord, const fmt::appender & out, CalcFlags flags = CalcFlags::Default);
 // Find next ekAdashI vrata for the named location, report details to the output buffer.
-tl::expected<vp::Vrata, vp::CalcError> find_calc_and_report_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out);
+tl::expected<vp::Vrata, vp::CalcError> find_calc_and_report_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out, CalcFlags flags = CalcFlags::Default);
 
 DayByDayInfo daybyday_calc_one(date::year_month_day base_date, const Location & coord, vp::CalcFlags flags);
+// Same as daybyday_calc_one() for each date in [from, to], but much cheaper than that:
+// each day takes sunrise, sunset and saṅkrānti from the previous day when they are the same,
+// and tithi/nakṣatra starts found for one day are reused for the next ones.
+std::vector<DayByDayInfo> daybyday_calc_range(date::year_month_day from, date::year_month_day to, const Location & coord, vp::CalcFlags flags);
 void daybyday_print_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out, vp::CalcFlags flags);
+void daybyday_print_range(date::year_month_day from, date::year_month_day to, const char * location_name, const fmt::appender & out, vp::CalcFlags flags);
 void calc_and_report_all(date::year_month_day d);
-vp::VratasForDate calc(date::year_month_day base_date, std::string location_name, CalcFlags flags = CalcFlags::Default);
+// Find next ekAdashI vratas for many coordinates in the same time zone ("latitude longitude" per line of input),
+// report one line per coordinate. Uses VrataGrid, so times are interpolated for most of the coordinates.
+void grid_calc_and_report(date::year_month_day base_date, const char * time_zone_name, std::istream & in, const fmt::appender & out);
+// Resulting vratas (and their nameworthy dates) are allocated from the given memory resource,
+// so passing std::pmr::monotonic_buffer_resource makes the whole result live in one region.
+// Tithi and nakṣatra starts are reused from (and added to) boundary_cache, if given: e.g. GUI keeps one
+// for the session, so that changing sunrise/sunset flags doesn't find them again. Without it,
+// the call uses a cache of its own. boundary_cache must not be used by other threads meanwhile.
+// Only the given parts are calculated for a single location (see Calc::find_next_vrata()), and nameworthy
+// dates only with VrataParts::NameworthyDates. Vratas for "all" and from the vrata db may have more.
+// Throws Cancelled once cancellation is cancelled.
+vp::VratasForDate calc(date::year_month_day base_date, std::string location_name, CalcFlags flags = CalcFlags::Default,
+                       std::pmr::memory_resource * resource = std::pmr::get_default_resource(),
+                       std::shared_ptr<BoundaryCache> boundary_cache = nullptr, const CancellationToken & cancellation = {},
+                       VrataParts parts = VrataParts::All);
+// Find next ekAdashI vrata for the location, always calculating it (never taken from the vrata db).
+// Tithi and nakṣatra starts are reused from (and added to) boundary_cache, if given.
+// Only the given parts of vrata are calculated, see Calc::find_next_vrata().
+// Throws Cancelled once cancellation is cancelled.
+tl::expected<vp::Vrata, vp::CalcError> calc_one(date::local_days base_date, const Location & location, CalcFlags flags = CalcFlags::Default,
+                                                std::shared_ptr<BoundaryCache> boundary_cache = nullptr, VrataParts parts = VrataParts::All,
+                                                const CancellationToken & cancellation = {});
+// Same vrata as calc_one(), but taken from the vrata db when it's there (with all the parts then).
+tl::expected<vp::Vrata, vp::CalcError> find_next(date::local_days base_date, const Location & location, CalcFlags flags = CalcFlags::Default,
+                                                 std::shared_ptr<BoundaryCache> boundary_cache = nullptr, VrataParts parts = VrataParts::All,
+                                                 const CancellationToken & cancellation = {});
+// Fast answer for interactive browsing: next vrata date and type (and pakṣa) for the named location
+// (or all of them) by preview_next_vrata(). Empty for unknown location names.
+std::vector<VrataPreview> preview(date::year_month_day base_date, const std::string & location_name, CalcFlags flags = CalcFlags::Default);
+// Exact vrata dates and types for the previews: uncertain ones are calculated in full (as by find_next()),
+// the rest are taken as they are. Gives the same dates and types as calc_one() for each location.
+std::vector<MaybeVrata> refine_previews(date::year_month_day base_date, const std::vector<VrataPreview> & previews, CalcFlags flags = CalcFlags::Default);
+
+// Settings below (dbs, threads) and Swe::set_ephemeris_path() are meant for startup: they aren't synchronized
+// with calculations running on other threads (and locations from the place db point into its data).
+// Calculations themselves can run on several threads at once: caches are per call (or passed in),
+// except calc()'s results for all locations, which are shared under a lock.
+
+// Answer calc() and other requests from the precalculated vrata db file (see VrataDb) whenever possible.
+// Returns false if the file is missing or can't be used; everything gets calculated then, as usual.
+bool use_vrata_db(const fs::path & path);
+// Precalculate vratas for all LocationDb locations for base dates in [from, to] and save them to the file.
+// progress is called after every location with the number of locations done and overall.
+void generate_vrata_db(const fs::path & path, date::local_days from, date::local_days to, CalcFlags flags = CalcFlags::Default,
+                       const std::function<void(std::size_t done, std::size_t total)> & progress = {});
+// Look up names missing from the built-in locations in the place db file (see PlaceDb).
+// Returns false if the file is missing or can't be used; only built-in locations are known then.
+bool use_place_db(const fs::path & path);
+// Find time zones of arbitrary coordinates in the time zone db file (see TimeZoneDb).
+// Returns false if the file is missing or can't be used; time zones are guessed by longitude then.
+bool use_time_zone_db(const fs::path & path);
+// Time zone name for the coordinates: from the time zone db when it knows them, Etc/GMT±N by longitude otherwise.
+std::string_view time_zone_for(Coord coord);
+// "Custom Location" at the coordinates, with time zone by time_zone_for()
+Location custom_location(Coord coord);
+// Threads for calculating all locations in calc(..., "all", ...): 1 (default) does them one by one
+// on the calling thread, 0 means one per CPU core.
+void set_calc_threads(unsigned count);
 std::string program_name_and_version();
 
 class LocationDb {
@@ -63,7 +134,13 @@ public:
 
     auto begin() { return locations().cbegin(); }
     auto end() { return locations().cend(); }
+    static std::size_t size() { return locations().size(); }
+    // built-in locations first, then the place db (see use_place_db())
     static std::optional<Location> find_coord(const char *location_name);
+    // Up to max_count locations with names starting with prefix (case-insensitive for ASCII letters), built-in ones first.
+    static std::vector<Location> find_by_prefix(std::string_view prefix, std::size_t max_count);
+    // Closest built-in or place db location.
+    static Location find_nearest(Coord coord);
 
 private:
     static const std::vector<Location> & locations();
@@ -0,0 +1,83 @@
+#include "time-format.h"
+
+#include <cstdlib>
+
+namespace vp {
+
+namespace {
+void append_2_digits(fmt::memory_buffer & out, long long value) {
+    const char digits[2] = {static_cast<char>('0' + value / 10), static_cast<char>('0' + value % 10)};
+    out.append(digits, digits + 2);
+}
+
+// seconds since local midnight
+long long time_of_day(date::local_seconds t) {
+    return (t - date::floor<date::days>(t)).count();
+}
+} // anonymous namespace
+
+void format_hh_mm(fmt::memory_buffer & out, date::local_seconds t)
+{
+    const auto seconds = time_of_day(t);
+    append_2_digits(out, seconds / 3600);
+    out.push_back(':');
+    append_2_digits(out, seconds / 60 % 60);
+}
+
+void format_hh_mm_ss(fmt::memory_buffer & out, date::local_seconds t)
+{
+    format_hh_mm(out, t);
+    out.push_back(':');
+    append_2_digits(out, time_of_day(t) % 60);
+}
+
+void format_iso_date(fmt::memory_buffer & out, date::local_days d)
+{
+    const date::year_month_day ymd{d};
+    const int year = static_cast<int>(ymd.year());
+    if (year >= 0 && year <= 9999) {
+        append_2_digits(out, year / 100);
+        append_2_digits(out, year % 100);
+    } else {
+        fmt::format_to(fmt::appender{out}, FMT_STRING("{:04}"), year);
+    }
+    out.push_back('-');
+    append_2_digits(out, static_cast<unsigned>(ymd.month()));
+    out.push_back('-');
+    append_2_digits(out, static_cast<unsigned>(ymd.day()));
+}
+
+void format_utc_offset(fmt::memory_buffer & out, std::chrono::seconds offset)
+{
+    long long seconds = offset.count();
+    out.push_back(seconds < 0 ? '-' : '+');
+    seconds = std::abs(seconds);
+    const auto hours = seconds / 3600;
+    if (hours >= 10) {
+        append_2_digits(out, hours);
+    } else {
+        out.push_back(static_cast<char>('0' + hours));
+    }
+    out.push_back(':');
+    append_2_digits(out, seconds / 60 % 60);
+    if (seconds % 60 != 0) {
+        out.push_back(':');
+        append_2_digits(out, seconds % 60);
+    }
+}
+
+std::string hh_mm(date::local_seconds t)
+{
+    fmt::memory_buffer buf;
+    format_hh_mm(buf, t);
+    return fmt::to_string(buf);
+}
+
+std::string hh_mm_ss(date::local_seconds t)
+{
+    fmt::memory_buffer buf;
+    format_hh_mm_ss(buf, t);
+    return fmt::to_string(buf);
+}
+
+} // namespace vp
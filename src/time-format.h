@@ -0,0 +1,31 @@
+#ifndef VP_TIME_FORMAT_H
+#define VP_TIME_FORMAT_H
+
+#include "date-fixed.h"
+#include "fmt-format-fixed.h"
+
+#include <chrono>
+#include <string>
+
+namespace vp {
+
+// Write local times and dates straight into the buffer. Output is the same as
+// date::format() with the format in the comment, but without going through
+// std::ostringstream and locales for every call, which matters for tables and
+// detailed reports with thousands of time points.
+
+// "%H:%M"
+void format_hh_mm(fmt::memory_buffer & out, date::local_seconds t);
+// "%H:%M:%S"
+void format_hh_mm_ss(fmt::memory_buffer & out, date::local_seconds t);
+// "%Y-%m-%d"
+void format_iso_date(fmt::memory_buffer & out, date::local_days d);
+// "+5:30", "-3:00", or "+2:02:04" when offset is not a whole number of minutes
+void format_utc_offset(fmt::memory_buffer & out, std::chrono::seconds offset);
+
+std::string hh_mm(date::local_seconds t);
+std::string hh_mm_ss(date::local_seconds t);
+
+} // namespace vp
+
+#endif // VP_TIME_FORMAT_H
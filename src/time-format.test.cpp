@@ -0,0 +1,49 @@
+#include "catch-formatters.h"
+
+#include "time-format.h"
+#include "tz-fixed.h"
+
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+template<class Writer>
+std::string written(Writer writer) {
+    fmt::memory_buffer buf;
+    writer(buf);
+    return fmt::to_string(buf);
+}
+}
+
+TEST_CASE("format_hh_mm() and format_hh_mm_ss() give the same as date::format()") {
+    const auto seconds = GENERATE(as<local_seconds>{},
+        local_days{2021_y/February/1},
+        local_days{2021_y/February/1} + 7h + 5min + 9s,
+        local_days{2021_y/February/1} + 23h + 59min + 59s,
+        local_days{1899_y/December/31} + 12h + 30min,
+        local_days{2100_y/March/1} + 1h);
+    CAPTURE(seconds.time_since_epoch().count());
+    REQUIRE(vp::hh_mm(seconds) == date::format("%H:%M", seconds));
+    REQUIRE(vp::hh_mm_ss(seconds) == date::format("%H:%M:%S", seconds));
+    REQUIRE(written([&](auto & buf) { vp::format_iso_date(buf, floor<days>(seconds)); }) == date::format("%Y-%m-%d", floor<days>(seconds)));
+}
+
+TEST_CASE("format_utc_offset()") {
+    REQUIRE(written([](auto & buf) { vp::format_utc_offset(buf, 0s); }) == "+0:00");
+    REQUIRE(written([](auto & buf) { vp::format_utc_offset(buf, 5h + 30min); }) == "+5:30");
+    REQUIRE(written([](auto & buf) { vp::format_utc_offset(buf, -3h); }) == "-3:00");
+    REQUIRE(written([](auto & buf) { vp::format_utc_offset(buf, 12h + 45min); }) == "+12:45");
+    // pre-standard local mean times
+    REQUIRE(written([](auto & buf) { vp::format_utc_offset(buf, 2h + 2min + 4s); }) == "+2:02:04");
+}
+
+TEST_CASE("Formatting functions append to the buffer") {
+    fmt::memory_buffer buf;
+    const local_seconds t{local_days{2021_y/February/1} + 6h + 7min + 8s};
+    vp::format_iso_date(buf, floor<days>(t));
+    buf.push_back(' ');
+    vp::format_hh_mm_ss(buf, t);
+    buf.push_back(' ');
+    vp::format_utc_offset(buf, 5h + 30min);
+    REQUIRE(fmt::to_string(buf) == "2021-02-01 06:07:08 +5:30");
+}
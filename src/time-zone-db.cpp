@@ -0,0 +1,389 @@
+#include "time-zone-db.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+
+namespace vp {
+
+namespace {
+constexpr char magic[4] = {'V', 'P', 'T', 'Z'};
+constexpr std::uint32_t byte_order_mark = 0x01020304;
+constexpr std::uint64_t section_alignment = 8;
+// 1/64° cells would already take hundreds of megabytes
+constexpr std::uint32_t max_cells_per_degree = 64;
+
+constexpr std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+// Mapped memory has no objects of our types in it, so copy them out instead of casting pointers.
+template<typename T>
+T read_at(const unsigned char * base, std::uint64_t offset, std::size_t index) {
+    T value;
+    std::memcpy(&value, base + offset + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+bool section_fits(std::uint64_t offset, std::uint64_t count, std::uint64_t element_size, std::size_t file_size) {
+    if (offset % section_alignment != 0 || offset > file_size) return false;
+    return count <= (file_size - offset) / element_size;
+}
+
+struct XY {
+    double x; // longitude
+    double y; // latitude
+};
+
+XY to_xy(TimeZoneDb::Point p) {
+    return XY{static_cast<double>(p.longitude), static_cast<double>(p.latitude)};
+}
+
+// Points on the line count as being on the left, so that a path going exactly
+// through a vertex crosses exactly one of its two edges.
+bool left_of(XY a, XY b, XY p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x) >= 0;
+}
+
+bool segments_cross(XY from, XY to, XY a, XY b) {
+    return left_of(from, to, a) != left_of(from, to, b) && left_of(a, b, from) != left_of(a, b, to);
+}
+
+// Zones whose boundaries were crossed an odd number of times on the way
+class Crossings {
+public:
+    void toggle(std::uint32_t zone) {
+        const auto it = std::find(odd_.begin(), odd_.end(), zone);
+        if (it == odd_.end()) {
+            odd_.push_back(zone);
+        } else {
+            odd_.erase(it);
+        }
+    }
+    // zone at the end of the way when it started in start_zone
+    std::uint32_t result(std::uint32_t start_zone) const {
+        const bool left_start_zone = std::find(odd_.begin(), odd_.end(), start_zone) != odd_.end();
+        if (start_zone != TimeZoneDb::NoZone && !left_start_zone) return start_zone;
+        for (const auto zone : odd_) {
+            if (zone != start_zone) return zone;
+        }
+        return TimeZoneDb::NoZone;
+    }
+private:
+    std::vector<std::uint32_t> odd_;
+};
+
+double normalized_longitude(double longitude) {
+    double l = std::fmod(longitude + 180.0, 360.0);
+    if (l < 0) l += 360.0;
+    return l - 180.0;
+}
+
+// floor() of cell coordinates, so the west and south edges belong to the cell and the east and north ones don't
+std::size_t grid_index(double value, double min_value, std::uint32_t cells_per_degree, std::size_t count) {
+    const double index = std::floor((value - min_value) * cells_per_degree);
+    if (!(index > 0)) return 0;
+    return std::min(static_cast<std::size_t>(index), count - 1);
+}
+
+XY cell_center(std::size_t column, std::size_t row, std::uint32_t cells_per_degree) {
+    return XY{-180.0 + (static_cast<double>(column) + 0.5) / cells_per_degree,
+              -90.0 + (static_cast<double>(row) + 0.5) / cells_per_degree};
+}
+} // anonymous namespace
+
+std::optional<TimeZoneDb> TimeZoneDb::open(const fs::path & path)
+{
+    auto file = MappedFile::open(path);
+    if (!file || file->size() < sizeof(Header)) return std::nullopt;
+    const auto header = read_at<Header>(file->data(), 0, 0);
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+            || header.version != Version
+            || header.byte_order_mark != byte_order_mark
+            || header.cells_per_degree == 0 || header.cells_per_degree > max_cells_per_degree) {
+        return std::nullopt;
+    }
+    const auto size = file->size();
+    const auto cell_count = std::uint64_t{360} * header.cells_per_degree * 180 * header.cells_per_degree;
+    if (!section_fits(header.zones_offset, header.zone_count, sizeof(ZoneEntry), size)
+            || !section_fits(header.points_offset, header.point_count, sizeof(Point), size)
+            || !section_fits(header.cells_offset, cell_count + 1, sizeof(Cell), size)
+            || !section_fits(header.cell_entries_offset, header.cell_entry_count, sizeof(CellEntry), size)
+            || !section_fits(header.names_offset, header.names_size, 1, size)) {
+        return std::nullopt;
+    }
+    TimeZoneDb db{std::move(*file)};
+    db.header_ = header;
+    // Check zones and cells once here. Cell entries are too many to read on every start,
+    // find() checks the ones it uses.
+    for (std::size_t i = 0; i < header.zone_count; ++i) {
+        const auto zone = read_at<ZoneEntry>(db.file_.data(), header.zones_offset, i);
+        if (std::uint64_t{zone.name_offset} + zone.name_length > header.names_size) return std::nullopt;
+    }
+    std::uint32_t previous_first_entry = 0;
+    for (std::size_t i = 0; i <= cell_count; ++i) {
+        const auto c = db.cell(i);
+        if (c.first_entry < previous_first_entry || c.first_entry > header.cell_entry_count
+                || (c.center_zone != NoZone && c.center_zone >= header.zone_count)) {
+            return std::nullopt;
+        }
+        previous_first_entry = c.first_entry;
+    }
+    return db;
+}
+
+TimeZoneDb::TimeZoneDb(MappedFile file) : file_(std::move(file))
+{}
+
+TimeZoneDb::Point TimeZoneDb::point(std::size_t index) const
+{
+    return read_at<Point>(file_.data(), header_.points_offset, index);
+}
+
+TimeZoneDb::Cell TimeZoneDb::cell(std::size_t index) const
+{
+    return read_at<Cell>(file_.data(), header_.cells_offset, index);
+}
+
+TimeZoneDb::CellEntry TimeZoneDb::cell_entry(std::size_t index) const
+{
+    return read_at<CellEntry>(file_.data(), header_.cell_entries_offset, index);
+}
+
+std::string_view TimeZoneDb::zone_name(std::uint32_t zone) const
+{
+    const auto entry = read_at<ZoneEntry>(file_.data(), header_.zones_offset, zone);
+    const auto * names = reinterpret_cast<const char *>(file_.data() + header_.names_offset);
+    return std::string_view{names + entry.name_offset, entry.name_length};
+}
+
+std::string_view TimeZoneDb::find(Coord coord) const
+{
+    const XY target{normalized_longitude(coord.longitude.longitude), std::clamp(coord.latitude.latitude, -90.0, 90.0)};
+    const auto column = grid_index(target.x, -180.0, header_.cells_per_degree, columns());
+    const auto row = grid_index(target.y, -90.0, header_.cells_per_degree, rows());
+    const auto index = row * columns() + column;
+    const auto c = cell(index);
+    const auto end = cell(index + 1).first_entry;
+    const auto center = cell_center(column, row, header_.cells_per_degree);
+    Crossings crossings;
+    for (auto i = c.first_entry; i < end; ++i) {
+        const auto entry = cell_entry(i);
+        if (std::uint64_t{entry.edge} + 1 >= header_.point_count || entry.zone >= header_.zone_count) continue;
+        if (segments_cross(center, target, to_xy(point(entry.edge)), to_xy(point(entry.edge + 1)))) {
+            crossings.toggle(entry.zone);
+        }
+    }
+    const auto zone = crossings.result(c.center_zone);
+    if (zone == NoZone) return {};
+    return zone_name(zone);
+}
+
+bool TimeZoneDbWriter::add_ring(std::string_view time_zone, const std::vector<Coord> & ring)
+{
+    if (ring.size() < 3 || time_zone.empty()) return false;
+    // rings of a zone usually come one after another
+    std::size_t zone = zone_names_.size();
+    if (!zone_names_.empty() && zone_names_.back() == time_zone) {
+        zone = zone_names_.size() - 1;
+    } else if (const auto it = std::find(zone_names_.begin(), zone_names_.end(), time_zone); it != zone_names_.end()) {
+        zone = static_cast<std::size_t>(it - zone_names_.begin());
+    } else {
+        zone_names_.emplace_back(time_zone);
+    }
+    Ring r;
+    r.zone = static_cast<std::uint32_t>(zone);
+    r.points.reserve(ring.size() + 1);
+    for (const auto & coord : ring) {
+        r.points.push_back(TimeZoneDb::Point{static_cast<float>(coord.longitude.longitude), static_cast<float>(coord.latitude.latitude)});
+    }
+    const auto & first = r.points.front();
+    const auto & last = r.points.back();
+    if (first.longitude != last.longitude || first.latitude != last.latitude) {
+        r.points.push_back(first);
+    }
+    rings_.push_back(std::move(r));
+    return true;
+}
+
+std::size_t TimeZoneDbWriter::add_rings(std::istream & in)
+{
+    std::size_t added = 0;
+    std::string line;
+    std::vector<Coord> ring;
+    while (std::getline(in, line)) {
+        const auto tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        ring.clear();
+        const char * p = line.c_str() + tab + 1;
+        bool malformed = false;
+        while (*p != '\0' && *p != '\r') {
+            char * end = nullptr;
+            const double longitude = std::strtod(p, &end);
+            if (end == p || *end != ',') { malformed = true; break; }
+            p = end + 1;
+            const double latitude = std::strtod(p, &end);
+            if (end == p) { malformed = true; break; }
+            ring.push_back(Coord{Latitude{latitude}, Longitude{longitude}});
+            p = end;
+            while (*p == ' ') ++p;
+        }
+        if (!malformed && add_ring(std::string_view{line}.substr(0, tab), ring)) ++added;
+    }
+    return added;
+}
+
+void TimeZoneDbWriter::write(const fs::path & path, std::uint32_t cells_per_degree) const
+{
+    if (cells_per_degree == 0 || cells_per_degree > max_cells_per_degree) {
+        throw std::runtime_error("unsupported time zone db cell size");
+    }
+    const std::size_t columns = 360 * std::size_t{cells_per_degree};
+    const std::size_t rows = 180 * std::size_t{cells_per_degree};
+
+    std::vector<TimeZoneDb::Point> points;
+    std::vector<std::vector<TimeZoneDb::CellEntry>> cells(columns * rows);
+    for (const auto & ring : rings_) {
+        const auto first = points.size();
+        points.insert(points.end(), ring.points.begin(), ring.points.end());
+        if (points.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("too many points for time zone db");
+        }
+        for (auto edge = first; edge + 1 < points.size(); ++edge) {
+            const auto a = to_xy(points[edge]);
+            const auto b = to_xy(points[edge + 1]);
+            const auto first_column = grid_index(std::min(a.x, b.x), -180.0, cells_per_degree, columns);
+            const auto last_column = grid_index(std::max(a.x, b.x), -180.0, cells_per_degree, columns);
+            const auto first_row = grid_index(std::min(a.y, b.y), -90.0, cells_per_degree, rows);
+            const auto last_row = grid_index(std::max(a.y, b.y), -90.0, cells_per_degree, rows);
+            for (auto row = first_row; row <= last_row; ++row) {
+                for (auto column = first_column; column <= last_column; ++column) {
+                    cells[row * columns + column].push_back(TimeZoneDb::CellEntry{static_cast<std::uint32_t>(edge), ring.zone});
+                }
+            }
+        }
+    }
+
+    // Zone of the first cell center by casting a ray to the east through everything,
+    // zones of the rest by walking from the neighbour's center (first column up, then every row to the east).
+    std::vector<std::uint32_t> center_zones(cells.size(), TimeZoneDb::NoZone);
+    {
+        const auto p = cell_center(0, 0, cells_per_degree);
+        Crossings crossings;
+        for (const auto & ring : rings_) {
+            for (std::size_t i = 0; i + 1 < ring.points.size(); ++i) {
+                const auto a = to_xy(ring.points[i]);
+                const auto b = to_xy(ring.points[i + 1]);
+                if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+                    crossings.toggle(ring.zone);
+                }
+            }
+        }
+        center_zones[0] = crossings.result(TimeZoneDb::NoZone);
+    }
+    const auto walk = [&](std::size_t from_column, std::size_t from_row, std::size_t to_column, std::size_t to_row) {
+        const auto from_index = from_row * columns + from_column;
+        const auto to_index = to_row * columns + to_column;
+        const auto from = cell_center(from_column, from_row, cells_per_degree);
+        const auto to = cell_center(to_column, to_row, cells_per_degree);
+        Crossings crossings;
+        const auto check = [&](const TimeZoneDb::CellEntry & entry) {
+            if (segments_cross(from, to, to_xy(points[entry.edge]), to_xy(points[entry.edge + 1]))) {
+                crossings.toggle(entry.zone);
+            }
+        };
+        // the way lies within both cells; edges in both of them (sorted by edge) must be checked once
+        const auto & one = cells[from_index];
+        const auto & other = cells[to_index];
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < one.size() || j < other.size()) {
+            if (j == other.size() || (i < one.size() && one[i].edge < other[j].edge)) {
+                check(one[i++]);
+            } else if (i == one.size() || other[j].edge < one[i].edge) {
+                check(other[j++]);
+            } else {
+                check(one[i++]);
+                ++j;
+            }
+        }
+        center_zones[to_index] = crossings.result(center_zones[from_index]);
+    };
+    for (std::size_t row = 0; row < rows; ++row) {
+        if (row > 0) walk(0, row - 1, 0, row);
+        for (std::size_t column = 1; column < columns; ++column) {
+            walk(column - 1, row, column, row);
+        }
+    }
+
+    std::vector<TimeZoneDb::Cell> cell_table;
+    cell_table.reserve(cells.size() + 1);
+    std::vector<TimeZoneDb::CellEntry> entries;
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        cell_table.push_back(TimeZoneDb::Cell{static_cast<std::uint32_t>(entries.size()), center_zones[i]});
+        entries.insert(entries.end(), cells[i].begin(), cells[i].end());
+        if (entries.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("too many edges for time zone db, try fewer cells per degree");
+        }
+    }
+    cell_table.push_back(TimeZoneDb::Cell{static_cast<std::uint32_t>(entries.size()), TimeZoneDb::NoZone});
+
+    std::string names;
+    std::vector<TimeZoneDb::ZoneEntry> zones;
+    for (const auto & name : zone_names_) {
+        zones.push_back(TimeZoneDb::ZoneEntry{static_cast<std::uint32_t>(names.size()), static_cast<std::uint32_t>(name.size())});
+        names += name;
+    }
+
+    TimeZoneDb::Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = TimeZoneDb::Version;
+    header.byte_order_mark = byte_order_mark;
+    header.zone_count = static_cast<std::uint32_t>(zones.size());
+    header.point_count = static_cast<std::uint32_t>(points.size());
+    header.cells_per_degree = cells_per_degree;
+    header.cell_entry_count = static_cast<std::uint32_t>(entries.size());
+    header.names_size = static_cast<std::uint32_t>(names.size());
+    header.zones_offset = align_up(sizeof(header));
+    header.points_offset = align_up(header.zones_offset + zones.size() * sizeof(TimeZoneDb::ZoneEntry));
+    header.cells_offset = align_up(header.points_offset + points.size() * sizeof(TimeZoneDb::Point));
+    header.cell_entries_offset = align_up(header.cells_offset + cell_table.size() * sizeof(TimeZoneDb::Cell));
+    header.names_offset = align_up(header.cell_entries_offset + entries.size() * sizeof(TimeZoneDb::CellEntry));
+
+    std::ofstream f{path, std::ios::binary | std::ios::trunc};
+    const auto write_section = [&f](std::uint64_t offset, const void * data, std::size_t size) {
+        // zero padding up to the section start
+        static constexpr char zeros[section_alignment] = {};
+        const auto current = static_cast<std::uint64_t>(f.tellp());
+        f.write(zeros, static_cast<std::streamsize>(offset - current));
+        f.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+    write_section(0, &header, sizeof(header));
+    write_section(header.zones_offset, zones.data(), zones.size() * sizeof(TimeZoneDb::ZoneEntry));
+    write_section(header.points_offset, points.data(), points.size() * sizeof(TimeZoneDb::Point));
+    write_section(header.cells_offset, cell_table.data(), cell_table.size() * sizeof(TimeZoneDb::Cell));
+    write_section(header.cell_entries_offset, entries.data(), entries.size() * sizeof(TimeZoneDb::CellEntry));
+    write_section(header.names_offset, names.data(), names.size());
+    if (!f) {
+        throw std::runtime_error("can't write time zone db file " + path.string());
+    }
+}
+
+// Etc/GMT zones have the opposite sign: Etc/GMT-5 is UTC+5
+const char * approximate_time_zone(Longitude longitude) {
+    static const char * const zones[] = {
+        "Etc/GMT+12", "Etc/GMT+11", "Etc/GMT+10", "Etc/GMT+9", "Etc/GMT+8", "Etc/GMT+7", "Etc/GMT+6",
+        "Etc/GMT+5", "Etc/GMT+4", "Etc/GMT+3", "Etc/GMT+2", "Etc/GMT+1", "Etc/GMT",
+        "Etc/GMT-1", "Etc/GMT-2", "Etc/GMT-3", "Etc/GMT-4", "Etc/GMT-5", "Etc/GMT-6",
+        "Etc/GMT-7", "Etc/GMT-8", "Etc/GMT-9", "Etc/GMT-10", "Etc/GMT-11", "Etc/GMT-12",
+    };
+    const auto hours = std::clamp(std::lround(longitude.longitude / 15.0), -12L, 12L);
+    return zones[static_cast<std::size_t>(hours + 12)];
+}
+
+} // namespace vp
@@ -0,0 +1,121 @@
+#ifndef VP_TIME_ZONE_DB_H
+#define VP_TIME_ZONE_DB_H
+
+#include "filesystem-fixed.h"
+#include "location.h"
+#include "mapped-file.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vp {
+
+/* Time zone boundary polygons (e.g. from timezone-boundary-builder) in a memory-mapped
+ * file, for finding time zones of arbitrary coordinates offline.
+ *
+ * Coordinates are treated as planar (longitude, latitude). The globe is split into
+ * grid cells; every cell lists boundary edges which might cross it and knows the time zone
+ * of its center. find() only checks the edges of one cell: crossing the boundary of a zone
+ * an odd number of times on the way from the center to the point means entering or leaving
+ * that zone.
+ *
+ * File layout (native byte order, every section starts at a multiple of 8):
+ *   Header
+ *   ZoneEntry[zone_count]
+ *   Point[point_count]: rings of all zones one after another
+ *   Cell[cell count + 1]: grid row by row from the south-west corner; the last one only ends the entries
+ *   CellEntry[cell_entry_count]
+ *   names: time zone names (not zero-terminated)
+ * Bump Version whenever the layout or meaning of any field changes.
+ */
+class TimeZoneDb {
+public:
+    static constexpr std::uint32_t Version = 1;
+    // looked up in the data dir (see text_ui::change_to_data_dir())
+    static constexpr const char * DefaultFileName = "timezones.vptz";
+    static constexpr std::uint32_t NoZone = 0xFFFFFFFF;
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byte_order_mark; // 0x01020304 written in native byte order
+        std::uint32_t zone_count;
+        std::uint32_t point_count;
+        std::uint32_t cells_per_degree;
+        std::uint32_t cell_entry_count;
+        std::uint32_t names_size;
+        std::uint64_t zones_offset;
+        std::uint64_t points_offset;
+        std::uint64_t cells_offset;
+        std::uint64_t cell_entries_offset;
+        std::uint64_t names_offset;
+    };
+    struct ZoneEntry {
+        std::uint32_t name_offset; // within names section
+        std::uint32_t name_length;
+    };
+    struct Point {
+        float longitude;
+        float latitude;
+    };
+    struct Cell {
+        std::uint32_t first_entry; // entries up to the next cell's first_entry
+        std::uint32_t center_zone; // NoZone if the center is not in any zone
+    };
+    struct CellEntry {
+        std::uint32_t edge; // from points[edge] to points[edge + 1]
+        std::uint32_t zone;
+    };
+
+    // nullopt if the file is missing, truncated or written by a different version
+    static std::optional<TimeZoneDb> open(const fs::path & path);
+
+    std::size_t zone_count() const { return header_.zone_count; }
+    // Name of the time zone containing the coordinates, empty if there is none (e.g. at sea).
+    // Points right on a boundary may go either way.
+    std::string_view find(Coord coord) const;
+
+private:
+    explicit TimeZoneDb(MappedFile file);
+    std::size_t columns() const { return 360 * std::size_t{header_.cells_per_degree}; }
+    std::size_t rows() const { return 180 * std::size_t{header_.cells_per_degree}; }
+    Point point(std::size_t index) const;
+    Cell cell(std::size_t index) const;
+    CellEntry cell_entry(std::size_t index) const;
+    std::string_view zone_name(std::uint32_t zone) const;
+
+    MappedFile file_;
+    Header header_{};
+};
+
+// Collects time zone polygons and writes them out in the TimeZoneDb format.
+class TimeZoneDbWriter {
+public:
+    // One polygon ring (outer or hole: rings of a zone are combined by even-odd rule),
+    // longitudes in -180..180. Rings with less than 3 points are rejected.
+    bool add_ring(std::string_view time_zone, const std::vector<Coord> & ring);
+    // Adds rings from lines like "Europe/Kyiv<TAB>lng,lat lng,lat ..." (one ring per line,
+    // see scripts/timezones-to-rings.js). Returns the number of rings added; malformed lines are skipped.
+    std::size_t add_rings(std::istream & in);
+    // throws std::runtime_error if the file can't be written
+    void write(const fs::path & path, std::uint32_t cells_per_degree = 2) const;
+
+private:
+    struct Ring {
+        std::uint32_t zone;
+        std::vector<TimeZoneDb::Point> points; // closed: last one is the same as the first one
+    };
+    std::vector<std::string> zone_names_;
+    std::vector<Ring> rings_;
+};
+
+// Etc/GMT±N zone by longitude alone, for when nothing better is known
+const char * approximate_time_zone(Longitude longitude);
+
+} // namespace vp
+
+#endif // VP_TIME_ZONE_DB_H
@@ -0,0 +1,114 @@
+#include "catch-formatters.h"
+
+#include "temp-files.h"
+#include "text-interface.h"
+#include "time-zone-db.h"
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+vp::Coord at(double latitude, double longitude) {
+    return vp::Coord{vp::Latitude{latitude}, vp::Longitude{longitude}};
+}
+
+constexpr double circle_latitude = 50.0;
+constexpr double circle_longitude = 100.0;
+constexpr double circle_radius = 20.0;
+
+// Square with an enclave, a zone on both sides of the antimeridian, a triangle and a many-sided "circle".
+test_files::TempFile write_test_db(std::uint32_t cells_per_degree) {
+    vp::TimeZoneDbWriter writer;
+    std::istringstream rings{
+        "Test/Square\t0,0 10,0 10,10 0,10 0,0\n"
+        "Test/Square\t4,4 6,4 6,6 4,6\n"
+        "Test/Enclave\t4,4 6,4 6,6 4,6 4,4\n"
+        "Test/Antimeridian\t170,-10 180,-10 180,10 170,10\n"
+        "Test/Antimeridian\t-180,-10 -170,-10 -170,10 -180,10\n"
+        "Test/Broken\t1,2 3\n"
+        "Test/Triangle\t20,-30 60,-30 40,30\n"};
+    REQUIRE(writer.add_rings(rings) == 6);
+    std::vector<vp::Coord> circle;
+    constexpr int sides = 10000;
+    for (int i = 0; i < sides; ++i) {
+        const double angle = 2 * 3.14159265358979323846 * i / sides;
+        circle.push_back(at(circle_latitude + circle_radius * std::sin(angle), circle_longitude + circle_radius * std::cos(angle)));
+    }
+    REQUIRE(writer.add_ring("Test/Circle", circle));
+    REQUIRE_FALSE(writer.add_ring("Test/TooSmall", {at(0, 0), at(1, 1)}));
+
+    test_files::TempFile file{"time-zone-db-test-" + std::to_string(cells_per_degree), ".vptz"};
+    writer.write(file.path(), cells_per_degree);
+    return file;
+}
+}
+
+TEST_CASE("TimeZoneDb finds zones containing the coordinates") {
+    const auto cells_per_degree = GENERATE(1u, 2u, 8u);
+    CAPTURE(cells_per_degree);
+    const auto file = write_test_db(cells_per_degree);
+    const auto db = vp::TimeZoneDb::open(file.path());
+    REQUIRE(db.has_value());
+    REQUIRE(db->zone_count() == 5);
+
+    REQUIRE(db->find(at(1.0, 1.0)) == "Test/Square");
+    REQUIRE(db->find(at(9.9, 0.1)) == "Test/Square");
+    REQUIRE(db->find(at(5.0, 5.0)) == "Test/Enclave");
+    REQUIRE(db->find(at(4.1, 5.9)) == "Test/Enclave");
+    REQUIRE(db->find(at(3.9, 5.9)) == "Test/Square");
+    REQUIRE(db->find(at(0.0, 175.0)) == "Test/Antimeridian");
+    REQUIRE(db->find(at(0.0, -175.0)) == "Test/Antimeridian");
+    REQUIRE(db->find(at(0.0, 185.0)) == "Test/Antimeridian");
+    REQUIRE(db->find(at(-29.0, 40.0)) == "Test/Triangle");
+    REQUIRE(db->find(at(29.0, 40.0)) == "Test/Triangle");
+    REQUIRE(db->find(at(29.0, 45.0)).empty());
+    REQUIRE(db->find(at(-50.0, -30.0)).empty());
+    REQUIRE(db->find(at(90.0, 180.0)).empty());
+    REQUIRE(db->find(at(-90.0, -180.0)).empty());
+
+    std::mt19937 rng{1};
+    std::uniform_real_distribution<double> latitude{circle_latitude - 25.0, circle_latitude + 25.0};
+    std::uniform_real_distribution<double> longitude{circle_longitude - 25.0, circle_longitude + 25.0};
+    for (int i = 0; i < 1000; ++i) {
+        const auto coord = at(latitude(rng), longitude(rng));
+        const double distance = std::hypot(coord.latitude.latitude - circle_latitude, coord.longitude.longitude - circle_longitude);
+        if (std::fabs(distance - circle_radius) < 0.01) continue;
+        CAPTURE(coord.latitude.latitude, coord.longitude.longitude);
+        REQUIRE(db->find(coord) == (distance < circle_radius ? "Test/Circle" : ""));
+    }
+}
+
+TEST_CASE("TimeZoneDb::open() rejects missing and foreign files") {
+    REQUIRE_FALSE(vp::TimeZoneDb::open(test_files::unique_temp_path("no-such-file", ".vptz")).has_value());
+
+    const test_files::TempFile not_a_db{"time-zone-db-test-not-a-db", ".vptz"};
+    test_files::write_not_a_db(not_a_db.path());
+    REQUIRE_FALSE(vp::TimeZoneDb::open(not_a_db.path()).has_value());
+}
+
+TEST_CASE("approximate_time_zone() goes by 15° of longitude") {
+    REQUIRE(std::string{vp::approximate_time_zone(vp::Longitude{0.0})} == "Etc/GMT");
+    REQUIRE(std::string{vp::approximate_time_zone(vp::Longitude{74.7})} == "Etc/GMT-5");
+    REQUIRE(std::string{vp::approximate_time_zone(vp::Longitude{-80.0})} == "Etc/GMT+5");
+    REQUIRE(std::string{vp::approximate_time_zone(vp::Longitude{180.0})} == "Etc/GMT-12");
+}
+
+TEST_CASE("custom_location() takes time zone from the time zone db when it knows one") {
+    const test_files::UseDbGuard guard{vp::text_ui::use_time_zone_db};
+    REQUIRE_FALSE(vp::text_ui::use_time_zone_db(test_files::unique_temp_path("no-such-file", ".vptz")));
+    REQUIRE(vp::text_ui::custom_location(at(5.0, 5.0)).time_zone_name == "Etc/GMT");
+
+    const auto file = write_test_db(2);
+    REQUIRE(vp::text_ui::use_time_zone_db(file.path()));
+    const auto location = vp::text_ui::custom_location(at(5.0, 5.0));
+    REQUIRE(location.time_zone_name == "Test/Enclave");
+    REQUIRE(location.latitude.latitude == 5.0);
+    REQUIRE(location.longitude.longitude == 5.0);
+    // at sea
+    REQUIRE(vp::text_ui::custom_location(at(-50.0, -30.0)).time_zone_name == "Etc/GMT+2");
+
+    vp::text_ui::use_time_zone_db({});
+    REQUIRE(vp::text_ui::time_zone_for(at(5.0, 5.0)) == "Etc/GMT");
+}
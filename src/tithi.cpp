@@ -8,22 +8,22 @@ namespace vp {
 Tithi::Tithi(DiscreteTithi t) : tithi(static_cast<double>(t.num))
 {}
 
-Paksha Tithi::get_paksha()
+Paksha Tithi::get_paksha() const
 {
     return tithi < 15 ? Paksha::Shukla : Paksha::Krishna;
 }
 
-bool Tithi::is_dvadashi()
+bool Tithi::is_dvadashi() const
 {
     return (tithi >= 11 && tithi < 12) || (tithi >= 11+15 && tithi < 12+15);
 }
 
-bool Tithi::is_ekadashi()
+bool Tithi::is_ekadashi() const
 {
     return (tithi >= 10 && tithi < 11) || (tithi >= 10+15 && tithi < 11+15);
 }
 
-bool Tithi::is_dashami()
+bool Tithi::is_dashami() const
 {
     return (tithi >= 9 && tithi < 10) || (tithi >= 9+15 && tithi < 10+15);
 }
@@ -25,10 +25,10 @@ struct Tithi {
     }
     explicit Tithi(DiscreteTithi t);
     double tithi;
-    Paksha get_paksha();
-    bool is_dvadashi();
-    bool is_ekadashi();
-    bool is_dashami();
+    Paksha get_paksha() const;
+    bool is_dvadashi() const;
+    bool is_ekadashi() const;
+    bool is_dashami() const;
     bool is_shukla_pratipat() const noexcept;
     bool is_krishna_pratipat() const;
     // Pratipat is 0.00...0.99, Dvitiya is 1.00..1.99, etc
@@ -0,0 +1,343 @@
+#include "vrata-boundary.h"
+
+#include "swe.h"
+#include "text-interface.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace vp {
+
+bool operator==(const VrataClass & one, const VrataClass & other)
+{
+    return one.date == other.date && one.type == other.type;
+}
+
+bool operator!=(const VrataClass & one, const VrataClass & other)
+{
+    return !(one == other);
+}
+
+bool operator<(const VrataClass & one, const VrataClass & other)
+{
+    return std::tie(one.date, one.type) < std::tie(other.date, other.type);
+}
+
+namespace {
+struct Crossing {
+    Coord point;
+    VrataClass from; // class at the first end of the grid edge
+    VrataClass to;   // class at the other end
+};
+
+Coord midpoint(Coord a, Coord b) {
+    return Coord{Latitude{(a.latitude.latitude + b.latitude.latitude) / 2}, Longitude{(a.longitude.longitude + b.longitude.longitude) / 2}};
+}
+
+double distance_degrees(Coord a, Coord b) {
+    return std::max(std::fabs(a.latitude.latitude - b.latitude.latitude), std::fabs(a.longitude.longitude - b.longitude.longitude));
+}
+
+// `from` class is at a, something else at b
+Crossing bisect(const VrataClassifier & classify, Coord a, VrataClass from, Coord b, VrataClass to, double precision) {
+    while (distance_degrees(a, b) > precision) {
+        const auto mid = midpoint(a, b);
+        const auto c = classify(mid);
+        if (c && *c == from) {
+            a = mid;
+        } else {
+            b = mid;
+            // there might be a third class (or an error) in between, the boundary we find is the one with `from`
+            if (c) to = *c;
+        }
+    }
+    return Crossing{midpoint(a, b), from, to};
+}
+
+// Same as above, but on condition's sign. nullopt when classes at the ends of the result don't agree.
+std::optional<Crossing> bisect(const VrataClassifier & classify, const BoundaryCondition & condition,
+                               Coord a, VrataClass from, Coord b, double precision) {
+    const auto at_a = condition(a);
+    if (!at_a) return std::nullopt;
+    const bool sign_at_a = *at_a > 0.0;
+    while (distance_degrees(a, b) > precision) {
+        const auto mid = midpoint(a, b);
+        const auto c = condition(mid);
+        if (c && (*c > 0.0) == sign_at_a) {
+            a = mid;
+        } else {
+            b = mid;
+        }
+    }
+    // condition is only a model of the calculation, check it
+    const auto class_at_a = classify(a);
+    if (!class_at_a || *class_at_a != from) return std::nullopt;
+    const auto class_at_b = classify(b);
+    if (!class_at_b || *class_at_b == from) return std::nullopt;
+    return Crossing{midpoint(a, b), from, *class_at_b};
+}
+
+using ClassPair = std::pair<VrataClass, VrataClass>;
+
+ClassPair ordered_pair(const Crossing & c) {
+    return std::minmax(c.from, c.to);
+}
+
+// Joins segments (pairs of crossing ids) into polylines. Each crossing lies on a grid edge
+// shared by at most two cells, so it's in at most two segments, and the result is
+// a set of simple paths and cycles.
+std::vector<std::vector<std::size_t>> join_segments(const std::vector<std::pair<std::size_t, std::size_t>> & segments) {
+    std::unordered_map<std::size_t, std::vector<std::size_t>> neighbours;
+    for (const auto & [a, b] : segments) {
+        neighbours[a].push_back(b);
+        neighbours[b].push_back(a);
+    }
+    std::unordered_map<std::size_t, bool> visited;
+    std::vector<std::vector<std::size_t>> paths;
+    const auto walk = [&](std::size_t start) {
+        std::vector<std::size_t> path{start};
+        visited[start] = true;
+        for (auto current = start;;) {
+            const auto & next = neighbours[current];
+            const auto unvisited = std::find_if(next.begin(), next.end(), [&](std::size_t n) { return !visited[n]; });
+            if (unvisited == next.end()) {
+                // close the cycle
+                if (path.size() > 2 && std::find(next.begin(), next.end(), start) != next.end()) {
+                    path.push_back(start);
+                }
+                break;
+            }
+            current = *unvisited;
+            visited[current] = true;
+            path.push_back(current);
+        }
+        paths.push_back(std::move(path));
+    };
+    // paths first (starting from their ends), then whatever is left are cycles
+    std::vector<std::size_t> ids;
+    for (const auto & [id, n] : neighbours) ids.push_back(id);
+    std::sort(ids.begin(), ids.end());
+    for (const auto id : ids) {
+        if (!visited[id] && neighbours[id].size() == 1) walk(id);
+    }
+    for (const auto id : ids) {
+        if (!visited[id]) walk(id);
+    }
+    return paths;
+}
+
+} // anonymous namespace
+
+std::vector<BoundaryLine> find_vrata_boundaries(const VrataClassifier & classify, const BoundarySettings & settings,
+                                                const BoundaryConditionFinder & find_condition)
+{
+    const double step = settings.step_degrees;
+    const auto rows = static_cast<std::size_t>(std::floor((settings.north_east.latitude.latitude - settings.south_west.latitude.latitude) / step)) + 1;
+    const auto cols = static_cast<std::size_t>(std::floor((settings.north_east.longitude.longitude - settings.south_west.longitude.longitude) / step)) + 1;
+    const auto coord_at = [&](std::size_t row, std::size_t col) {
+        return Coord{settings.south_west.latitude + static_cast<double>(row) * step, settings.south_west.longitude + static_cast<double>(col) * step};
+    };
+
+    std::vector<std::optional<VrataClass>> classes(rows * cols);
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t col = 0; col < cols; ++col) {
+            classes[row * cols + col] = classify(coord_at(row, col));
+        }
+    }
+
+    // Edge ids: 2*point for the edge going east from the point, 2*point+1 for the one going north.
+    std::unordered_map<std::size_t, Crossing> crossings;
+    const auto find_crossing = [&](std::size_t row, std::size_t col, std::size_t row2, std::size_t col2, std::size_t edge_id) {
+        const auto & a = classes[row * cols + col];
+        const auto & b = classes[row2 * cols + col2];
+        if (!a || !b || *a == *b) return;
+        const auto from = coord_at(row, col);
+        const auto to = coord_at(row2, col2);
+        if (find_condition) {
+            if (const auto condition = find_condition(from, to)) {
+                if (auto crossing = bisect(classify, *condition, from, *a, to, settings.precision_degrees)) {
+                    crossings.emplace(edge_id, *crossing);
+                    return;
+                }
+            }
+        }
+        crossings.emplace(edge_id, bisect(classify, from, *a, to, *b, settings.precision_degrees));
+    };
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t col = 0; col < cols; ++col) {
+            const auto point = row * cols + col;
+            if (col + 1 < cols) find_crossing(row, col, row, col + 1, 2 * point);
+            if (row + 1 < rows) find_crossing(row, col, row + 1, col, 2 * point + 1);
+        }
+    }
+
+    // In each cell, connect crossings of the same pair of classes. Going around the
+    // cell perimeter makes the ambiguous case of four crossings pair up consistently.
+    std::map<ClassPair, std::vector<std::pair<std::size_t, std::size_t>>> segments;
+    for (std::size_t row = 0; row + 1 < rows; ++row) {
+        for (std::size_t col = 0; col + 1 < cols; ++col) {
+            const auto point = row * cols + col;
+            const std::size_t perimeter[] = {
+                2 * point,                      // south
+                2 * (point + 1) + 1,            // east
+                2 * (point + cols),             // north
+                2 * point + 1,                  // west
+            };
+            std::map<ClassPair, std::vector<std::size_t>> by_pair;
+            for (const auto edge : perimeter) {
+                if (auto found = crossings.find(edge); found != crossings.end()) {
+                    by_pair[ordered_pair(found->second)].push_back(edge);
+                }
+            }
+            for (const auto & [pair, edges] : by_pair) {
+                for (std::size_t i = 0; i + 1 < edges.size(); i += 2) {
+                    segments[pair].emplace_back(edges[i], edges[i + 1]);
+                }
+            }
+        }
+    }
+
+    std::vector<BoundaryLine> lines;
+    for (const auto & [pair, pair_segments] : segments) {
+        for (const auto & path : join_segments(pair_segments)) {
+            BoundaryLine line{pair.first, pair.second, {}};
+            for (const auto edge : path) {
+                line.points.push_back(crossings.at(edge).point);
+            }
+            lines.push_back(std::move(line));
+        }
+    }
+    return lines;
+}
+
+VrataClassifier vrata_classifier(date::local_days base_date, CalcFlags flags)
+{
+    return [base_date, flags](Coord coord) -> std::optional<VrataClass> {
+        const auto location = text_ui::custom_location(coord);
+        const auto vrata = text_ui::calc_one(base_date, location, flags);
+        if (!vrata) return std::nullopt;
+        return VrataClass{vrata->date, vrata->type};
+    };
+}
+
+namespace {
+// Location-independent part of the vrata calculation for some point, to compare sunrises
+// at other locations with (see Calc::find_next_vrata() and Calc::calc_vrata_type()).
+struct TithiStarts {
+    JulDays_UT ekadashi;
+    JulDays_UT dvadashi;
+    JulDays_UT trayodashi;
+    // the time point which must be free of dashamī, in ghaṭikās before sunrise
+    double checked_ghatikas;
+    // first sunrise checked for dashamī (before moving to the next day, if any)
+    JulDays_UT first_sunrise;
+};
+
+TithiStarts tithi_starts(const Vrata & vrata) {
+    const auto & t = vrata.times;
+    const auto first_sunrise = vrata.sunrise0.value_or(vrata.sunrise1);
+    // arunodaya is 4 ghaṭikās before the first sunrise
+    const auto ghatika = (first_sunrise - t.arunodaya) / 4.0;
+    return TithiStarts{t.ekadashi_start, t.dvadashi_start, t.trayodashi_start,
+                       (first_sunrise - t.ativrddhaditvam_timepoint()) / ghatika, first_sunrise};
+}
+
+// Sunrises on days around TithiStarts::first_sunrise
+constexpr int first_day = -1;
+constexpr int last_day = 4;
+
+// Conditions in the order find_next_vrata() checks them: which sunrise is the first one after
+// ekādaśī start, whether it's dashamī-viddha, then ekādaśī and dvādaśī at the following sunrises.
+enum class Threshold {
+    EkadashiStarted, DashamiViddha, DvadashiStarted, TrayodashiStarted
+};
+constexpr std::array<Threshold, 4> thresholds{
+    Threshold::EkadashiStarted, Threshold::DashamiViddha, Threshold::DvadashiStarted, Threshold::TrayodashiStarted};
+
+// days from sunrise to the tithi start it's compared with
+std::optional<double> condition_at(const Swe & swe, const TithiStarts & starts, Threshold threshold, int day) {
+    const auto sunrise = swe.find_sunrise(starts.first_sunrise + double_days{day - 0.5});
+    if (!sunrise) return std::nullopt;
+    switch (threshold) {
+    case Threshold::EkadashiStarted:
+        return (*sunrise - starts.ekadashi).count();
+    case Threshold::DashamiViddha: {
+        const auto sunset = swe.find_sunset(*sunrise - double_days{1.0});
+        if (!sunset) return std::nullopt;
+        const auto ghatika = (*sunrise - *sunset) / 30.0;
+        return (*sunrise - starts.checked_ghatikas * ghatika - starts.ekadashi).count();
+    }
+    case Threshold::DvadashiStarted:
+        return (*sunrise - starts.dvadashi).count();
+    case Threshold::TrayodashiStarted:
+        return (*sunrise - starts.trayodashi).count();
+    }
+    return std::nullopt;
+}
+
+Swe swe_for(Coord coord, CalcFlags flags) {
+    // only sunrises and sunsets are needed, time zone doesn't matter for them
+    return Swe{Location{coord.latitude, coord.longitude}, flags};
+}
+} // anonymous namespace
+
+BoundaryConditionFinder vrata_boundary_condition(date::local_days base_date, CalcFlags flags)
+{
+    return [base_date, flags](Coord a, Coord b) -> std::optional<BoundaryCondition> {
+        const auto vrata = text_ui::calc_one(base_date, text_ui::custom_location(a), flags);
+        if (!vrata) return std::nullopt;
+        const auto starts = tithi_starts(*vrata);
+        const auto swe_a = swe_for(a, flags);
+        const auto swe_b = swe_for(b, flags);
+        for (const auto threshold : thresholds) {
+            for (int day = first_day; day <= last_day; ++day) {
+                const auto at_a = condition_at(swe_a, starts, threshold, day);
+                const auto at_b = condition_at(swe_b, starts, threshold, day);
+                if (!at_a || !at_b) return std::nullopt;
+                if ((*at_a > 0.0) != (*at_b > 0.0)) {
+                    return BoundaryCondition{[starts, threshold, day, flags](Coord coord) {
+                        return condition_at(swe_for(coord, flags), starts, threshold, day);
+                    }};
+                }
+            }
+        }
+        return std::nullopt;
+    };
+}
+
+namespace {
+std::string class_description(const VrataClass & c) {
+    return fmt::format(FMT_STRING("{} {}"), date::year_month_day{c.date}, c.type);
+}
+} // anonymous namespace
+
+std::string boundaries_to_geojson(const std::vector<BoundaryLine> & lines)
+{
+    fmt::memory_buffer buf;
+    auto out = fmt::appender{buf};
+    fmt::format_to(out, FMT_STRING(R"({{"type":"FeatureCollection","features":[)"));
+    bool first_line = true;
+    for (const auto & line : lines) {
+        if (!first_line) fmt::format_to(out, ",");
+        first_line = false;
+        // class descriptions only contain letters, digits, spaces and some punctuation, no JSON escaping needed
+        fmt::format_to(out, FMT_STRING(R"({{"type":"Feature","properties":{{"one_side":"{}","other_side":"{}"}},"geometry":{{"type":"LineString","coordinates":[)"),
+                       class_description(line.one_side), class_description(line.other_side));
+        bool first_point = true;
+        for (const auto & point : line.points) {
+            if (!first_point) fmt::format_to(out, ",");
+            first_point = false;
+            // GeoJSON wants longitude first
+            fmt::format_to(out, FMT_STRING("[{:.4f},{:.4f}]"), point.longitude.longitude, point.latitude.latitude);
+        }
+        fmt::format_to(out, "]}}}}");
+    }
+    fmt::format_to(out, "]}}\n");
+    return fmt::to_string(buf);
+}
+
+} // namespace vp
@@ -0,0 +1,82 @@
+#ifndef VP_VRATA_BOUNDARY_H
+#define VP_VRATA_BOUNDARY_H
+
+#include "calc-flags.h"
+#include "location.h"
+#include "vrata.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vp {
+
+// What matters for the boundary map: which day(s) the vrata is observed.
+struct VrataClass {
+    date::local_days date;
+    Vrata_Type type;
+};
+
+bool operator==(const VrataClass & one, const VrataClass & other);
+bool operator!=(const VrataClass & one, const VrataClass & other);
+bool operator<(const VrataClass & one, const VrataClass & other);
+
+// nullopt when there is no vrata for the coordinates (calculation error)
+using VrataClassifier = std::function<std::optional<VrataClass>(Coord)>;
+
+// Function of coordinates which changes sign where vrata class changes, and is much cheaper
+// than classifying. nullopt where it can't be calculated.
+using BoundaryCondition = std::function<std::optional<double>(Coord)>;
+// Condition for the boundary between points a and b (known to have different classes),
+// nullopt if there is none and the boundary has to be found by classifying points.
+using BoundaryConditionFinder = std::function<std::optional<BoundaryCondition>(Coord a, Coord b)>;
+
+struct BoundarySettings {
+    Coord south_west{Latitude{-60.0}, Longitude{-180.0}};
+    Coord north_east{Latitude{60.0}, Longitude{180.0}};
+    // grid step: features smaller than that might be missed
+    double step_degrees = 2.0;
+    // bisection goes on until boundary point is known within that many degrees
+    double precision_degrees = 0.01;
+};
+
+// Curve separating areas where one_side and other_side vratas are observed.
+// Closed curves have the same first and last point.
+struct BoundaryLine {
+    VrataClass one_side;
+    VrataClass other_side;
+    std::vector<Coord> points;
+};
+
+/* Find curves where vrata date or type changes within the area.
+ * Classifies points of a regular grid, then finds exact boundary points on each
+ * grid edge with different classes at its ends by bisection, and joins
+ * boundary points of neighbouring grid cells into lines. Only grid edges
+ * crossing a boundary need more than one classification.
+ *
+ * With find_condition, edges are bisected on the condition instead, and only the
+ * two final points are classified (to check the result and to get the class on
+ * the other side). Edges without a condition, or where the check fails, are
+ * bisected by classification.
+ */
+std::vector<BoundaryLine> find_vrata_boundaries(const VrataClassifier & classify, const BoundarySettings & settings = {},
+                                                const BoundaryConditionFinder & find_condition = {});
+
+// Classifies by calculating next vrata from base_date (with time zone approximated from longitude)
+VrataClassifier vrata_classifier(date::local_days base_date, CalcFlags flags = CalcFlags::Default);
+
+/* Conditions for vrata_classifier() boundaries: vrata date and type only change where
+ * some sunrise (or the time point which must be free of dashamī) crosses a tithi start.
+ * Tithi starts don't depend on location, so they are calculated once (at a), and each
+ * bisection step only needs a sunrise (and sunset) at the midpoint.
+ * nullopt for boundaries it doesn't model, e.g. Śravaṇa-dvādaśī (nakṣatra) or errors.
+ */
+BoundaryConditionFinder vrata_boundary_condition(date::local_days base_date, CalcFlags flags = CalcFlags::Default);
+
+// GeoJSON FeatureCollection with a LineString feature for each line
+std::string boundaries_to_geojson(const std::vector<BoundaryLine> & lines);
+
+} // namespace vp
+
+#endif // VP_VRATA_BOUNDARY_H
@@ -0,0 +1,122 @@
+#include "catch-formatters.h"
+
+#include "vrata-boundary.h"
+
+#include <cmath>
+
+using namespace date;
+
+namespace {
+const vp::VrataClass one{local_days{2021_y/February/23}, vp::Vrata_Type::Ekadashi};
+const vp::VrataClass other{local_days{2021_y/February/24}, vp::Vrata_Type::Ekadashi};
+
+vp::Coord coord(double latitude, double longitude) {
+    return vp::Coord{vp::Latitude{latitude}, vp::Longitude{longitude}};
+}
+}
+
+TEST_CASE("find_vrata_boundaries() finds straight boundary") {
+    // boundary is the lat = 10 + lng/2 line
+    const auto classify = [](vp::Coord c) -> std::optional<vp::VrataClass> {
+        return (c.latitude.latitude < 10.0 + c.longitude.longitude / 2) ? one : other;
+    };
+    vp::BoundarySettings settings;
+    settings.south_west = coord(-20.0, -20.0);
+    settings.north_east = coord(40.0, 20.0);
+    settings.precision_degrees = 0.001;
+
+    const auto lines = vp::find_vrata_boundaries(classify, settings);
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0].one_side == one);
+    REQUIRE(lines[0].other_side == other);
+    // one point on every vertical grid line at least
+    REQUIRE(lines[0].points.size() >= 21);
+    for (const auto & p : lines[0].points) {
+        REQUIRE(std::fabs(p.latitude.latitude - (10.0 + p.longitude.longitude / 2)) < 0.01);
+    }
+}
+
+TEST_CASE("find_vrata_boundaries() closes curves around islands") {
+    const auto classify = [](vp::Coord c) -> std::optional<vp::VrataClass> {
+        return std::hypot(c.latitude.latitude, c.longitude.longitude) < 5.0 ? one : other;
+    };
+    vp::BoundarySettings settings;
+    settings.south_west = coord(-10.0, -10.0);
+    settings.north_east = coord(10.0, 10.0);
+    settings.step_degrees = 1.0;
+
+    const auto lines = vp::find_vrata_boundaries(classify, settings);
+    REQUIRE(lines.size() == 1);
+    const auto & points = lines[0].points;
+    REQUIRE(points.size() > 10);
+    REQUIRE(points.front() == points.back());
+    for (const auto & p : points) {
+        REQUIRE(std::fabs(std::hypot(p.latitude.latitude, p.longitude.longitude) - 5.0) < 0.05);
+    }
+}
+
+TEST_CASE("find_vrata_boundaries() bisects on boundary condition when there is one") {
+    int classify_calls = 0;
+    const auto classify = [&classify_calls](vp::Coord c) -> std::optional<vp::VrataClass> {
+        ++classify_calls;
+        return (c.latitude.latitude < 10.0 + c.longitude.longitude / 2) ? one : other;
+    };
+    const auto find_condition = [](vp::Coord, vp::Coord) -> std::optional<vp::BoundaryCondition> {
+        return vp::BoundaryCondition{[](vp::Coord c) -> std::optional<double> {
+            return c.latitude.latitude - (10.0 + c.longitude.longitude / 2);
+        }};
+    };
+    vp::BoundarySettings settings;
+    settings.south_west = coord(-20.0, -20.0);
+    settings.north_east = coord(40.0, 20.0);
+    settings.precision_degrees = 0.001;
+
+    const auto lines = vp::find_vrata_boundaries(classify, settings, find_condition);
+    const auto with_condition = classify_calls;
+    classify_calls = 0;
+    REQUIRE(lines.size() == 1);
+    for (const auto & p : lines[0].points) {
+        REQUIRE(std::fabs(p.latitude.latitude - (10.0 + p.longitude.longitude / 2)) < 0.01);
+    }
+    // only grid points and the two ends of each crossing are classified with the condition
+    REQUIRE(vp::find_vrata_boundaries(classify, settings).size() == 1);
+    REQUIRE(with_condition < classify_calls);
+}
+
+TEST_CASE("find_vrata_boundaries() bisects by classification when boundary condition disagrees") {
+    const auto classify = [](vp::Coord c) -> std::optional<vp::VrataClass> {
+        return (c.latitude.latitude < 10.0 + c.longitude.longitude / 2) ? one : other;
+    };
+    // boundary in a wrong place
+    const auto find_condition = [](vp::Coord, vp::Coord) -> std::optional<vp::BoundaryCondition> {
+        return vp::BoundaryCondition{[](vp::Coord c) -> std::optional<double> { return c.latitude.latitude - 11.0; }};
+    };
+    vp::BoundarySettings settings;
+    settings.south_west = coord(-20.0, -20.0);
+    settings.north_east = coord(40.0, 20.0);
+
+    const auto lines = vp::find_vrata_boundaries(classify, settings, find_condition);
+    REQUIRE(lines.size() == 1);
+    for (const auto & p : lines[0].points) {
+        REQUIRE(std::fabs(p.latitude.latitude - (10.0 + p.longitude.longitude / 2)) < 0.05);
+    }
+}
+
+TEST_CASE("find_vrata_boundaries() skips points with errors") {
+    const auto classify = [](vp::Coord c) -> std::optional<vp::VrataClass> {
+        if (c.latitude.latitude > 0) return std::nullopt;
+        return one;
+    };
+    REQUIRE(vp::find_vrata_boundaries(classify).empty());
+}
+
+TEST_CASE("boundaries_to_geojson() writes LineStrings with longitude first") {
+    const std::vector<vp::BoundaryLine> lines{
+        {one, other, {coord(1.0, 2.0), coord(3.0, 4.0)}}
+    };
+    const auto json = vp::boundaries_to_geojson(lines);
+    REQUIRE(json.find(R"({"type":"FeatureCollection","features":[{"type":"Feature")") == 0);
+    REQUIRE(json.find(R"("geometry":{"type":"LineString","coordinates":[[2.0000,1.0000],[4.0000,3.0000]]}})") != std::string::npos);
+    REQUIRE(json.find(R"("one_side":"2021-02-23 Ekādaśī")") != std::string::npos);
+    REQUIRE(json.substr(json.size() - 3) == "]}\n");
+}
@@ -0,0 +1,143 @@
+#include <cstdlib>
+#include <cstring>
+#include "fmt-format-fixed.h"
+#include <fstream>
+
+#include "embedded-ephemeris.h"
+#include "place-db.h"
+#include "text-interface.h"
+#include "time-zone-db.h"
+#include "vrata-db.h"
+
+constexpr const char * default_embedded_ephemeris_file = "embedded-ephemeris-data.cpp";
+
+void print_usage() {
+    fmt::print("{}\n"
+               "USAGE:\n"
+               "vaishnavam-panchangam-db from-year to-year [file]\n"
+               "vaishnavam-panchangam-db -p geonames-file [file]\n"
+               "vaishnavam-panchangam-db -t rings-file [file]\n"
+               "vaishnavam-panchangam-db -e from-year to-year [file]\n"
+               "\n"
+               "    Precalculate vratas for all known locations for base dates from 1st January of from-year\n"
+               "    to 31st December of to-year and save them to the file ({} in the data dir by default).\n"
+               "    Other vaishnavam-panchangam programs use that file instead of calculating when it exists.\n"
+               "    -p converts GeoNames dump (e.g. cities15000.txt) to the place db file ({} in the data dir by default),\n"
+               "    so that other programs know locations by those names too.\n"
+               "    -t converts time zone boundaries (made by scripts/timezones-to-rings.js) to the time zone\n"
+               "    db file ({} in the data dir by default), so that other programs find time zones\n"
+               "    of arbitrary coordinates.\n"
+               "    -e fits Sun and Moon from Swiss ephemeris for the years and writes them as C++ source\n"
+               "    ({} in the current dir by default) for building with -DVP_EMBEDDED_EPHEMERIS=that-file,\n"
+               "    so that programs need no ephemeris files for those years.\n",
+               vp::text_ui::program_name_and_version(),
+               vp::VrataDb::DefaultFileName,
+               vp::PlaceDb::DefaultFileName,
+               vp::TimeZoneDb::DefaultFileName,
+               default_embedded_ephemeris_file);
+}
+
+int make_place_db(const char * argv0, const char * geonames_path, const char * path) {
+    std::ifstream in{geonames_path};
+    if (!in) {
+        fmt::print(stderr, "Can't open {}\n", geonames_path);
+        return -1;
+    }
+    vp::PlaceDbWriter writer;
+    writer.add_geonames(in);
+    // resolve user-given path before changing current dir
+    const auto out_path = path ? fs::absolute(path) : fs::path{};
+    vp::text_ui::change_to_data_dir(argv0);
+    writer.write(out_path.empty() ? fs::path{vp::PlaceDb::DefaultFileName} : out_path);
+    fmt::print(stderr, "{} places\n", writer.size());
+    return 0;
+}
+
+int make_time_zone_db(const char * argv0, const char * rings_path, const char * path) {
+    std::ifstream in{rings_path};
+    if (!in) {
+        fmt::print(stderr, "Can't open {}\n", rings_path);
+        return -1;
+    }
+    vp::TimeZoneDbWriter writer;
+    const auto rings = writer.add_rings(in);
+    // resolve user-given path before changing current dir
+    const auto out_path = path ? fs::absolute(path) : fs::path{};
+    vp::text_ui::change_to_data_dir(argv0);
+    writer.write(out_path.empty() ? fs::path{vp::TimeZoneDb::DefaultFileName} : out_path);
+    fmt::print(stderr, "{} rings\n", rings);
+    return 0;
+}
+
+int make_embedded_ephemeris(const char * argv0, int from_year, int to_year, const char * path) {
+    // resolve path before changing current dir
+    const auto out_path = fs::absolute(path ? path : default_embedded_ephemeris_file);
+    vp::text_ui::change_to_data_dir(argv0);
+    const vp::EmbeddedEphemerisWriter writer{from_year, to_year};
+    std::ofstream out{out_path, std::ios::binary | std::ios::trunc};
+    writer.write_source(out);
+    if (!out) {
+        fmt::print(stderr, "Can't write {}\n", out_path.string());
+        return -1;
+    }
+    fmt::print(stderr, "largest error {:.3g}°\n", writer.max_error());
+    return 0;
+}
+
+int main(int argc, char *argv[]) try
+{
+    if (argc-1 >= 1 && strcmp(argv[1], "-p") == 0) {
+        if (argc-1 != 2 && argc-1 != 3) {
+            print_usage();
+            return -1;
+        }
+        return make_place_db(argv[0], argv[2], argc-1 == 3 ? argv[3] : nullptr);
+    }
+    if (argc-1 >= 1 && strcmp(argv[1], "-t") == 0) {
+        if (argc-1 != 2 && argc-1 != 3) {
+            print_usage();
+            return -1;
+        }
+        return make_time_zone_db(argv[0], argv[2], argc-1 == 3 ? argv[3] : nullptr);
+    }
+    if (argc-1 >= 1 && strcmp(argv[1], "-e") == 0) {
+        if (argc-1 != 3 && argc-1 != 4) {
+            print_usage();
+            return -1;
+        }
+        const int from_year = std::atoi(argv[2]);
+        const int to_year = std::atoi(argv[3]);
+        if (from_year <= 0 || to_year < from_year) {
+            print_usage();
+            return -1;
+        }
+        return make_embedded_ephemeris(argv[0], from_year, to_year, argc-1 == 4 ? argv[4] : nullptr);
+    }
+    if (argc-1 != 2 && argc-1 != 3) {
+        print_usage();
+        return -1;
+    }
+    const int from_year = std::atoi(argv[1]);
+    const int to_year = std::atoi(argv[2]);
+    if (from_year <= 0 || to_year < from_year) {
+        print_usage();
+        return -1;
+    }
+    // resolve user-given path before changing current dir
+    const auto path = (argc-1 == 3) ? fs::absolute(argv[3]) : fs::path{};
+    vp::text_ui::change_to_data_dir(argv[0]);
+    date::set_install("tzdata");
+
+    const auto from = date::local_days{date::year{from_year}/date::January/1};
+    const auto to = date::local_days{date::year{to_year}/date::December/31};
+    vp::text_ui::generate_vrata_db(
+        path.empty() ? fs::path{vp::VrataDb::DefaultFileName} : path,
+        from, to, vp::CalcFlags::Default,
+        [](std::size_t done, std::size_t total) {
+            fmt::print(stderr, "\r{}/{} locations", done, total);
+        });
+    fmt::print(stderr, "\n");
+} catch(const std::runtime_error & err) {
+    fmt::print(stderr, "Fatal error: {}\n", err.what());
+    return -1;
+}
@@ -0,0 +1,261 @@
+#include "vrata-db.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace vp {
+
+namespace {
+constexpr char magic[4] = {'V', 'P', 'D', 'B'};
+constexpr std::uint32_t byte_order_mark = 0x01020304;
+constexpr std::uint64_t section_alignment = 8;
+
+constexpr std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+// Mapped memory has no objects of our types in it, so copy them out instead of casting pointers.
+template<typename T>
+T read_at(const unsigned char * base, std::uint64_t offset, std::size_t index) {
+    T value;
+    std::memcpy(&value, base + offset + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+bool section_fits(std::uint64_t offset, std::uint64_t count, std::uint64_t element_size, std::size_t file_size) {
+    if (offset % section_alignment != 0 || offset > file_size) return false;
+    return count <= (file_size - offset) / element_size;
+}
+
+std::int32_t to_days(date::local_days date) {
+    return static_cast<std::int32_t>(date.time_since_epoch().count());
+}
+} // anonymous namespace
+
+std::optional<VrataDb> VrataDb::open(const fs::path & path)
+{
+    auto file = MappedFile::open(path);
+    if (!file || file->size() < sizeof(Header)) return std::nullopt;
+    const auto header = read_at<Header>(file->data(), 0, 0);
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+            || header.version != Version
+            || header.byte_order_mark != byte_order_mark) {
+        return std::nullopt;
+    }
+    const auto size = file->size();
+    if (!section_fits(header.locations_offset, header.location_count, sizeof(LocationEntry), size)
+            || !section_fits(header.records_offset, header.record_count, sizeof(VrataRecord), size)
+            || !section_fits(header.special_dates_offset, header.special_date_count, sizeof(SpecialDateEntry), size)
+            || !section_fits(header.names_offset, header.names_size, 1, size)) {
+        return std::nullopt;
+    }
+    VrataDb db{std::move(*file)};
+    db.header_ = header;
+    // check every location once here so that queries don't have to
+    for (std::size_t i = 0; i < db.location_count(); ++i) {
+        const auto entry = read_at<LocationEntry>(db.file_.data(), header.locations_offset, i);
+        if (std::uint64_t{entry.name_offset} + entry.name_length > header.names_size
+                || std::uint64_t{entry.first_record} + entry.record_count > header.record_count
+                || std::uint64_t{entry.first_special_date} + entry.special_date_count > header.special_date_count) {
+            return std::nullopt;
+        }
+    }
+    return db;
+}
+
+VrataDb::VrataDb(MappedFile file) : file_(std::move(file))
+{}
+
+std::string_view VrataDb::location_name(const LocationEntry & entry) const
+{
+    const auto * names = reinterpret_cast<const char *>(file_.data() + header_.names_offset);
+    return std::string_view{names + entry.name_offset, entry.name_length};
+}
+
+VrataRecord VrataDb::record(std::size_t index) const
+{
+    return read_at<VrataRecord>(file_.data(), header_.records_offset, index);
+}
+
+VrataDb::SpecialDateEntry VrataDb::special_date(std::size_t index) const
+{
+    return read_at<SpecialDateEntry>(file_.data(), header_.special_dates_offset, index);
+}
+
+std::optional<VrataDb::LocationEntry> VrataDb::find_location(std::string_view name, Longitude longitude) const
+{
+    std::size_t first = 0;
+    std::size_t count = location_count();
+    // lower_bound by name
+    while (count > 0) {
+        const auto step = count / 2;
+        const auto entry = read_at<LocationEntry>(file_.data(), header_.locations_offset, first + step);
+        if (location_name(entry) < name) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    if (first == location_count()) return std::nullopt;
+    const auto entry = read_at<LocationEntry>(file_.data(), header_.locations_offset, first);
+    // Same name but different coordinates means some other location (or outdated db)
+    if (location_name(entry) != name || entry.longitude != longitude.longitude) return std::nullopt;
+    return entry;
+}
+
+std::optional<Vrata> VrataDb::find_next(const Location & location, date::local_days base_date) const
+{
+    if (base_date < first_base_date() || base_date > last_base_date()) return std::nullopt;
+    const auto entry = find_location(location.name, location.longitude);
+    if (!entry || entry->latitude != location.latitude.latitude) return std::nullopt;
+
+    const auto first = entry->first_record;
+    const auto last = first + entry->record_count;
+    const auto base_days = to_days(base_date);
+    // first record with date >= base_date
+    std::size_t lo = first;
+    std::size_t hi = last;
+    while (lo < hi) {
+        const auto mid = lo + (hi - lo) / 2;
+        if (record(mid).date_days < base_days) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == last) return std::nullopt;
+    const auto found = record(lo);
+    if (found.flags & RecordAfterGap) return std::nullopt;
+    return found.to_vrata(location);
+}
+
+std::optional<NamedDates> VrataDb::nameworthy_dates(const Vrata & vrata, std::pmr::memory_resource * resource) const
+{
+    const auto entry = find_location(vrata.location.name, vrata.location.longitude);
+    if (!entry) return std::nullopt;
+    const auto vrata_days = to_days(vrata.date);
+    const auto records_end = entry->first_record + entry->record_count;
+    const auto has_record = [&]() {
+        for (std::size_t lo = entry->first_record, hi = records_end; lo < hi;) {
+            const auto mid = lo + (hi - lo) / 2;
+            const auto days = record(mid).date_days;
+            if (days == vrata_days) return true;
+            if (days < vrata_days) { lo = mid + 1; } else { hi = mid; }
+        }
+        return false;
+    }();
+    if (!has_record) return std::nullopt;
+
+    NamedDates dates{resource};
+    insert_ekadashi_paran_etc(dates, vrata);
+    // there are only a handful of special dates per location per year, linear scan is fine
+    const auto special_end = entry->first_special_date + entry->special_date_count;
+    for (std::size_t i = entry->first_special_date; i < special_end; ++i) {
+        const auto special = special_date(i);
+        if (special.vrata_date > vrata_days) break;
+        if (special.vrata_date != vrata_days) continue;
+        const auto date = date::local_days{date::days{special.date}};
+        if (special.kind > 255 || !insert_special_tithi_date(dates, SpecialTithiDate{static_cast<std::uint8_t>(special.kind), date})) {
+            return std::nullopt;
+        }
+    }
+    return dates;
+}
+
+VrataDbWriter::VrataDbWriter(CalcFlags flags, date::local_days first_base_date, date::local_days last_base_date)
+    : flags_(flags), first_base_date_(first_base_date), last_base_date_(last_base_date)
+{}
+
+void VrataDbWriter::start_location(const Location & location)
+{
+    locations_.push_back(PendingLocation{std::string{location.name}, Location{location.latitude, location.longitude}, {}, {}});
+}
+
+void VrataDbWriter::add_vrata(const Vrata & vrata, bool after_gap, const std::vector<SpecialTithiDate> & special_dates)
+{
+    if (locations_.empty()) {
+        throw std::logic_error("VrataDbWriter::add_vrata(): start_location() must be called first");
+    }
+    auto & location = locations_.back();
+    // location_index is assigned in write() once the final order of locations is known
+    auto record = VrataRecord::from_vrata(vrata, 0, location.base_location);
+    if (after_gap) {
+        record.flags |= VrataDb::RecordAfterGap;
+    }
+    location.records.push_back(record);
+    for (const auto & special : special_dates) {
+        location.special_dates.push_back(VrataDb::SpecialDateEntry{record.date_days, to_days(special.date), special.kind});
+    }
+}
+
+void VrataDbWriter::write(const fs::path & path) const
+{
+    std::vector<std::size_t> order(locations_.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return locations_[a].name < locations_[b].name;
+    });
+
+    std::vector<VrataDb::LocationEntry> entries;
+    std::vector<VrataRecord> records;
+    std::vector<VrataDb::SpecialDateEntry> special_dates;
+    std::string names;
+    for (const auto i : order) {
+        const auto & location = locations_[i];
+        VrataDb::LocationEntry entry{};
+        entry.name_offset = static_cast<std::uint32_t>(names.size());
+        entry.name_length = static_cast<std::uint32_t>(location.name.size());
+        entry.latitude = location.base_location.latitude.latitude;
+        entry.longitude = location.base_location.longitude.longitude;
+        entry.first_record = static_cast<std::uint32_t>(records.size());
+        entry.record_count = static_cast<std::uint32_t>(location.records.size());
+        entry.first_special_date = static_cast<std::uint32_t>(special_dates.size());
+        entry.special_date_count = static_cast<std::uint32_t>(location.special_dates.size());
+        names += location.name;
+        for (auto record : location.records) {
+            record.location_index = static_cast<std::uint16_t>(entries.size());
+            records.push_back(record);
+        }
+        special_dates.insert(special_dates.end(), location.special_dates.begin(), location.special_dates.end());
+        entries.push_back(entry);
+    }
+
+    VrataDb::Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = VrataDb::Version;
+    header.byte_order_mark = byte_order_mark;
+    header.calc_flags = static_cast<std::int32_t>(flags_);
+    header.first_base_date = to_days(first_base_date_);
+    header.last_base_date = to_days(last_base_date_);
+    header.location_count = static_cast<std::uint32_t>(entries.size());
+    header.record_count = static_cast<std::uint32_t>(records.size());
+    header.special_date_count = static_cast<std::uint32_t>(special_dates.size());
+    header.names_size = static_cast<std::uint32_t>(names.size());
+    header.locations_offset = align_up(sizeof(header));
+    header.records_offset = align_up(header.locations_offset + entries.size() * sizeof(VrataDb::LocationEntry));
+    header.special_dates_offset = align_up(header.records_offset + records.size() * sizeof(VrataRecord));
+    header.names_offset = align_up(header.special_dates_offset + special_dates.size() * sizeof(VrataDb::SpecialDateEntry));
+
+    std::ofstream f{path, std::ios::binary | std::ios::trunc};
+    const auto write_section = [&f](std::uint64_t offset, const void * data, std::size_t size) {
+        // zero padding up to the section start
+        static constexpr char zeros[section_alignment] = {};
+        const auto current = static_cast<std::uint64_t>(f.tellp());
+        f.write(zeros, static_cast<std::streamsize>(offset - current));
+        f.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+    write_section(0, &header, sizeof(header));
+    write_section(header.locations_offset, entries.data(), entries.size() * sizeof(VrataDb::LocationEntry));
+    write_section(header.records_offset, records.data(), records.size() * sizeof(VrataRecord));
+    write_section(header.special_dates_offset, special_dates.data(), special_dates.size() * sizeof(VrataDb::SpecialDateEntry));
+    write_section(header.names_offset, names.data(), names.size());
+    if (!f) {
+        throw std::runtime_error("can't write vrata db file " + path.string());
+    }
+}
+
+} // namespace vp
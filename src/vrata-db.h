@@ -0,0 +1,128 @@
+#ifndef VP_VRATA_DB_H
+#define VP_VRATA_DB_H
+
+#include "calc-flags.h"
+#include "filesystem-fixed.h"
+#include "location.h"
+#include "mapped-file.h"
+#include "named-dates.h"
+#include "nameworthy-dates.h"
+#include "vrata-record.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vp {
+
+/* Vratas precalculated for a set of locations and a range of base dates.
+ * The file is memory-mapped, and find_next() only does a couple of binary
+ * searches over it: no ephemeris calculations at query time at all.
+ * Use text_ui::generate_vrata_db() (or the vaishnavam-panchangam-db tool) to create the file.
+ *
+ * File layout (native byte order, every section starts at a multiple of 8):
+ *   Header
+ *   LocationEntry[location_count], sorted by name
+ *   VrataRecord[record_count], grouped by location, sorted by date within each location
+ *   SpecialDateEntry[special_date_count], grouped by location, sorted by vrata date
+ *   location names (UTF-8, not zero-terminated)
+ * Bump Version whenever the layout or meaning of any field changes.
+ */
+class VrataDb {
+public:
+    static constexpr std::uint32_t Version = 1;
+    // looked up in the data dir (see text_ui::change_to_data_dir())
+    static constexpr const char * DefaultFileName = "vratas.vpdb";
+    // VrataRecord::flags: some base dates between the previous record and this one
+    // gave calculation errors, so find_next() must not answer for them.
+    static constexpr std::uint8_t RecordAfterGap = 1;
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byte_order_mark; // 0x01020304 written in native byte order
+        std::int32_t calc_flags;
+        std::int32_t first_base_date; // days since 1970-01-01, inclusive
+        std::int32_t last_base_date;  // days since 1970-01-01, inclusive
+        std::uint32_t location_count;
+        std::uint32_t record_count;
+        std::uint32_t special_date_count;
+        std::uint32_t names_size;
+        std::uint64_t locations_offset;
+        std::uint64_t records_offset;
+        std::uint64_t special_dates_offset;
+        std::uint64_t names_offset;
+    };
+    struct LocationEntry {
+        std::uint32_t name_offset; // within names section
+        std::uint32_t name_length;
+        double latitude;
+        double longitude;
+        std::uint32_t first_record;
+        std::uint32_t record_count;
+        std::uint32_t first_special_date;
+        std::uint32_t special_date_count;
+    };
+    struct SpecialDateEntry {
+        std::int32_t vrata_date; // days since 1970-01-01 of the vrata which this date belongs to
+        std::int32_t date;
+        std::uint32_t kind;      // SpecialTithiDate::kind
+    };
+
+    // nullopt if the file is missing, truncated or written by a different version
+    static std::optional<VrataDb> open(const fs::path & path);
+
+    CalcFlags flags() const { return static_cast<CalcFlags>(header_.calc_flags); }
+    date::local_days first_base_date() const { return date::local_days{date::days{header_.first_base_date}}; }
+    date::local_days last_base_date() const { return date::local_days{date::days{header_.last_base_date}}; }
+    std::size_t location_count() const { return header_.location_count; }
+    std::size_t record_count() const { return header_.record_count; }
+
+    // Same vrata as calculated for this location from base_date with flags(), sans dates_for_this_paksha.
+    // nullopt if the answer is not in the db: unknown location (or one with different coordinates),
+    // base_date out of range or too close to a calculation error. Calculate it in that case.
+    std::optional<Vrata> find_next(const Location & location, date::local_days base_date) const;
+    // Same as nameworthy_dates_for_this_paksha(vrata, flags()) if vrata is in the db
+    std::optional<NamedDates> nameworthy_dates(const Vrata & vrata, std::pmr::memory_resource * resource = std::pmr::get_default_resource()) const;
+
+private:
+    explicit VrataDb(MappedFile file);
+    std::optional<LocationEntry> find_location(std::string_view name, Longitude longitude) const;
+    std::string_view location_name(const LocationEntry & entry) const;
+    VrataRecord record(std::size_t index) const;
+    SpecialDateEntry special_date(std::size_t index) const;
+
+    MappedFile file_;
+    Header header_{};
+};
+
+// Collects vratas location by location and writes them out in the VrataDb format.
+class VrataDbWriter {
+public:
+    VrataDbWriter(CalcFlags flags, date::local_days first_base_date, date::local_days last_base_date);
+    // Following add_vrata() calls go to this location. Each location must be started only once.
+    void start_location(const Location & location);
+    // Vratas must be added in date order, each one being the next vrata after the previous one,
+    // after_gap marks that calculation failed for some base dates between them.
+    void add_vrata(const Vrata & vrata, bool after_gap, const std::vector<SpecialTithiDate> & special_dates);
+    // throws std::runtime_error if the file can't be written
+    void write(const fs::path & path) const;
+
+private:
+    struct PendingLocation {
+        std::string name;
+        Location base_location; // only coordinates: the original name might not outlive us
+        std::vector<VrataRecord> records;
+        std::vector<VrataDb::SpecialDateEntry> special_dates;
+    };
+    CalcFlags flags_;
+    date::local_days first_base_date_;
+    date::local_days last_base_date_;
+    std::vector<PendingLocation> locations_;
+};
+
+} // namespace vp
+
+#endif // VP_VRATA_DB_H
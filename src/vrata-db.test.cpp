@@ -0,0 +1,114 @@
+#include "catch-formatters.h"
+
+#include "nameworthy-dates.h"
+#include "temp-files.h"
+#include "text-interface.h"
+#include "vrata-db.h"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace date;
+
+namespace {
+// Māgha śukla pakṣa of 2021 is in February, so this range includes special tithis too
+const auto db_from = local_days{2021_y/February/1};
+const auto db_to = local_days{2021_y/February/28};
+
+const fs::path & test_db_path() {
+    static const test_files::TempFile file = [] {
+        test_files::TempFile f{"vrata-db-test", ".vpdb"};
+        vp::text_ui::generate_vrata_db(f.path(), db_from, db_to);
+        return f;
+    }();
+    return file.path();
+}
+
+using FlatDates = std::vector<std::tuple<local_days, std::string, std::string, std::string>>;
+FlatDates flatten(const vp::NamedDates & dates) {
+    FlatDates flat;
+    for (const auto & [date, named_date] : dates) {
+        flat.emplace_back(date, std::string{named_date.name}, std::string{named_date.title}, std::string{named_date.css_classes});
+    }
+    return flat;
+}
+}
+
+TEST_CASE("VrataDb gives the same vratas and dates as calculation") {
+    const auto db = vp::VrataDb::open(test_db_path());
+    REQUIRE(db.has_value());
+    REQUIRE(db->location_count() == vp::text_ui::LocationDb::size());
+    REQUIRE(db->flags() == vp::CalcFlags::Default);
+
+    const auto location = GENERATE(vp::udupi_coord, vp::kiev_coord, vp::toronto_coord);
+    const auto base_date = GENERATE(local_days{2021_y/February/1}, local_days{2021_y/February/9}, local_days{2021_y/February/20}, local_days{2021_y/February/28});
+    CAPTURE(location.name, base_date);
+
+    const auto from_db = db->find_next(location, base_date);
+    const auto calculated = vp::text_ui::calc_one(base_date, location);
+    REQUIRE(calculated.has_value());
+    REQUIRE(from_db.has_value());
+    REQUIRE(*from_db == *calculated);
+    REQUIRE(from_db->paran.paran_start == calculated->paran.paran_start);
+    REQUIRE(from_db->paran.paran_end == calculated->paran.paran_end);
+    REQUIRE(from_db->location_name() == calculated->location_name());
+
+    const auto dates = db->nameworthy_dates(*from_db);
+    REQUIRE(dates.has_value());
+    REQUIRE(flatten(*dates) == flatten(vp::nameworthy_dates_for_this_paksha(*calculated, vp::CalcFlags::Default)));
+}
+
+TEST_CASE("VrataDb includes special tithis of Māgha śukla pakṣa") {
+    const auto db = vp::VrataDb::open(test_db_path());
+    REQUIRE(db.has_value());
+    const auto vrata = db->find_next(vp::udupi_coord, local_days{2021_y/February/20});
+    REQUIRE(vrata.has_value());
+    REQUIRE(vrata->masa == vp::Chandra_Masa::Magha);
+    const auto dates = db->nameworthy_dates(*vrata);
+    REQUIRE(dates.has_value());
+    const auto flat = flatten(*dates);
+    REQUIRE(std::any_of(flat.begin(), flat.end(), [](const auto & d) { return std::get<1>(d) == "Ratha-saptamī"; }));
+}
+
+TEST_CASE("VrataDb does not answer what it doesn't know") {
+    const auto db = vp::VrataDb::open(test_db_path());
+    REQUIRE(db.has_value());
+    REQUIRE_FALSE(db->find_next(vp::udupi_coord, db_from - days{1}).has_value());
+    REQUIRE_FALSE(db->find_next(vp::udupi_coord, db_to + days{1}).has_value());
+    // not in LocationDb
+    REQUIRE_FALSE(db->find_next(vp::Location{vp::Latitude{12.0}, vp::Longitude{75.0}}, db_from).has_value());
+    // same name, different coordinates
+    auto moved_udupi = vp::udupi_coord;
+    moved_udupi.latitude.latitude += 0.5;
+    REQUIRE_FALSE(db->find_next(moved_udupi, db_from).has_value());
+}
+
+TEST_CASE("VrataDb::open() rejects missing and foreign files") {
+    REQUIRE_FALSE(vp::VrataDb::open(test_files::unique_temp_path("no-such-file", ".vpdb")).has_value());
+
+    const test_files::TempFile not_a_db{"vrata-db-test-not-a-db", ".vpdb"};
+    test_files::write_not_a_db(not_a_db.path());
+    REQUIRE_FALSE(vp::VrataDb::open(not_a_db.path()).has_value());
+}
+
+TEST_CASE("calc() gives the same result with and without vrata db") {
+    const auto base_date = 2021_y/February/9;
+    const test_files::UseDbGuard guard{vp::text_ui::use_vrata_db};
+    REQUIRE_FALSE(vp::text_ui::use_vrata_db(test_files::unique_temp_path("no-such-file", ".vpdb")));
+    const auto calculated = vp::text_ui::calc(base_date, "all");
+
+    REQUIRE(vp::text_ui::use_vrata_db(test_db_path()));
+    const auto from_db = vp::text_ui::calc(base_date, "all");
+    vp::text_ui::use_vrata_db({});
+
+    REQUIRE(from_db.size() == calculated.size());
+    auto calculated_it = calculated.begin();
+    for (const auto & vrata : from_db) {
+        REQUIRE(vrata.has_value());
+        REQUIRE(*vrata == **calculated_it);
+        REQUIRE(flatten(vrata->dates_for_this_paksha) == flatten((*calculated_it)->dates_for_this_paksha));
+        ++calculated_it;
+    }
+}
@@ -0,0 +1,182 @@
+#include "vrata-grid.h"
+
+#include "text-interface.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vp {
+
+namespace {
+// index along one axis for the given number of degrees from the grid origin
+std::int64_t index_for(double degrees_from_origin, double step) {
+    return static_cast<std::int64_t>(std::floor(degrees_from_origin / step));
+}
+
+bool same_optional_times(const VrataRecord & one, const VrataRecord & other) {
+    for (std::size_t t = 0; t < VrataRecord::TimeCount; ++t) {
+        if (std::isnan(one.minutes[t]) != std::isnan(other.minutes[t])) return false;
+    }
+    return true;
+}
+} // anonymous namespace
+
+VrataGrid::VrataGrid(date::local_days base_date, std::string time_zone_name, VrataGridSettings settings)
+    : base_date_(base_date), time_zone_name_(std::move(time_zone_name)), settings_(settings)
+{}
+
+double VrataGrid::fine_step() const
+{
+    return std::ldexp(settings_.cell_degrees, -settings_.max_depth);
+}
+
+const VrataGrid::Corner & VrataGrid::corner(std::int64_t lat_index, std::int64_t lng_index)
+{
+    // wrap longitude around, so that 180°E and 180°W is the same corner
+    const auto lng_count = static_cast<std::int64_t>(std::llround(360.0 / fine_step()));
+    lng_index = ((lng_index % lng_count) + lng_count) % lng_count;
+    const auto key = (static_cast<std::uint64_t>(lat_index) << 32) | static_cast<std::uint64_t>(lng_index);
+    if (auto found = corners_.find(key); found != corners_.end()) {
+        return found->second;
+    }
+    const double latitude = std::clamp(-90.0 + static_cast<double>(lat_index) * fine_step(), -90.0, 90.0);
+    const double longitude = -180.0 + static_cast<double>(lng_index) * fine_step();
+    const Location location{Latitude{latitude}, Longitude{longitude}, "Grid point", time_zone_name_.c_str()};
+    auto vrata = text_ui::calc_one(base_date_, location, settings_.flags);
+    Corner c = vrata ? Corner{VrataRecord::from_vrata(*vrata, 0, location)} : Corner{tl::make_unexpected(vrata.error())};
+    return corners_.emplace(key, std::move(c)).first->second;
+}
+
+std::array<const VrataGrid::Corner *, 4> VrataGrid::corners(CellIndex cell)
+{
+    return {
+        &corner(cell.lat, cell.lng),
+        &corner(cell.lat, cell.lng + cell.size),
+        &corner(cell.lat + cell.size, cell.lng + cell.size),
+        &corner(cell.lat + cell.size, cell.lng),
+    };
+}
+
+bool VrataGrid::same_date_and_type(const std::array<const Corner *, 4> & corners)
+{
+    for (const auto * c : corners) {
+        if (!c->has_value()) return false;
+    }
+    const auto & first = corners[0]->value();
+    for (const auto * c : corners) {
+        if (c->value().date_days != first.date_days || c->value().type != first.type) return false;
+    }
+    return true;
+}
+
+std::array<double, VrataGrid::MarginCount> VrataGrid::margins(const VrataRecord & r)
+{
+    using T = VrataRecord::Time;
+    const auto m = [&r](T t) { return static_cast<double>(r.minutes[t]); };
+    const auto at = [&r](T t) { return r.time(t).value_or(JulDays_UT{Vrata::nan_days}); };
+    const Vrata_Time_Points times{
+        at(T::Ativrddha_54gh_40vigh), at(T::Vrddha_55gh), at(T::Samyam_55gh_50vigh), at(T::Hrasva_55gh_55vigh), at(T::Arunodaya),
+        at(T::DashamiStart), at(T::EkadashiStart), at(T::DvadashiStart), at(T::TrayodashiStart)};
+    // same as ativrddhaditvam_timepoint(), in Ativrddhaadi order
+    constexpr T checked_time_points[] = {T::Ativrddha_54gh_40vigh, T::Vrddha_55gh, T::Samyam_55gh_50vigh, T::Hrasva_55gh_55vigh};
+    const T checked = checked_time_points[static_cast<std::size_t>(times.ativrddhaadi())];
+
+    std::array<double, MarginCount> margins;
+    margins[DashamiViddha] = m(checked) - m(T::EkadashiStart);
+    margins[EkadashiAtSunrise1] = m(T::Sunrise1) - m(T::DvadashiStart);
+    margins[EkadashiAtSunrise2] = m(T::Sunrise2) - m(T::DvadashiStart);
+    margins[DvadashiAtSunrise3] = m(T::Sunrise3) - m(T::TrayodashiStart);
+    // see Calc::get_paran() and Calc::atirikta_paran()
+    margins[DvadashiQuarter] = m(T::Sunrise2) - (m(T::DvadashiStart) + (m(T::TrayodashiStart) - m(T::DvadashiStart)) / 4);
+    margins[DvadashiEndInParan] = m(T::Sunrise2) + (m(T::Sunset2) - m(T::Sunrise2)) / 5 - m(T::TrayodashiStart);
+    margins[DvadashiEndInAtiriktaParan] = m(T::Sunrise3) + (m(T::Sunset3) - m(T::Sunrise3)) / 5 - m(T::TrayodashiStart);
+    return margins;
+}
+
+bool VrataGrid::clear_of_thresholds(const std::array<const Corner *, 4> & corners, std::size_t margin_count) const
+{
+    std::array<std::array<double, MarginCount>, 4> corner_margins;
+    for (std::size_t i = 0; i < corners.size(); ++i) {
+        corner_margins[i] = margins(corners[i]->value());
+    }
+    for (std::size_t k = 0; k < margin_count; ++k) {
+        const bool positive = corner_margins[0][k] > 0.0;
+        for (const auto & m : corner_margins) {
+            // NaN fails the comparison, too
+            if (!(std::fabs(m[k]) >= settings_.margin_minutes) || (m[k] > 0.0) != positive) return false;
+        }
+    }
+    return true;
+}
+
+bool VrataGrid::uniform(const std::array<const Corner *, 4> & corners)
+{
+    if (!same_date_and_type(corners)) return false;
+    const auto & first = corners[0]->value();
+    for (const auto * c : corners) {
+        const auto & r = c->value();
+        if (r.latitude_adjustment != 0
+                || r.paran_type != first.paran_type
+                || r.masa != first.masa
+                || r.paksha != first.paksha
+                || !same_optional_times(r, first)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MaybeVrata VrataGrid::find(const Location & location)
+{
+    if (location.time_zone_name != time_zone_name_) {
+        ++direct_calculations_;
+        return text_ui::calc_one(base_date_, location, settings_.flags);
+    }
+    // position in units of the deepest cell size
+    const double lat_pos = (location.latitude.latitude + 90.0) / fine_step();
+    const double lng_pos = (location.longitude.longitude + 180.0) / fine_step();
+    for (int depth = 0; depth <= settings_.max_depth; ++depth) {
+        const std::int64_t size = std::int64_t{1} << (settings_.max_depth - depth);
+        const CellIndex cell{index_for(lat_pos, static_cast<double>(size)) * size, index_for(lng_pos, static_cast<double>(size)) * size, size};
+        const auto c = corners(cell);
+        if (!uniform(c) || !clear_of_thresholds(c, MarginCount)) continue;
+
+        // bilinear interpolation between corners
+        const double y = (lat_pos - static_cast<double>(cell.lat)) / static_cast<double>(size);
+        const double x = (lng_pos - static_cast<double>(cell.lng)) / static_cast<double>(size);
+        const double weights[4] = {(1 - x) * (1 - y), x * (1 - y), x * y, (1 - x) * y};
+        VrataRecord record = c[0]->value();
+        for (std::size_t t = 0; t < VrataRecord::TimeCount; ++t) {
+            double minutes = 0.0;
+            for (std::size_t i = 0; i < 4; ++i) {
+                minutes += weights[i] * static_cast<double>(c[i]->value().minutes[t]);
+            }
+            record.minutes[t] = static_cast<float>(minutes);
+        }
+        return record.to_vrata(location);
+    }
+    ++direct_calculations_;
+    return text_ui::calc_one(base_date_, location, settings_.flags);
+}
+
+std::vector<VrataGrid::Cell> VrataGrid::boundary_cells(Coord south_west, Coord north_east)
+{
+    std::vector<Cell> cells;
+    const std::int64_t size = std::int64_t{1} << settings_.max_depth;
+    const double step = settings_.cell_degrees;
+    const auto lat_begin = index_for(south_west.latitude.latitude + 90.0, step);
+    const auto lat_end = index_for(north_east.latitude.latitude + 90.0, step);
+    const auto lng_begin = index_for(south_west.longitude.longitude + 180.0, step);
+    const auto lng_end = index_for(north_east.longitude.longitude + 180.0, step);
+    for (auto lat = lat_begin; lat <= lat_end; ++lat) {
+        for (auto lng = lng_begin; lng <= lng_end; ++lng) {
+            const auto c = corners(CellIndex{lat * size, lng * size, size});
+            if (!same_date_and_type(c) || !clear_of_thresholds(c, DateAndTypeMargins)) {
+                cells.push_back(Cell{Coord{Latitude{-90.0 + static_cast<double>(lat) * step}, Longitude{-180.0 + static_cast<double>(lng) * step}}, step});
+            }
+        }
+    }
+    return cells;
+}
+
+} // namespace vp
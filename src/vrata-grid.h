@@ -0,0 +1,112 @@
+#ifndef VP_VRATA_GRID_H
+#define VP_VRATA_GRID_H
+
+#include "calc-flags.h"
+#include "location.h"
+#include "vrata.h"
+#include "vrata-record.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <tl/expected.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace vp {
+
+struct VrataGridSettings {
+    double cell_degrees = 1.0;
+    // cells are split in four up to this many times, down to cell_degrees / 2^max_depth
+    int max_depth = 5;
+    CalcFlags flags = CalcFlags::Default;
+    // cells are also split when some corner has a sunrise (or other time compared with
+    // a tithi boundary) closer than this to that boundary; more than interpolation error
+    double margin_minutes = 1.0;
+};
+
+/* Vratas for arbitrary coordinates in one time zone from the same base date,
+ * for maps and other bulk queries where calculating every point is too slow.
+ *
+ * The globe is split into cells of VrataGridSettings::cell_degrees, and vratas
+ * are only calculated for cell corners (lazily, each corner once). If all four
+ * corners agree on everything except time points (same date, vrata type,
+ * pāraṇam type, māsa and pakṣa, no errors or latitude adjustments), and every
+ * sunrise-vs-tithi comparison deciding them (see Margin) comes out the same way
+ * by more than margin_minutes at all corners, time points for any location inside
+ * the cell are interpolated from the corners. Otherwise the cell is split in four,
+ * and so on down to max_depth; locations in such cells of the deepest level are
+ * calculated directly.
+ *
+ * Margins change almost linearly across a cell, so a date or type change can't hide
+ * entirely inside a cell whose corners are all clear of it. Śravaṇa-dvādaśī depends
+ * on nakṣatra too, which only corners catch.
+ *
+ * Interpolated times are within a minute from calculated ones with default
+ * settings, which is fine for a map. Use the usual calculation for calendars.
+ */
+class VrataGrid {
+public:
+    struct Cell {
+        Coord south_west;
+        double size_degrees;
+    };
+
+    VrataGrid(date::local_days base_date, std::string time_zone_name, VrataGridSettings settings = {});
+
+    // Locations in other time zones are calculated directly.
+    MaybeVrata find(const Location & location);
+    // Top-level cells within the area where vrata date or type differs between corners
+    // or might change inside.
+    std::vector<Cell> boundary_cells(Coord south_west, Coord north_east);
+
+    // number of distinct corners calculated so far
+    std::size_t calculated_corners() const { return corners_.size(); }
+    // number of find() calls which had to calculate the location itself
+    std::size_t direct_calculations() const { return direct_calculations_; }
+
+private:
+    using Corner = tl::expected<VrataRecord, CalcError>;
+    // Signed minutes between a location-dependent time and the tithi boundary which Calc
+    // compares it with: the decision changes where the margin changes sign.
+    enum Margin {
+        // decide vrata date and type
+        DashamiViddha,      // time point which must be free of dashamī - ekādaśī start
+        EkadashiAtSunrise1, // sunrise1 - dvādaśī start
+        EkadashiAtSunrise2, // sunrise2 - dvādaśī start (atiriktā ekādaśī)
+        DvadashiAtSunrise3, // sunrise3 - trayodaśī start (atiriktā dvādaśī)
+        DateAndTypeMargins,
+        // decide pāraṇam type
+        DvadashiQuarter = DateAndTypeMargins, // sunrise2 - first quarter of dvādaśī end
+        DvadashiEndInParan,                   // fifth of day2 - dvādaśī end
+        DvadashiEndInAtiriktaParan,           // fifth of day3 - dvādaśī end
+        MarginCount
+    };
+    // south-west corner and size of a cell, in units of the deepest cell size
+    struct CellIndex {
+        std::int64_t lat;
+        std::int64_t lng;
+        std::int64_t size;
+    };
+
+    const Corner & corner(std::int64_t lat_index, std::int64_t lng_index);
+    // south-west first, then counter-clockwise
+    std::array<const Corner *, 4> corners(CellIndex cell);
+    static bool uniform(const std::array<const Corner *, 4> & corners);
+    static bool same_date_and_type(const std::array<const Corner *, 4> & corners);
+    static std::array<double, MarginCount> margins(const VrataRecord & record);
+    // whether each of the first margin_count margins has the same sign at all corners (with values)
+    // and is at least margin_minutes away from zero
+    bool clear_of_thresholds(const std::array<const Corner *, 4> & corners, std::size_t margin_count) const;
+    double fine_step() const;
+
+    date::local_days base_date_;
+    std::string time_zone_name_;
+    VrataGridSettings settings_;
+    std::unordered_map<std::uint64_t, Corner> corners_;
+    std::size_t direct_calculations_ = 0;
+};
+
+} // namespace vp
+
+#endif // VP_VRATA_GRID_H
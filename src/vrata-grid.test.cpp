@@ -0,0 +1,71 @@
+#include "catch-formatters.h"
+
+#include "text-interface.h"
+#include "vrata-grid.h"
+
+#include <cmath>
+
+using namespace date;
+
+namespace {
+bool close_enough(vp::JulDays_UT one, vp::JulDays_UT other) {
+    return std::fabs((one - other).count()) < 1.0 / (24 * 60); // within a minute
+}
+}
+
+TEST_CASE("VrataGrid interpolates times close to calculated ones") {
+    const auto base_date = local_days{2021_y/February/1};
+    // one grid for all locations, so that later ones are interpolated from the cached corners
+    vp::VrataGrid grid{base_date, "Europe/Kiev"};
+    for (const double latitude : {46.47, 48.3, 50.45}) {
+        for (const double longitude : {24.1, 30.52, 37.8}) {
+            const vp::Location location{vp::Latitude{latitude}, vp::Longitude{longitude}, "Custom Location", "Europe/Kiev"};
+            CAPTURE(latitude, longitude);
+
+            const auto from_grid = grid.find(location);
+            const auto calculated = vp::text_ui::calc_one(base_date, location);
+            REQUIRE(from_grid.has_value());
+            REQUIRE(calculated.has_value());
+            REQUIRE(from_grid->date == calculated->date);
+            REQUIRE(from_grid->type == calculated->type);
+            REQUIRE(from_grid->paran.type == calculated->paran.type);
+            REQUIRE(close_enough(from_grid->sunrise1, calculated->sunrise1));
+            REQUIRE(close_enough(from_grid->sunrise2, calculated->sunrise2));
+            REQUIRE(close_enough(from_grid->times.arunodaya, calculated->times.arunodaya));
+            REQUIRE(from_grid->paran.paran_start.has_value() == calculated->paran.paran_start.has_value());
+            if (calculated->paran.paran_start) {
+                REQUIRE(close_enough(*from_grid->paran.paran_start, *calculated->paran.paran_start));
+            }
+        }
+    }
+}
+
+TEST_CASE("VrataGrid doesn't interpolate over cells where sunrise is too close to a tithi boundary") {
+    const auto base_date = local_days{2021_y/February/1};
+    // margin larger than a day: no cell is clear of thresholds, so everything is calculated directly
+    vp::VrataGrid grid{base_date, "Europe/Kiev", vp::VrataGridSettings{1.0, 1, vp::CalcFlags::Default, 24 * 60 * 2}};
+    const vp::Location location{vp::Latitude{50.45}, vp::Longitude{30.52}, "Custom Location", "Europe/Kiev"};
+    const auto vrata = grid.find(location);
+    REQUIRE(vrata.has_value());
+    REQUIRE(grid.direct_calculations() == 1);
+    REQUIRE(*vrata == *vp::text_ui::calc_one(base_date, location));
+}
+
+TEST_CASE("VrataGrid calculates each corner only once") {
+    vp::VrataGrid grid{local_days{2021_y/February/1}, "Europe/Kiev", vp::VrataGridSettings{1.0, 0}};
+    for (double latitude = 50.1; latitude < 51.0; latitude += 0.2) {
+        for (double longitude = 30.1; longitude < 31.0; longitude += 0.2) {
+            REQUIRE(grid.find(vp::Location{vp::Latitude{latitude}, vp::Longitude{longitude}, "Custom Location", "Europe/Kiev"}).has_value());
+        }
+    }
+    REQUIRE(grid.calculated_corners() == 4);
+}
+
+TEST_CASE("VrataGrid calculates locations in other time zones directly") {
+    vp::VrataGrid grid{local_days{2021_y/February/1}, "Europe/Kiev"};
+    const auto vrata = grid.find(vp::udupi_coord);
+    REQUIRE(vrata.has_value());
+    REQUIRE(grid.calculated_corners() == 0);
+    REQUIRE(grid.direct_calculations() == 1);
+    REQUIRE(*vrata == *vp::text_ui::calc_one(local_days{2021_y/February/1}, vp::udupi_coord));
+}
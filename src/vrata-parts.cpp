@@ -0,0 +1,24 @@
+#include "vrata-parts.h"
+
+#include <type_traits>
+
+using underlying = std::underlying_type_t<vp::VrataParts>;
+
+vp::VrataParts vp::operator&(vp::VrataParts lhs, vp::VrataParts rhs)
+{
+    return static_cast<vp::VrataParts>(
+        static_cast<underlying>(lhs) &
+        static_cast<underlying>(rhs));
+}
+
+vp::VrataParts vp::operator|(vp::VrataParts lhs, vp::VrataParts rhs)
+{
+    return static_cast<vp::VrataParts>(
+        static_cast<underlying>(lhs) |
+        static_cast<underlying>(rhs));
+}
+
+bool vp::wants(vp::VrataParts parts, vp::VrataParts part)
+{
+    return (parts & part) == part;
+}
@@ -0,0 +1,23 @@
+#ifndef VRATA_PARTS_H
+#define VRATA_PARTS_H
+
+namespace vp {
+
+// bitmask: what Calc::find_next_vrata() (and text_ui::calc() etc) calculates besides vrata date and pakṣa.
+// Vrata fields which were not asked for are left default-initialized.
+enum class VrataParts {
+    DateOnly = 0,
+    Type = 1,           // type and sunset2/sunrise3
+    Paran = 3,          // pāraṇam and sunset3 (implies Type)
+    Masa = 4,
+    NameworthyDates = 15, // dates_for_this_paksha, added by text_ui::calc() (implies everything else)
+    All = 15,
+};
+
+VrataParts operator&(VrataParts lhs, VrataParts rhs);
+VrataParts operator|(VrataParts lhs, VrataParts rhs);
+// true if parts include everything part needs
+bool wants(VrataParts parts, VrataParts part);
+
+}
+#endif // VRATA_PARTS_H
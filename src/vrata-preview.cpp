@@ -0,0 +1,136 @@
+#include "vrata-preview.h"
+
+#include "approx-sky.h"
+#include "calc.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vp {
+
+namespace {
+// Fastest changes of tithi and nakṣatra: Moon moves up to ~15.4°/day, ~14.5°/day relative to the Sun.
+// Time to the nearest limit is at least the distance (in tithis/nakṣatras) times these.
+constexpr double min_days_per_tithi = (360.0 / 30) / 14.5;
+constexpr double min_days_per_nakshatra = (360.0 / 27) / 15.4;
+
+class Previewer {
+public:
+    Previewer(const Location & location, CalcFlags flags) : sky(location, flags), flags(flags) {}
+
+    tl::expected<VrataPreview, CalcError> find(date::local_days after);
+
+private:
+    ApproxSky sky;
+    CalcFlags flags;
+    bool uncertain = false;
+
+    void check_distance(double distance_days) {
+        if (std::fabs(distance_days) < double_days{ApproxSky::ErrorBound()}.count()) {
+            uncertain = true;
+        }
+    }
+    // Is it tithi number `first` (of either pakṣa) at the given time? E.g. 9 for Daśamī.
+    bool tithi_is(JulDays_UT time, double first) {
+        const double tithi = std::fmod(sky.tithi(time).tithi, 15.0);
+        check_distance((tithi - first) * min_days_per_tithi);
+        check_distance((tithi - (first + 1)) * min_days_per_tithi);
+        return tithi >= first && tithi < first + 1;
+    }
+    bool is_shravana(JulDays_UT time) {
+        const double nakshatra = sky.nakshatra(time).nakshatra;
+        constexpr double first = 21.0; // DiscreteNakshatra::Shravana()
+        check_distance((nakshatra - first) * min_days_per_nakshatra);
+        check_distance((nakshatra - (first + 1)) * min_days_per_nakshatra);
+        return nakshatra >= first && nakshatra < first + 1;
+    }
+    bool got_shravana(JulDays_UT sunrise, JulDays_UT sunset, JulDays_UT next_sunrise);
+};
+
+// see got_shravana_for_sunrise_sunset() in calc.cpp
+bool Previewer::got_shravana(JulDays_UT sunrise, JulDays_UT sunset, JulDays_UT next_sunrise)
+{
+    if (!is_shravana(sunrise)) return false;
+    if (!tithi_is(sunrise, 11)) return false;
+    const bool require_14gh = ((flags & CalcFlags::ShravanaDvadashiMask) == CalcFlags::ShravanaDvadashi14ghPlus);
+    const auto madhyahna_limit = Calc::proportional_time(sunrise, sunset, require_14gh ? 7.0/15 : 2.0/5);
+    if (!is_shravana(madhyahna_limit)) return false;
+    if (!tithi_is(madhyahna_limit, 11)) return false;
+    return !is_shravana(next_sunrise);
+}
+
+// Like VP_TRY_AUTO in calc.cpp, but not const: sunrises get moved to the next day
+#define VP_TRY_AUTO(var, expr)                          \
+    auto var = (expr);                                  \
+    if (!var) return tl::make_unexpected(var.error());
+
+// see Calc::find_next_vrata()
+tl::expected<VrataPreview, CalcError> Previewer::find(date::local_days after)
+{
+    constexpr double_days small_enough_delta{0.001};
+    const auto midnight = JulDays_UT{after} - double_days{sky.location.longitude.longitude * (1.0/360.0)};
+    auto start_time = midnight - double_days{3.0};
+    for (int run = 0; run < 2; ++run) {
+        const auto ekadashi_start = sky.find_either_tithi_start(start_time, Tithi::Ekadashi());
+        VP_TRY_AUTO(sunrise1, sky.find_sunrise(ekadashi_start))
+        // Ekādaśī starting right before sunrise1 or right after the previous one might have picked another sunrise
+        check_distance((*sunrise1 - ekadashi_start).count());
+        VP_TRY_AUTO(prev_sunrise, sky.find_sunrise(*sunrise1 - double_days{1.1}))
+        check_distance((ekadashi_start - *prev_sunrise).count());
+
+        VP_TRY_AUTO(sunset0, sky.find_sunset(*sunrise1 - double_days{1.0}))
+        VP_TRY_AUTO(sunrise2, sky.find_sunrise(*sunrise1 + small_enough_delta))
+        const auto ghatika = (*sunrise1 - *sunset0) / 30.0;
+        const auto ativrddha_timepoint = *sunrise1 - 5 * ghatika - 20 * (ghatika / 60.0);
+        const auto paksha = sky.tithi(ativrddha_timepoint).get_paksha();
+        if (tithi_is(ativrddha_timepoint, 9)) {
+            sunrise1 = sunrise2;
+            sunrise2 = sky.find_sunrise(*sunrise1 + small_enough_delta);
+            if (!sunrise2) return tl::make_unexpected(sunrise2.error());
+        }
+
+        Vrata vrata;
+        vrata.location = sky.location;
+        vrata.paksha = paksha;
+        vrata.date = date::floor<date::days>(sunrise1->as_zoned_time(sky.location.time_zone()).get_local_time());
+        if (vrata.date < after) {
+            start_time = midnight;
+            continue;
+        }
+
+        VP_TRY_AUTO(sunset2, sky.find_sunset(*sunrise2))
+        VP_TRY_AUTO(sunrise3, sky.find_sunrise(*sunrise2 + small_enough_delta))
+        // see Calc::calc_vrata_type()
+        if (got_shravana(*sunrise2, *sunset2, *sunrise3)) {
+            vrata.type = Vrata_Type::With_Shravana_Dvadashi_Next_Day;
+        } else if (const auto sunset1 = sky.find_sunset(*sunrise1); sunset1 && got_shravana(*sunrise1, *sunset1, *sunrise2)) {
+            vrata.type = Vrata_Type::With_Shravana_Dvadashi_Same_Day;
+        } else if (tithi_is(*sunrise1, 10) && tithi_is(*sunrise2, 10)) {
+            vrata.type = Vrata_Type::With_Atirikta_Ekadashi;
+        } else if (tithi_is(*sunrise2, 11) && tithi_is(*sunrise3, 11)) {
+            vrata.type = Vrata_Type::With_Atirikta_Dvadashi;
+        } else {
+            vrata.type = Vrata_Type::Ekadashi;
+        }
+        return VrataPreview{std::move(vrata), uncertain};
+    }
+    // exact calculation would throw here, so it must be an approximation error
+    Vrata vrata;
+    vrata.location = sky.location;
+    return VrataPreview{std::move(vrata), true};
+}
+
+#undef VP_TRY_AUTO
+
+} // anonymous namespace
+
+tl::expected<VrataPreview, CalcError> preview_next_vrata(date::local_days after, const Location & location, CalcFlags flags)
+{
+    auto preview = Previewer{location, flags}.find(after);
+    if (preview && std::fabs(location.latitude.latitude) > 60.0) {
+        preview->uncertain = true;
+    }
+    return preview;
+}
+
+} // namespace vp
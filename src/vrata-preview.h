@@ -0,0 +1,32 @@
+#ifndef VP_VRATA_PREVIEW_H
+#define VP_VRATA_PREVIEW_H
+
+#include "calc-error.h"
+#include "calc-flags.h"
+#include "location.h"
+#include "vrata.h"
+
+#include <tl/expected.hpp>
+
+namespace vp {
+
+struct VrataPreview {
+    // only date, type, pakṣa and location are set
+    Vrata vrata;
+    // Some tithi or nakṣatra check was closer to its limit than ApproxSky::ErrorBound(),
+    // so the exact calculation might give another date or type.
+    bool uncertain = false;
+};
+
+/* Same rules as Calc::find_next_vrata() (dashamī-viddhā, Śravaṇa-dvādaśī,
+ * atiriktā), but with ApproxSky instead of sweph, which is much cheaper.
+ * Every tithi and nakṣatra check remembers how far it was from changing
+ * its answer; if any was within ApproxSky::ErrorBound(),
+ * the result is marked uncertain. Locations above 60° latitude are always
+ * uncertain: the exact calculation adjusts latitude there when the Sun doesn't rise.
+ */
+tl::expected<VrataPreview, CalcError> preview_next_vrata(date::local_days after, const Location & location, CalcFlags flags = CalcFlags::Default);
+
+} // namespace vp
+
+#endif // VP_VRATA_PREVIEW_H
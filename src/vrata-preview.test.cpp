@@ -0,0 +1,68 @@
+#include "catch-formatters.h"
+
+#include "text-interface.h"
+#include "vrata-preview.h"
+
+using namespace date;
+
+TEST_CASE("preview_next_vrata() agrees with exact calculation unless it's uncertain") {
+    const auto location = GENERATE(vp::udupi_coord, vp::kiev_coord, vp::tekeli_coord, vp::fredericton_coord, vp::toronto_coord);
+    CAPTURE(location.name);
+    int uncertain = 0;
+    int total = 0;
+    for (auto base_date = local_days{2020_y/January/1}; base_date < local_days{2021_y/January/1}; base_date += days{10}) {
+        CAPTURE(base_date);
+        const auto preview = vp::preview_next_vrata(base_date, location);
+        REQUIRE(preview.has_value());
+        ++total;
+        if (preview->uncertain) {
+            ++uncertain;
+            continue;
+        }
+        // full calculation, not the partial one, which would share any mistake made in skipping parts
+        const auto exact = vp::text_ui::calc_one(base_date, location);
+        REQUIRE(exact.has_value());
+        REQUIRE(preview->vrata.date == exact->date);
+        REQUIRE(preview->vrata.type == exact->type);
+        REQUIRE(preview->vrata.paksha == exact->paksha);
+    }
+    // the whole point is that most vratas don't need exact calculation
+    REQUIRE(uncertain * 4 < total);
+}
+
+TEST_CASE("preview_next_vrata() finds special vrata types") {
+    SECTION("Tekeli 2020-03-20: Ekādaśī + Śravaṇa-dvādaśī same day") {
+        const auto preview = vp::preview_next_vrata(local_days{2020_y/3/19}, vp::tekeli_coord);
+        REQUIRE(preview.has_value());
+        REQUIRE(preview->vrata.date == local_days{2020_y/3/20});
+        REQUIRE(preview->vrata.type == vp::Vrata_Type::With_Shravana_Dvadashi_Same_Day);
+    }
+    SECTION("Fredericton 2019-09-09: Śravaṇa-dvādaśī next day") {
+        const auto preview = vp::preview_next_vrata(local_days{2019_y/9/9}, vp::fredericton_coord);
+        REQUIRE(preview.has_value());
+        REQUIRE(preview->vrata.date == local_days{2019_y/9/9});
+        REQUIRE(preview->vrata.type == vp::Vrata_Type::With_Shravana_Dvadashi_Next_Day);
+    }
+}
+
+TEST_CASE("refine_previews() gives the same dates and types as calc_one()") {
+    const auto base_date = 2020_y/March/19;
+    const auto previews = vp::text_ui::preview(base_date, "all");
+    REQUIRE(previews.size() == vp::text_ui::LocationDb::size());
+    const auto vratas = vp::text_ui::refine_previews(base_date, previews);
+    REQUIRE(vratas.size() == previews.size());
+    for (std::size_t i = 0; i < vratas.size(); ++i) {
+        const auto & location = previews[i].vrata.location;
+        CAPTURE(location.name);
+        const auto exact = vp::text_ui::calc_one(local_days{base_date}, location);
+        REQUIRE(vratas[i].has_value() == exact.has_value());
+        if (exact) {
+            REQUIRE(vratas[i]->date == exact->date);
+            REQUIRE(vratas[i]->type == exact->type);
+        }
+    }
+}
+
+TEST_CASE("preview() is empty for unknown locations") {
+    REQUIRE(vp::text_ui::preview(2020_y/March/19, "no such place").empty());
+}
@@ -0,0 +1,138 @@
+#include "vrata-record.h"
+
+#include <cmath>
+#include <limits>
+
+namespace vp {
+
+namespace {
+constexpr double minutes_per_day = 24 * 60;
+
+JulDays_UT reference_time(date::local_days date) {
+    return JulDays_UT{date};
+}
+
+float to_minutes(std::optional<JulDays_UT> t, JulDays_UT reference) {
+    if (!t) return std::numeric_limits<float>::quiet_NaN();
+    return static_cast<float>((*t - reference).count() * minutes_per_day);
+}
+
+JulDays_UT from_minutes(float minutes, JulDays_UT reference) {
+    return reference + double_days{static_cast<double>(minutes) / minutes_per_day};
+}
+} // anonymous namespace
+
+VrataRecord VrataRecord::from_vrata(const Vrata & vrata, std::uint16_t location_index, const Location & base_location)
+{
+    VrataRecord r;
+    r.date_days = static_cast<std::int32_t>(vrata.date.time_since_epoch().count());
+    r.location_index = location_index;
+    r.type = static_cast<std::uint8_t>(vrata.type);
+    r.paran_type = static_cast<std::uint8_t>(vrata.paran.type);
+    r.masa = static_cast<std::uint8_t>(vrata.masa);
+    r.paksha = static_cast<std::uint8_t>(vrata.paksha);
+    if (vrata.location.latitude_adjusted) {
+        r.latitude_adjustment = static_cast<std::uint8_t>(std::lround(base_location.latitude.latitude - vrata.location.latitude.latitude));
+    }
+
+    const auto ref = reference_time(vrata.date);
+    auto & m = r.minutes;
+    m[ParanStart] = to_minutes(vrata.paran.paran_start, ref);
+    m[ParanEnd] = to_minutes(vrata.paran.paran_end, ref);
+    m[ParanLimit] = to_minutes(vrata.paran.paran_limit, ref);
+    m[Sunrise0] = to_minutes(vrata.sunrise0, ref);
+    m[Sunset0] = to_minutes(vrata.sunset0, ref);
+    m[Sunrise1] = to_minutes(vrata.sunrise1, ref);
+    m[Sunrise2] = to_minutes(vrata.sunrise2, ref);
+    m[Sunset2] = to_minutes(vrata.sunset2, ref);
+    m[Sunrise3] = to_minutes(vrata.sunrise3, ref);
+    m[Sunset3] = to_minutes(vrata.sunset3, ref);
+    m[Ativrddha_54gh_40vigh] = to_minutes(vrata.times.ativrddha_54gh_40vigh, ref);
+    m[Vrddha_55gh] = to_minutes(vrata.times.vrddha_55gh, ref);
+    m[Samyam_55gh_50vigh] = to_minutes(vrata.times.samyam_55gh_50vigh, ref);
+    m[Hrasva_55gh_55vigh] = to_minutes(vrata.times.hrasva_55gh_55vigh, ref);
+    m[Arunodaya] = to_minutes(vrata.times.arunodaya, ref);
+    m[DashamiStart] = to_minutes(vrata.times.dashami_start, ref);
+    m[EkadashiStart] = to_minutes(vrata.times.ekadashi_start, ref);
+    m[DvadashiStart] = to_minutes(vrata.times.dvadashi_start, ref);
+    m[TrayodashiStart] = to_minutes(vrata.times.trayodashi_start, ref);
+    return r;
+}
+
+std::optional<JulDays_UT> VrataRecord::time(Time t) const
+{
+    if (std::isnan(minutes[t])) return std::nullopt;
+    return from_minutes(minutes[t], reference_time(date()));
+}
+
+Vrata VrataRecord::to_vrata(const Location & base_location) const
+{
+    Location location = base_location;
+    if (latitude_adjustment != 0) {
+        location.latitude.latitude -= latitude_adjustment;
+        location.latitude_adjusted = true;
+    }
+    const auto ref = reference_time(date());
+    // non-optional values are NaN only in test vratas, and NaN survives the round trip anyway
+    auto t = [&](Time index) { return from_minutes(minutes[index], ref); };
+    const Vrata_Time_Points times{
+        t(Ativrddha_54gh_40vigh), t(Vrddha_55gh), t(Samyam_55gh_50vigh), t(Hrasva_55gh_55vigh), t(Arunodaya),
+        t(DashamiStart), t(EkadashiStart), t(DvadashiStart), t(TrayodashiStart)
+    };
+    Paran paran{static_cast<Paran::Type>(paran_type), time(ParanStart), time(ParanEnd), time(ParanLimit), location.time_zone()};
+    Vrata vrata{vrata_type(), date(), static_cast<Chandra_Masa>(masa), static_cast<Paksha>(paksha), paran, location, times};
+    vrata.sunrise0 = time(Sunrise0);
+    vrata.sunset0 = t(Sunset0);
+    vrata.sunrise1 = t(Sunrise1);
+    vrata.sunrise2 = t(Sunrise2);
+    vrata.sunset2 = t(Sunset2);
+    vrata.sunrise3 = t(Sunrise3);
+    vrata.sunset3 = t(Sunset3);
+    return vrata;
+}
+
+void VrataColumns::reserve(std::size_t size)
+{
+    date_days_.reserve(size);
+    location_index_.reserve(size);
+    type_.reserve(size);
+    paran_type_.reserve(size);
+    masa_.reserve(size);
+    paksha_.reserve(size);
+    latitude_adjustment_.reserve(size);
+    for (auto & column : minutes_) {
+        column.reserve(size);
+    }
+}
+
+void VrataColumns::push_back(const VrataRecord & record)
+{
+    date_days_.push_back(record.date_days);
+    location_index_.push_back(record.location_index);
+    type_.push_back(record.type);
+    paran_type_.push_back(record.paran_type);
+    masa_.push_back(record.masa);
+    paksha_.push_back(record.paksha);
+    latitude_adjustment_.push_back(record.latitude_adjustment);
+    for (std::size_t t = 0; t < VrataRecord::TimeCount; ++t) {
+        minutes_[t].push_back(record.minutes[t]);
+    }
+}
+
+VrataRecord VrataColumns::operator[](std::size_t i) const
+{
+    VrataRecord r;
+    r.date_days = date_days_[i];
+    r.location_index = location_index_[i];
+    r.type = type_[i];
+    r.paran_type = paran_type_[i];
+    r.masa = masa_[i];
+    r.paksha = paksha_[i];
+    r.latitude_adjustment = latitude_adjustment_[i];
+    for (std::size_t t = 0; t < VrataRecord::TimeCount; ++t) {
+        r.minutes[t] = minutes_[t][i];
+    }
+    return r;
+}
+
+} // namespace vp
@@ -0,0 +1,84 @@
+#ifndef VP_VRATA_RECORD_H
+#define VP_VRATA_RECORD_H
+
+#include "location.h"
+#include "vrata.h"
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace vp {
+
+/* Compact, trivially copyable representation of a Vrata for bulk storage.
+ * Location is stored as an index (usually into LocationDb), every time point
+ * as float minutes since 00:00 UTC of the vrata date. With time points within
+ * a few days from the vrata date that gives better than 0.05 second precision,
+ * which is within JulDays_UT comparison tolerance, so to_vrata() gives back
+ * the same Vrata.
+ * dates_for_this_paksha are not stored: call nameworthy_dates_for_this_paksha()
+ * after to_vrata() when they are needed.
+ */
+struct VrataRecord {
+    enum Time : std::uint8_t {
+        ParanStart, ParanEnd, ParanLimit,
+        Sunrise0, Sunset0, Sunrise1, Sunrise2, Sunset2, Sunrise3, Sunset3,
+        Ativrddha_54gh_40vigh, Vrddha_55gh, Samyam_55gh_50vigh, Hrasva_55gh_55vigh, Arunodaya,
+        DashamiStart, EkadashiStart, DvadashiStart, TrayodashiStart,
+        TimeCount
+    };
+
+    std::int32_t date_days = 0; // vrata date as days since 1970-01-01
+    std::uint16_t location_index = 0;
+    std::uint8_t type = 0;       // Vrata_Type
+    std::uint8_t paran_type = 0; // Paran::Type
+    std::uint8_t masa = 0;       // Chandra_Masa
+    std::uint8_t paksha = 0;     // Paksha
+    // whole degrees by which latitude was decreased to find sunrises/sunsets (Location::latitude_adjusted)
+    std::uint8_t latitude_adjustment = 0;
+    // not used by VrataRecord itself, free for containers of records (see VrataDb)
+    std::uint8_t flags = 0;
+    // minutes since 00:00 UTC of the vrata date, NaN for missing optional values
+    std::array<float, TimeCount> minutes{};
+
+    // base_location is the location before any latitude adjustments, i.e. the one with given location_index
+    static VrataRecord from_vrata(const Vrata & vrata, std::uint16_t location_index, const Location & base_location);
+    Vrata to_vrata(const Location & base_location) const;
+
+    date::local_days date() const { return date::local_days{date::days{date_days}}; }
+    Vrata_Type vrata_type() const { return static_cast<Vrata_Type>(type); }
+    std::optional<JulDays_UT> time(Time t) const;
+};
+
+static_assert(std::is_trivially_copyable_v<VrataRecord>, "VrataRecord must be trivially copyable for bulk storage");
+
+// Column-wise storage of many VrataRecord-s: every field is kept in its own
+// vector, which compresses much better and allows scanning single fields
+// (e.g. only dates) without touching the rest.
+class VrataColumns {
+public:
+    void reserve(std::size_t size);
+    void push_back(const VrataRecord & record);
+    VrataRecord operator[](std::size_t i) const;
+    std::size_t size() const { return date_days_.size(); }
+    bool empty() const { return date_days_.empty(); }
+
+    const std::vector<std::int32_t> & date_days() const { return date_days_; }
+    const std::vector<std::uint16_t> & location_indexes() const { return location_index_; }
+    const std::vector<float> & minutes(VrataRecord::Time t) const { return minutes_[t]; }
+
+private:
+    std::vector<std::int32_t> date_days_;
+    std::vector<std::uint16_t> location_index_;
+    std::vector<std::uint8_t> type_;
+    std::vector<std::uint8_t> paran_type_;
+    std::vector<std::uint8_t> masa_;
+    std::vector<std::uint8_t> paksha_;
+    std::vector<std::uint8_t> latitude_adjustment_;
+    std::array<std::vector<float>, VrataRecord::TimeCount> minutes_;
+};
+
+} // namespace vp
+
+#endif // VP_VRATA_RECORD_H
@@ -0,0 +1,82 @@
+#include "catch-formatters.h"
+
+#include "text-interface.h"
+#include "vrata-record.h"
+
+#include <cstring>
+
+using namespace date;
+using namespace std::chrono_literals;
+
+namespace {
+void require_same_vrata(const vp::Vrata & restored, const vp::Vrata & original) {
+    REQUIRE(restored == original);
+    REQUIRE(restored.paran.paran_limit == original.paran.paran_limit);
+    REQUIRE(restored.location == original.location);
+    REQUIRE(restored.location.latitude_adjusted == original.location.latitude_adjusted);
+    REQUIRE(restored.location_name() == original.location_name());
+    REQUIRE(restored.sunrise0 == original.sunrise0);
+    REQUIRE(restored.sunset0 == original.sunset0);
+    REQUIRE(restored.sunrise1 == original.sunrise1);
+    REQUIRE(restored.sunrise2 == original.sunrise2);
+    REQUIRE(restored.sunset2 == original.sunset2);
+    REQUIRE(restored.sunrise3 == original.sunrise3);
+    REQUIRE(restored.sunset3 == original.sunset3);
+    REQUIRE(restored.times.arunodaya == original.times.arunodaya);
+    REQUIRE(restored.times.dashami_start == original.times.dashami_start);
+    REQUIRE(restored.times.trayodashi_start == original.times.trayodashi_start);
+    REQUIRE(restored.times.ativrddhaadi() == original.times.ativrddhaadi());
+}
+}
+
+TEST_CASE("VrataRecord is small") {
+    REQUIRE(sizeof(vp::VrataRecord) <= 96);
+    REQUIRE(sizeof(vp::VrataRecord) * 3 < sizeof(vp::Vrata));
+}
+
+TEST_CASE("VrataRecord round-trips sample Vrata") {
+    auto vrata = vp::Vrata::SampleVrata();
+    vrata.paran = vp::Paran{vp::Paran::Type::Puccha_Dvadashi, vrata.sunrise2, vrata.sunrise2 + 1h + 23min + 17s, vp::sample_location.time_zone()};
+    const auto record = vp::VrataRecord::from_vrata(vrata, 42, vp::sample_location);
+    REQUIRE(record.location_index == 42);
+    REQUIRE(record.date() == vrata.date);
+    REQUIRE(record.vrata_type() == vrata.type);
+    REQUIRE(!record.time(vp::VrataRecord::Sunrise0).has_value());
+    REQUIRE(!record.time(vp::VrataRecord::ParanLimit).has_value());
+    require_same_vrata(record.to_vrata(vp::sample_location), vrata);
+}
+
+TEST_CASE("VrataRecord round-trips calculated vratas, including adjusted latitude") {
+    const auto [date, location] = GENERATE(table<date::year_month_day, const char *>({
+        {2018_y/August/15, "Udupi"},
+        {2020_y/June/3, "Murmansk"},
+        {2019_y/March/1, "Toronto"},
+    }));
+    CAPTURE(date, location);
+    const auto vratas = vp::text_ui::calc(date, location);
+    const auto & vrata = vratas.begin()->value();
+    const auto base_location = *vp::text_ui::LocationDb::find_coord(location);
+    const auto record = vp::VrataRecord::from_vrata(vrata, 7, base_location);
+    require_same_vrata(record.to_vrata(base_location), vrata);
+    REQUIRE(fmt::format("{:c}", record.to_vrata(base_location).paran) == fmt::format("{:c}", vrata.paran));
+}
+
+TEST_CASE("VrataColumns stores and gives back the same records") {
+    vp::VrataColumns columns;
+    std::vector<vp::VrataRecord> records;
+    auto vrata = vp::Vrata::SampleVrata();
+    for (std::uint16_t i = 0; i < 10; ++i) {
+        vrata.date += date::days{15};
+        records.push_back(vp::VrataRecord::from_vrata(vrata, i, vp::sample_location));
+        columns.push_back(records.back());
+    }
+    REQUIRE(columns.size() == 10);
+    REQUIRE(columns.date_days().size() == 10);
+    REQUIRE(columns[3].location_index == 3);
+    REQUIRE(columns[3].date() == date::local_days{2000_y/1/1} + date::days{4*15});
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const auto record = columns[i];
+        // compare bytes since missing values are NaNs which never compare equal
+        REQUIRE(std::memcmp(&record, &records[i], sizeof(record)) == 0);
+    }
+}
@@ -1,6 +1,7 @@
 #ifndef VP_VRATA_SUMMARY_H
 #define VP_VRATA_SUMMARY_H
 
+#include "time-format.h"
 #include "vrata.h"
 
 #include "fmt-format-fixed.h"
@@ -35,7 +36,7 @@ struct fmt::formatter<vp::Vrata_Summary> : fmt::formatter<std::string_view> {
         const auto paran_date = date::year_month_day{vs.vrata->local_paran_date()}; // year_month_day to ensure proper formatting, wihout hours, minutes and seconds
         fmt::format_to(ctx.out(), FMT_STRING(R"(<p class="paran">Pāraṇam: {} <span class="paran-range">{}–{})"), paran_date, vs.vrata->paran.start_str(), vs.vrata->paran.end_str());
         if (vs.vrata->paran.paran_limit) {
-            const auto limit_str = date::format("%H:%M", date::floor<std::chrono::minutes>(vs.vrata->paran.paran_limit->as_zoned_time(vs.vrata->paran.time_zone).get_local_time()));
+            const auto limit_str = vp::hh_mm(date::floor<std::chrono::minutes>(vs.vrata->paran.paran_limit->as_zoned_time(vs.vrata->paran.time_zone).get_local_time()));
             fmt::format_to(ctx.out(), FMT_STRING(" (&lt;{})"), limit_str);
         }
         fmt::format_to(ctx.out(), FMT_STRING("</span><br>"));
@@ -106,6 +106,16 @@ bool ekadashi_name_rus_is_valid(const std::string &name)
     return valid_names.find(name) != valid_names.end();
 }
 
+Vrata::Vrata(Vrata && other, std::pmr::memory_resource * resource)
+    : dates_for_this_paksha(resource)
+{
+    NamedDates dates{std::move(other.dates_for_this_paksha), resource};
+    other.dates_for_this_paksha.clear();
+    *this = std::move(other);
+    // both use the same resource now, so this just takes over the nodes
+    dates_for_this_paksha = std::move(dates);
+}
+
 date::local_days Vrata::local_paran_date() const
 {
     auto delta = date::days{vp::is_atirikta(type) ? 2 : 1};
@@ -226,6 +236,15 @@ Vrata_Time_Points::Ativrddhaadi Vrata_Time_Points::ativrddhaadi() const
             return Ativrddhaadi::samyam;
 }
 
+void VratasForDate::push_back(MaybeVrata && vrata)
+{
+    if (vrata) {
+        vector.emplace_back(tl::in_place, std::move(*vrata), resource());
+    } else {
+        vector.push_back(std::move(vrata));
+    }
+}
+
 MinMaxDate VratasForDate::minmax_date() const
 {
     auto [it_min, it_max] = std::minmax_element(
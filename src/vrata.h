@@ -14,6 +14,7 @@
 #include "fmt-format-fixed.h"
 #include <limits>
 #include <map>
+#include <memory_resource>
 #include <optional>
 
 namespace vp {
@@ -89,6 +90,7 @@ struct Vrata_Time_Points {
 
 // stores events for given pakṣa, including details for Ekādaśī vrata
 struct Vrata {
+    // stays Ekadashi when calculated without VrataParts::Type: check the parts before relying on it
     Vrata_Type type = Vrata_Type::Ekadashi;
     date::local_days date;
     Paran paran;
@@ -110,6 +112,9 @@ struct Vrata {
 
     Vrata(){}
 
+    // Same as move constructor, but dates_for_this_paksha get (re)allocated from the given memory resource.
+    Vrata(Vrata && other, std::pmr::memory_resource * resource);
+
     // used only for tests
     Vrata(date::local_days _date, Chandra_Masa _masa, Paksha _paksha)
         : date(_date), masa(_masa), paksha(_paksha) {}
@@ -160,8 +165,15 @@ struct MinMaxDate {
 // All calculated vratas for the same date but different locations.
 class VratasForDate {
 private:
-    using MaybeVratas = std::vector<MaybeVrata>;
+    using MaybeVratas = std::pmr::vector<MaybeVrata>;
 public:
+    VratasForDate() = default;
+    // Vratas and their dates_for_this_paksha get allocated from the given memory resource
+    // (e.g. per-request std::pmr::monotonic_buffer_resource). Such VratasForDate must not outlive
+    // the resource; copy it to get a VratasForDate with default allocation.
+    explicit VratasForDate(std::pmr::memory_resource * resource) : vector(resource) {}
+    std::pmr::memory_resource * resource() const { return vector.get_allocator().resource(); }
+
     // true if all vratas in the set are within 1 day from one another.
     bool all_from_same_ekadashi() const;
 
@@ -173,11 +185,9 @@ public:
     std::optional<date::local_days> max_date() const;
 
     inline void push_back(const MaybeVrata & vrata) {
-        vector.push_back(vrata);
-    }
-    inline void push_back(MaybeVrata && vrata) {
-        vector.push_back(vrata);
+        push_back(MaybeVrata{vrata});
     }
+    void push_back(MaybeVrata && vrata);
     inline MaybeVratas::const_iterator cbegin() const {
         return vector.cbegin();
     }
@@ -67,3 +67,25 @@ TEST_CASE("Vrata_Type formatting") {
     REQUIRE(fmt::to_string(vp::Vrata_Type::With_Shravana_Dvadashi_Next_Day) == "Ekādaśī with next-day Śravaṇa-dvādaśī (two days fast)");
     REQUIRE(fmt::to_string(vp::Vrata_Type::With_Shravana_Dvadashi_Same_Day) == "Ekādaśī with same-day Śravaṇa-dvādaśī");
 }
+
+TEST_CASE("VratasForDate allocates vratas' nameworthy dates from its memory resource") {
+    std::pmr::monotonic_buffer_resource arena;
+    vp::VratasForDate vratas{&arena};
+    {
+        auto vrata = vp::Vrata::SampleVrata();
+        vrata.dates_for_this_paksha.emplace(date::local_days{2000_y/1/3}, vp::NamedDate{"some rather long event name", "some title"});
+        vratas.push_back(std::move(vrata));
+    }
+    REQUIRE(vratas.resource() == &arena);
+    const auto & dates = vratas.begin()->value().dates_for_this_paksha;
+    REQUIRE(dates.get_allocator().resource() == &arena);
+    REQUIRE(dates.begin()->second.name.get_allocator().resource() == &arena);
+    REQUIRE(dates.begin()->second.name == "some rather long event name");
+
+    SECTION("copy of such VratasForDate uses default allocation again") {
+        const vp::VratasForDate copy = vratas;
+        REQUIRE(copy.resource() == std::pmr::get_default_resource());
+        REQUIRE(copy.begin()->value().dates_for_this_paksha.get_allocator().resource() == std::pmr::get_default_resource());
+        REQUIRE(copy.begin()->value().dates_for_this_paksha.begin()->second.title == "some title");
+    }
+}
@@ -0,0 +1,395 @@
+/* Differential accuracy check of the fast calculation paths against plain sweph.
+ *
+ * For every built-in location and base dates every few days over the given years,
+ * calculates the next vrata (date, type, pāraṇam), sunrise and sunset of the base date
+ * and next tithi/nakṣatra starts after that sunrise twice: as reference (sweph only,
+ * no embedded ephemeris, no boundary cache) and as fast (embedded ephemeris if compiled
+ * in, BoundaryCache shared by all cases of a thread). Fast dates and types are also
+ * checked with preview_next_vrata(), and vratas with VrataGrid (one per base date and
+ * time zone, queried at the locations' coordinates) and with a VrataDb generated for
+ * the same years. Prints maximum and percentiles of time deviations and every
+ * classification flip of each path; exit code is 1 when anything is out of tolerance,
+ * so it's run as "accuracy" ctest test.
+ */
+#include "calc.h"
+#include "temp-files.h"
+#include "text-interface.h"
+#include "vrata-db.h"
+#include "vrata-grid.h"
+#include "vrata-preview.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "date-fixed.h"
+#include "fmt-format-fixed.h"
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace {
+
+constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+constexpr double seconds_per_day = 86400.0;
+
+void print_usage() {
+    fmt::print("USAGE:\n"
+               "accuracy-harness [-j threads] [-d step-days] [-t max-seconds] [-g max-grid-seconds] from-year to-year\n"
+               "\n"
+               "    Compares fast calculations with reference ones for all built-in locations and base dates\n"
+               "    every step-days days (7 by default) from 1st January of from-year to 31st December of to-year.\n"
+               "    Exit code is 1 on any classification flip (date, type, pāraṇam type or error)\n"
+               "    or time deviation over max-seconds (1 by default; max-grid-seconds, 60 by default,\n"
+               "    for VrataGrid, which interpolates times inside grid cells).\n"
+               "    -j runs that many threads (all cores by default).\n");
+}
+
+struct Options {
+    unsigned threads = 0;
+    int step_days = 7;
+    double max_seconds = 1.0;
+    double max_grid_seconds = 60.0;
+    int from_year = 0;
+    int to_year = 0;
+};
+
+std::optional<Options> parse_options(int argc, char * argv[]) {
+    Options options;
+    std::vector<const char *> years;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            const int threads = std::atoi(argv[++i]);
+            if (threads <= 0) return std::nullopt;
+            options.threads = static_cast<unsigned>(threads);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            options.step_days = std::atoi(argv[++i]);
+            if (options.step_days <= 0) return std::nullopt;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            options.max_seconds = std::atof(argv[++i]);
+            if (!(options.max_seconds > 0.0)) return std::nullopt;
+        } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            options.max_grid_seconds = std::atof(argv[++i]);
+            if (!(options.max_grid_seconds > 0.0)) return std::nullopt;
+        } else if (argv[i][0] != '-') {
+            years.push_back(argv[i]);
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (years.size() != 2) return std::nullopt;
+    options.from_year = std::atoi(years[0]);
+    options.to_year = std::atoi(years[1]);
+    if (options.from_year <= 0 || options.to_year < options.from_year) return std::nullopt;
+    return options;
+}
+
+enum TimeIndex {
+    ParanStart, ParanEnd, EkadashiStart, DvadashiStart, Sunrise, Sunset, TithiStart, NakshatraStart, TimeCount,
+    // times of the vrata itself, all that VrataGrid and VrataDb give
+    VrataTimeCount = Sunrise
+};
+constexpr std::array<const char *, TimeCount> time_names{
+    "pāraṇam start", "pāraṇam end", "ekādaśī start", "dvādaśī start", "sunrise", "sunset", "next tithi start", "next nakṣatra start"
+};
+
+struct Case {
+    vp::Location location;
+    date::local_days base_date;
+};
+
+struct Sample {
+    // empty when everything was calculated
+    std::string error;
+    date::local_days vrata_date;
+    vp::Vrata_Type vrata_type = vp::Vrata_Type::Ekadashi;
+    vp::Paran::Type paran_type = vp::Paran::Type::Standard;
+    // raw julian days, NaN when there is no such time
+    std::array<double, TimeCount> times;
+};
+
+double raw(std::optional<vp::JulDays_UT> time) {
+    return time ? time->raw_julian_days_ut().count() : nan;
+}
+
+Sample error_sample(std::string error) {
+    Sample sample;
+    sample.times.fill(nan);
+    sample.error = std::move(error);
+    return sample;
+}
+
+// only vrata times are set
+Sample sample_of(const vp::MaybeVrata & vrata) {
+    if (!vrata) return error_sample(fmt::format("{}", vrata.error()));
+    Sample sample;
+    sample.times.fill(nan);
+    sample.vrata_date = vrata->date;
+    sample.vrata_type = vrata->type;
+    sample.paran_type = vrata->paran.type;
+    sample.times[ParanStart] = raw(vrata->paran.paran_start);
+    sample.times[ParanEnd] = raw(vrata->paran.paran_end);
+    sample.times[EkadashiStart] = raw(vrata->times.ekadashi_start);
+    sample.times[DvadashiStart] = raw(vrata->times.dvadashi_start);
+    return sample;
+}
+
+Sample calculate(const Case & c, const vp::Calc & calc) {
+    Sample sample;
+    try {
+        const auto vrata = calc.find_next_vrata(c.base_date);
+        sample = sample_of(vrata);
+        if (!vrata) return sample;
+
+        const vp::JulDays_UT midnight{c.base_date, c.location.time_zone()};
+        const auto sunrise = calc.swe.find_sunrise(midnight);
+        if (!sunrise) return sample;
+        sample.times[Sunrise] = raw(*sunrise);
+        sample.times[Sunset] = raw(calc.swe.find_sunset(*sunrise).value_or(vp::JulDays_UT{vp::double_days{nan}}));
+        const double tithi = calc.swe.get_tithi(*sunrise).tithi;
+        sample.times[TithiStart] = raw(calc.find_exact_tithi_start(*sunrise, vp::Tithi{std::fmod(std::floor(tithi) + 1.0, 30.0)}));
+        const double nakshatra = calc.swe.get_nakshatra(*sunrise).nakshatra;
+        sample.times[NakshatraStart] = raw(calc.find_nakshatra_start(*sunrise, vp::Nakshatra{std::fmod(std::floor(nakshatra) + 1.0, 27.0)}));
+    } catch (const std::exception & e) {
+        sample = error_sample(e.what());
+    }
+    return sample;
+}
+
+// Calls calculate(i) for all i in [0, count) on thread_count threads, returns seconds taken.
+// make_state() is called once per thread, its result is passed to every calculate() of that thread.
+template <class MakeState, class Calculate>
+double run_parallel(std::size_t count, unsigned thread_count, MakeState make_state, Calculate calculate) {
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next{0};
+    const auto worker = [&] {
+        auto state = make_state();
+        for (std::size_t i; (i = next++) < count;) calculate(i, state);
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto & thread : threads) thread.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// value at the given fraction of sorted values
+double percentile(const std::vector<double> & sorted, double fraction) {
+    if (sorted.empty()) return nan;
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+std::string describe(const Case & c) {
+    return fmt::format("{} after {}", c.location.name, c.base_date);
+}
+
+std::string describe(const Sample & s) {
+    if (!s.error.empty()) return fmt::format("error: {}", s.error);
+    return fmt::format("{} {} ({} pāraṇam)", s.vrata_date, s.vrata_type, s.paran_type);
+}
+
+// Classification flips and time deviations of one calculation path from reference.
+class Comparison {
+public:
+    // compares the first time_count times
+    Comparison(const char * name, std::size_t time_count, double max_seconds)
+        : name_(name), time_count_(time_count), max_seconds_(max_seconds) {}
+
+    // Prints the flip if there is one. Returns whether date, type and pāraṇam type (or error) are the same.
+    bool add(const std::vector<Case> & cases, std::size_t i, const Sample & ref, const Sample & other) {
+        if (ref.error != other.error || (ref.error.empty() &&
+                (ref.vrata_date != other.vrata_date || ref.vrata_type != other.vrata_type || ref.paran_type != other.paran_type))) {
+            ++flips_;
+            fmt::print("{} FLIP {}: reference {}, {} {}\n", name_, describe(cases[i]), describe(ref), name_, describe(other));
+            return false;
+        }
+        for (std::size_t t = 0; t < time_count_; ++t) {
+            const bool ref_has = !std::isnan(ref.times[t]);
+            if (ref_has != !std::isnan(other.times[t])) {
+                ++flips_;
+                fmt::print("{} FLIP {}: {} is {} in reference, {} in {}\n", name_, describe(cases[i]), time_names[t],
+                           ref_has ? "set" : "unset", ref_has ? "unset" : "set", name_);
+                continue;
+            }
+            if (!ref_has) continue;
+            const double deviation = std::fabs(other.times[t] - ref.times[t]) * seconds_per_day;
+            if (deviations_[t].empty() || deviation > worst_deviation_[t]) {
+                worst_[t] = i;
+                worst_deviation_[t] = deviation;
+            }
+            deviations_[t].push_back(deviation);
+        }
+        return true;
+    }
+
+    // Prints deviation percentiles of every time. Returns whether all of them are within max_seconds.
+    bool print_deviations(const std::vector<Case> & cases) const {
+        bool within_tolerance = true;
+        fmt::print("{:<30}{:>8}{:>12}{:>12}{:>12}{:>12}   worst case (seconds, tolerance {}s)\n",
+                   name_, "count", "p50", "p99", "p99.9", "max", max_seconds_);
+        for (std::size_t t = 0; t < time_count_; ++t) {
+            auto sorted = deviations_[t];
+            std::sort(sorted.begin(), sorted.end());
+            const double max = sorted.empty() ? 0.0 : sorted.back();
+            if (max > max_seconds_) within_tolerance = false;
+            const std::string worst_case = sorted.empty() ? std::string{} : describe(cases[worst_[t]]);
+            fmt::print("  {:<28}{:>8}{:>12.6f}{:>12.6f}{:>12.6f}{:>12.6f}   {}\n", time_names[t], sorted.size(),
+                       percentile(sorted, 0.5), percentile(sorted, 0.99), percentile(sorted, 0.999), max, worst_case);
+        }
+        return within_tolerance;
+    }
+
+    const char * name() const { return name_; }
+    std::size_t flips() const { return flips_; }
+
+private:
+    const char * name_;
+    std::size_t time_count_;
+    double max_seconds_;
+    std::size_t flips_ = 0;
+    std::array<std::vector<double>, TimeCount> deviations_;
+    // case index with the largest deviation of each time
+    std::array<std::size_t, TimeCount> worst_{};
+    std::array<double, TimeCount> worst_deviation_{};
+};
+
+} // anonymous namespace
+
+int main(int argc, char * argv[]) try
+{
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    const auto options = parse_options(argc, argv);
+    if (!options) {
+        print_usage();
+        return 2;
+    }
+    vp::text_ui::change_to_data_dir(argv[0]);
+    date::set_install("tzdata");
+
+    using namespace date;
+    std::vector<Case> cases;
+    const local_days from{year{options->from_year}/January/1};
+    const local_days to{year{options->to_year}/December/31};
+    for (const auto & location : vp::text_ui::LocationDb()) {
+        for (auto base_date = from; base_date <= to; base_date += days{options->step_days}) {
+            cases.push_back({location, base_date});
+        }
+    }
+    const unsigned thread_count = options->threads ? options->threads : std::max(1u, std::thread::hardware_concurrency());
+    constexpr auto flags = vp::CalcFlags::Default;
+    const auto ephemeris = flags & vp::CalcFlags::EphemerisMask;
+
+    std::vector<Sample> reference(cases.size());
+    vp::Swe::use_embedded_ephemeris(false);
+    const double reference_seconds = run_parallel(cases.size(), thread_count, [] { return 0; }, [&](std::size_t i, int) {
+        reference[i] = calculate(cases[i], vp::Calc{vp::Swe{cases[i].location, flags}});
+    });
+
+    std::vector<Sample> fast(cases.size());
+    vp::Swe::use_embedded_ephemeris(true);
+    const double fast_seconds = run_parallel(cases.size(), thread_count, [&] { return std::make_shared<vp::BoundaryCache>(ephemeris); },
+        [&](std::size_t i, const std::shared_ptr<vp::BoundaryCache> & cache) {
+            fast[i] = calculate(cases[i], vp::Calc{vp::Swe{cases[i].location, flags}, cache});
+        });
+
+    std::vector<std::optional<vp::VrataPreview>> previews(cases.size());
+    const double preview_seconds = run_parallel(cases.size(), thread_count, [] { return 0; }, [&](std::size_t i, int) {
+        if (auto preview = vp::preview_next_vrata(cases[i].base_date, cases[i].location, flags)) previews[i] = *preview;
+    });
+
+    // One VrataGrid per base date and time zone, as the grid can't be shared between threads.
+    std::map<std::pair<local_days, std::string>, std::vector<std::size_t>> grid_groups;
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        grid_groups[{cases[i].base_date, std::string{cases[i].location.time_zone_name}}].push_back(i);
+    }
+    const std::vector<std::pair<std::pair<local_days, std::string>, std::vector<std::size_t>>> groups{grid_groups.begin(), grid_groups.end()};
+    std::vector<Sample> grid(cases.size());
+    std::atomic<std::size_t> grid_corners{0};
+    const double grid_seconds = run_parallel(groups.size(), thread_count, [] { return 0; }, [&](std::size_t g, int) {
+        const auto & [key, indexes] = groups[g];
+        vp::VrataGridSettings settings;
+        settings.flags = flags;
+        vp::VrataGrid vrata_grid{key.first, key.second, settings};
+        for (const auto i : indexes) grid[i] = sample_of(vrata_grid.find(cases[i].location));
+        grid_corners += vrata_grid.calculated_corners();
+    });
+
+    const test_files::TempFile db_file{"accuracy-harness", ".vpdb"};
+    const auto db_generation_start = std::chrono::steady_clock::now();
+    vp::text_ui::generate_vrata_db(db_file.path(), from, to, flags);
+    const double db_generation_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - db_generation_start).count();
+    const auto db = vp::VrataDb::open(db_file.path());
+    if (!db) throw std::runtime_error{"can't open generated vrata db " + db_file.path().string()};
+    std::vector<Sample> from_db(cases.size());
+    const double db_seconds = run_parallel(cases.size(), thread_count, [] { return 0; }, [&](std::size_t i, int) {
+        if (const auto vrata = db->find_next(cases[i].location, cases[i].base_date)) {
+            from_db[i] = sample_of(*vrata);
+        } else if (!reference[i].error.empty()) {
+            // not answering near calculation errors is what the db is supposed to do
+            from_db[i] = reference[i];
+        } else {
+            from_db[i] = error_sample("not in vrata db");
+        }
+    });
+
+    Comparison fast_comparison{"fast", TimeCount, options->max_seconds};
+    Comparison grid_comparison{"grid", VrataTimeCount, options->max_grid_seconds};
+    Comparison db_comparison{"db", VrataTimeCount, options->max_seconds};
+    std::size_t preview_flips = 0;
+    std::size_t uncertain_preview_flips = 0;
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto & ref = reference[i];
+        grid_comparison.add(cases, i, ref, grid[i]);
+        db_comparison.add(cases, i, ref, from_db[i]);
+        if (!fast_comparison.add(cases, i, ref, fast[i])) continue;
+        if (ref.error.empty()) {
+            const auto & preview = previews[i];
+            if (!preview || preview->vrata.date != ref.vrata_date || preview->vrata.type != ref.vrata_type) {
+                const bool uncertain = preview && preview->uncertain;
+                if (uncertain) {
+                    ++uncertain_preview_flips;
+                } else {
+                    ++preview_flips;
+                    fmt::print("PREVIEW FLIP {}: reference {}, preview {}\n", describe(cases[i]), describe(ref),
+                               preview ? fmt::format("{} {}", preview->vrata.date, preview->vrata.type) : std::string{"error"});
+                }
+            }
+        }
+    }
+
+    bool out_of_tolerance = false;
+    std::size_t flips = preview_flips;
+    for (const auto * comparison : {&fast_comparison, &grid_comparison, &db_comparison}) {
+        if (!comparison->print_deviations(cases)) out_of_tolerance = true;
+        flips += comparison->flips();
+    }
+    fmt::print("{} cases on {} threads: reference {:.2f}s, fast {:.2f}s ({:.1f}x), preview {:.2f}s ({:.1f}x)\n",
+               cases.size(), thread_count, reference_seconds, fast_seconds, reference_seconds / fast_seconds,
+               preview_seconds, reference_seconds / preview_seconds);
+    fmt::print("grid {:.2f}s ({:.1f}x, {} grids, {} corners), db {:.3f}s ({:.0f}x, generated in {:.2f}s)\n",
+               grid_seconds, reference_seconds / grid_seconds, groups.size(), grid_corners.load(),
+               db_seconds, reference_seconds / db_seconds, db_generation_seconds);
+    fmt::print("{} fast flips, {} grid flips, {} db flips, {} preview flips ({} more marked uncertain){}\n",
+               fast_comparison.flips(), grid_comparison.flips(), db_comparison.flips(), preview_flips, uncertain_preview_flips,
+               out_of_tolerance ? ", tolerance EXCEEDED" : "");
+    return (flips == 0 && !out_of_tolerance) ? 0 : 1;
+} catch (std::exception & e) {
+    fmt::print(stderr, "Error: {}\n", e.what());
+    return 2;
+}
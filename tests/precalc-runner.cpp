@@ -0,0 +1,192 @@
+/* Checks our vratas against the whole precalculated corpus (see precalculated-corpus.h),
+ * all cases in parallel, with timing of each case. Meant to be run after every change
+ * in calculations; also runs as "precalc" ctest test.
+ */
+#include "precalculated-corpus.h"
+#include "text-interface.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "fmt-format-fixed.h"
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace {
+
+constexpr const char * default_fixture_file = "precalculated-corpus.tsv";
+// that many slowest cases in the summary
+constexpr std::size_t slowest_count = 10;
+
+void print_usage() {
+    fmt::print("USAGE:\n"
+               "precalc-runner [-q] [-j threads] [-s shard/shards] [fixture]\n"
+               "precalc-runner -w [fixture]\n"
+               "\n"
+               "    Checks vratas from the fixture ({} in the data dir by default) against our calculations\n"
+               "    and prints time and result for every case, then the summary. Exit code is 1 on any mismatch.\n"
+               "    -q prints mismatches and the summary only.\n"
+               "    -j runs that many threads (all cores by default).\n"
+               "    -s checks only every shards-th case starting from shard-th (0-based), e.g. -s 1/4,\n"
+               "    for splitting the corpus between several machines.\n"
+               "    -w parses tests/data/precalculated-*.html with their fixes once and writes the fixture.\n",
+               default_fixture_file);
+}
+
+struct Options {
+    bool quiet = false;
+    bool write = false;
+    unsigned threads = 0;
+    std::size_t shard = 0;
+    std::size_t shards = 1;
+    const char * fixture = nullptr;
+};
+
+// nullopt on wrong arguments
+std::optional<Options> parse_options(int argc, char * argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-q") == 0) {
+            options.quiet = true;
+        } else if (strcmp(argv[i], "-w") == 0) {
+            options.write = true;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            const int threads = std::atoi(argv[++i]);
+            if (threads <= 0) return std::nullopt;
+            options.threads = static_cast<unsigned>(threads);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            unsigned long shard = 0, shards = 0;
+            char slash = 0;
+            std::istringstream s{argv[++i]};
+            s >> shard >> slash >> shards;
+            if (!s || slash != '/' || shards == 0 || shard >= shards) return std::nullopt;
+            options.shard = shard;
+            options.shards = shards;
+        } else if (argv[i][0] != '-' && !options.fixture) {
+            options.fixture = argv[i];
+        } else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+int write_fixture(const fs::path & path) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<precalc::Precalculated_Vrata> vratas;
+    const auto & files = precalc::corpus_files();
+    for (const auto & file : files) {
+        auto file_vratas = precalc::load_corpus_file(file);
+        std::move(file_vratas.begin(), file_vratas.end(), std::back_inserter(vratas));
+    }
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    precalc::write_fixture(out, vratas);
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    fmt::print(stderr, "{} vratas from {} files in {:.2f}s\n", vratas.size(), files.size(), duration.count());
+    return 0;
+}
+
+struct CaseResult {
+    std::string mismatch;
+    std::chrono::duration<double, std::milli> duration{};
+};
+
+int run(const fs::path & path, const Options & options) {
+    std::ifstream in{path, std::ios::binary};
+    if (!in) {
+        fmt::print(stderr, "Can't open {} (make it with -w)\n", path.string());
+        return 2;
+    }
+    const auto all_vratas = precalc::read_fixture(in);
+    std::vector<const precalc::Precalculated_Vrata *> cases;
+    std::size_t skipped = 0;
+    for (std::size_t i = options.shard; i < all_vratas.size(); i += options.shards) {
+        if (all_vratas[i].skip) {
+            ++skipped;
+            continue;
+        }
+        cases.push_back(&all_vratas[i]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<CaseResult> results(cases.size());
+    std::atomic<std::size_t> next_case{0};
+    const auto worker = [&] {
+        for (std::size_t i; (i = next_case++) < cases.size();) {
+            const auto case_start = std::chrono::steady_clock::now();
+            try {
+                results[i].mismatch = precalc::check_precalculated_vrata(*cases[i]);
+            } catch (const std::exception & e) {
+                results[i].mismatch = fmt::format("exception: {}", e.what());
+            }
+            results[i].duration = std::chrono::steady_clock::now() - case_start;
+        }
+    };
+    const unsigned thread_count = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto & thread : threads) thread.join();
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < cases.size(); ++i) {
+        const auto & vrata = *cases[i];
+        const bool ok = results[i].mismatch.empty();
+        if (!ok) ++mismatches;
+        if (ok && options.quiet) continue;
+        fmt::print("{} {} {} {} {:.1f}ms\n", ok ? "ok  " : "FAIL", vrata.slug, vrata.location.name, vrata.date, results[i].duration.count());
+        if (!ok) fmt::print("    {}\n", results[i].mismatch);
+    }
+
+    std::vector<std::size_t> by_duration(cases.size());
+    for (std::size_t i = 0; i < by_duration.size(); ++i) by_duration[i] = i;
+    const auto slowest = std::min(slowest_count, by_duration.size());
+    std::partial_sort(by_duration.begin(), by_duration.begin() + static_cast<std::ptrdiff_t>(slowest), by_duration.end(),
+                      [&](std::size_t one, std::size_t two) { return results[one].duration > results[two].duration; });
+    std::chrono::duration<double, std::milli> total{};
+    for (const auto & result : results) total += result.duration;
+    fmt::print("slowest cases:\n");
+    for (std::size_t i = 0; i < slowest; ++i) {
+        const auto & vrata = *cases[by_duration[i]];
+        fmt::print("    {:.1f}ms {} {} {}\n", results[by_duration[i]].duration.count(), vrata.slug, vrata.location.name, vrata.date);
+    }
+    fmt::print("{} cases ({} skipped, shard {}/{}): {} mismatches; {:.2f}s on {} threads, {:.2f}s of calculations\n",
+               cases.size(), skipped, options.shard, options.shards, mismatches,
+               duration.count(), thread_count, total.count() / 1000.0);
+    return mismatches == 0 ? 0 : 1;
+}
+
+} // anonymous namespace
+
+int main(int argc, char * argv[]) try
+{
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    const auto options = parse_options(argc, argv);
+    if (!options) {
+        print_usage();
+        return 2;
+    }
+    // resolve user-given path before changing current dir
+    const auto fixture = options->fixture ? fs::absolute(options->fixture) : fs::path{};
+    vp::text_ui::change_to_data_dir(argv[0]);
+    date::set_install("tzdata");
+    const auto path = fixture.empty() ? fs::path{default_fixture_file} : fixture;
+    return options->write ? write_fixture(path) : run(path, *options);
+} catch (std::exception & e) {
+    fmt::print(stderr, "Error: {}\n", e.what());
+    return 2;
+}
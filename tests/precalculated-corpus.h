@@ -0,0 +1,171 @@
+#ifndef VP_TESTS_PRECALCULATED_CORPUS_H
+#define VP_TESTS_PRECALCULATED_CORPUS_H
+
+#include "html-table-parser.h"
+#include "location.h"
+#include "vrata.h"
+
+#include "date-fixed.h"
+#include "filesystem-fixed.h"
+#include "fmt-format-fixed.h"
+#include "tz-fixed.h"
+#include <chrono>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+/* Old pañcāṅgams (tests/data/precalculated-*.html) with known errors fixed,
+ * for checking our vratas against them. Used by [precalc] tests in
+ * test-precalculated.cpp and by precalc-runner, which parses the HTML once
+ * into a fixture file and then checks that.
+ */
+namespace precalc {
+
+struct Paranam {
+    enum class Precision {
+        Minutes,
+        Seconds
+    };
+
+    std::optional<date::zoned_seconds> start;
+    std::optional<date::zoned_seconds> end;
+    Precision precision;
+    Paranam(std::optional<date::zoned_seconds> start_ = std::nullopt, std::optional<date::zoned_seconds> end_ = std::nullopt, Precision precision_ = Precision::Minutes)
+        : start(start_), end(end_), precision(precision_)
+    {}
+};
+
+bool operator==(const Paranam & one, const Paranam & two);
+
+struct Precalculated_Vrata {
+    date::local_days date;
+    vp::Vrata_Type type;
+    vp::Location location;
+    bool skip = false;
+    bool already_fixed = false;
+    Paranam paranam;
+    // file it came from, empty for vratas not from the corpus
+    std::string slug;
+    Precalculated_Vrata(vp::Location location_,
+                        date::year_month_day date_,
+                        vp::Vrata_Type type_ = vp::Vrata_Type::Ekadashi,
+                        Paranam paranam_= Paranam{})
+        : date(date_),
+          type(type_),
+          location(location_),
+          paranam(paranam_)
+    {}
+
+    // Empty if whatever information this vrata has matches nowcalc, otherwise what's wrong.
+    std::string mismatch(const vp::Vrata & nowcalc) const;
+};
+
+bool operator==(const Precalculated_Vrata & one, const Precalculated_Vrata & other);
+
+struct FixSkip{};
+struct FixShiftStartTime {
+    std::chrono::seconds s;
+};
+struct FixShiftEndTime {
+    std::chrono::seconds s;
+};
+struct FixStart{
+    std::optional<std::chrono::minutes> expected;
+    std::chrono::minutes new_time;
+};
+struct FixStartSeconds{
+    std::optional<std::chrono::seconds> expected;
+    std::chrono::seconds new_time;
+};
+struct FixRemoveParanStartTime{
+    std::chrono::seconds expected;
+};
+struct FixEnd{
+    std::optional<std::chrono::minutes> expected;
+    std::chrono::minutes new_time;
+};
+struct FixEndSeconds{
+    std::optional<std::chrono::seconds> expected;
+    std::chrono::seconds new_time;
+};
+struct FixRemoveParanEndTime{
+    std::chrono::seconds expected;
+};
+struct FixVrataDate{
+    date::local_days expected;
+    date::local_days new_date;
+    FixVrataDate(date::year_month_day expected_, date::year_month_day new_date_) : expected(expected_), new_date(new_date_) {}
+};
+struct FixVrataType{
+    vp::Vrata_Type expected;
+    vp::Vrata_Type new_type;
+};
+
+using FixVariant = std::variant<
+    FixSkip,
+    FixShiftStartTime,
+    FixShiftEndTime,
+    FixStart,
+    FixStartSeconds,
+    FixRemoveParanStartTime,
+    FixEnd,
+    FixEndSeconds,
+    FixRemoveParanEndTime,
+    FixVrataDate,
+    FixVrataType
+>;
+
+using Fixes = std::map<vp::Location, std::vector<FixVariant>>;
+
+// Fixes for this location apply to all vratas without fixes of their own.
+extern const vp::Location all_coord;
+
+struct CorpusFile {
+    const char * slug; // data/precalculated-<slug>.html
+    Fixes fixes;
+};
+
+// Files which we currently match, in date order.
+const std::vector<CorpusFile> & corpus_files();
+
+std::string slurp_file(const fs::path & filename);
+date::month_day decode_month_day(const std::string& s);
+date::year_month_day append_proper_year_to_md(date::year_month_day reference_ymd, date::month_day md);
+std::string get_ekadashi_name(const std::string & text);
+std::chrono::seconds h_m_s_from_string(const std::string & s);
+Paranam parse_precalc_paranam(const std::string & s,
+                              date::year_month_day date,
+                              const date::time_zone *time_zone);
+std::string join(const html::Table::Row & v, char joiner=';');
+date::year_month_day get_ymd_from_slug(const char * slug);
+std::vector<Precalculated_Vrata> extract_vratas_from_precalculated_table(std::string && s, date::year_month_day reference_ymd);
+void fix_vratas(std::vector<Precalculated_Vrata> & vratas, const Fixes & fixes);
+
+// Parsed and fixed vratas of one file.
+std::vector<Precalculated_Vrata> load_corpus_file(const CorpusFile & file);
+
+// Empty if our calculation matches the vrata, otherwise what's wrong.
+std::string check_precalculated_vrata(const Precalculated_Vrata & vrata);
+
+/* Fixture: one vrata per line, tab-separated, times as seconds since 1970-01-01 UTC
+ * (time zones come from the locations). Throws on malformed input.
+ */
+void write_fixture(std::ostream & out, const std::vector<Precalculated_Vrata> & vratas);
+std::vector<Precalculated_Vrata> read_fixture(std::istream & in);
+
+} // namespace precalc
+
+template<>
+struct fmt::formatter<precalc::Precalculated_Vrata> : fmt::formatter<std::string_view> {
+    template<typename FormatContext>
+    auto format(const precalc::Precalculated_Vrata & v, FormatContext & ctx) {
+        return fmt::format_to(
+            ctx.out(), "{}@{} on {}, pAraNam: {}..{}",
+            v.type, v.location.name, v.date, v.paranam.start, v.paranam.end);
+    }
+};
+
+#endif // VP_TESTS_PRECALCULATED_CORPUS_H
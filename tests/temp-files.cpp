@@ -0,0 +1,51 @@
+#include "temp-files.h"
+
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace test_files {
+
+fs::path unique_temp_path(std::string_view stem, std::string_view extension)
+{
+    static std::mutex mutex;
+    static std::mt19937_64 rng{std::random_device{}()};
+    const std::lock_guard lock{mutex};
+    for (;;) {
+        char suffix[17];
+        const auto value = rng();
+        for (std::size_t i = 0; i < 16; ++i) {
+            suffix[i] = "0123456789abcdef"[(value >> (4 * i)) & 0xF];
+        }
+        suffix[16] = '\0';
+        auto path = fs::temp_directory_path() / (std::string{stem} + '-' + suffix + std::string{extension});
+        if (!fs::exists(path)) return path;
+    }
+}
+
+TempFile::TempFile(std::string_view stem, std::string_view extension)
+    : path_(unique_temp_path(stem, extension))
+{}
+
+TempFile::TempFile(TempFile && other) noexcept : path_(std::move(other.path_))
+{
+    other.path_.clear();
+}
+
+TempFile::~TempFile()
+{
+    if (path_.empty()) return;
+    std::error_code ignored;
+    fs::remove(path_, ignored);
+}
+
+void write_not_a_db(const fs::path & path)
+{
+    std::ofstream f{path, std::ios::binary | std::ios::trunc};
+    f << std::string(1000, 'x');
+}
+
+} // namespace test_files
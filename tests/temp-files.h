@@ -0,0 +1,51 @@
+#ifndef VP_TESTS_TEMP_FILES_H
+#define VP_TESTS_TEMP_FILES_H
+
+#include "filesystem-fixed.h"
+
+#include <string_view>
+
+/* Temporary files for tests. Names are unique per call, so that test runs in parallel
+ * (ctest -j, several build dirs on one machine) never see each other's files.
+ */
+namespace test_files {
+
+// Path in the temp dir that doesn't exist yet, e.g. "<temp>/place-db-test-1f2e3d4c5b6a7988.vpplaces"
+fs::path unique_temp_path(std::string_view stem, std::string_view extension);
+
+// Unique temp path; whatever file gets created there is removed on destruction.
+class TempFile {
+public:
+    TempFile(std::string_view stem, std::string_view extension);
+    TempFile(TempFile && other) noexcept;
+    TempFile(const TempFile &) = delete;
+    TempFile & operator=(const TempFile &) = delete;
+    TempFile & operator=(TempFile &&) = delete;
+    ~TempFile();
+
+    const fs::path & path() const { return path_; }
+
+private:
+    fs::path path_;
+};
+
+// Fills the file with 1000 'x' bytes, which is none of our file formats.
+void write_not_a_db(const fs::path & path);
+
+// Turns off a global db (vp::text_ui::use_place_db() and the like) on destruction,
+// so that a failed REQUIRE doesn't leave it on for the following tests.
+class UseDbGuard {
+public:
+    using UseDb = bool (*)(const fs::path &);
+    explicit UseDbGuard(UseDb use_db) : use_db_(use_db) {}
+    UseDbGuard(const UseDbGuard &) = delete;
+    UseDbGuard & operator=(const UseDbGuard &) = delete;
+    ~UseDbGuard() { use_db_({}); }
+
+private:
+    UseDb use_db_;
+};
+
+} // namespace test_files
+
+#endif // VP_TESTS_TEMP_FILES_H